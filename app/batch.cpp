@@ -0,0 +1,133 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <exception>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch/coordinator.h"
+#include "library/rom_index.h"
+
+using namespace chip8;
+
+static const std::string HASH_PREFIX = "hash:";
+
+// Each line of the job list is: <rom> <number of frames> [movie path], the
+// ROM being a path or hash:<16 hex digits> looked up in the ROM index
+static bool readJobs(std::istream& job_list, const RomIndex& index,
+                     std::vector<Job>& jobs) {
+  std::string line;
+  while (std::getline(job_list, line)) {
+    if (line.empty() || line[0] == '#') continue;
+
+    std::istringstream fields(line);
+    Job job{"", "", 0};
+    if (!(fields >> job.rom_path >> job.n_frames)) {
+      std::cout << "Invalid job: " << line << "\n";
+      return false;
+    }
+    fields >> job.movie_path;
+
+    if (job.rom_path.compare(0, HASH_PREFIX.size(), HASH_PREFIX) == 0) {
+      const RomEntry* rom = nullptr;
+      try {
+        rom = index.findByHash(
+            std::stoull(job.rom_path.substr(HASH_PREFIX.size()), nullptr, 16));
+      } catch (const std::exception&) {
+        // Not a hash, reported as an unknown ROM
+      }
+      if (rom == nullptr) {
+        std::cout << "Unknown ROM: " << line << "\n";
+        return false;
+      }
+      job.rom_path = rom->path;
+    }
+
+    // Indexed ROMs run at their best known speed
+    if (const RomEntry* rom = index.findByPath(job.rom_path)) {
+      job.cycles_per_frame = rom->cycles_per_frame;
+    }
+    jobs.push_back(job);
+  }
+
+  return true;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cout << "Usage: " << argv[0]
+              << " <job list> [number of workers] [ROM index]\n";
+    return -1;
+  }
+
+  std::ifstream job_list(argv[1]);
+  if (!job_list) {
+    std::cout << "Cannot open file";
+    return -1;
+  }
+
+  RomIndex index;
+  if (argc > 3 && !index.load(argv[3])) {
+    std::cout << "Cannot read ROM index";
+    return -1;
+  }
+
+  std::vector<Job> jobs;
+  if (!readJobs(job_list, index, jobs)) {
+    return -1;
+  }
+
+  std::size_t n_workers = std::thread::hardware_concurrency();
+  if (argc > 2) {
+    n_workers = std::stoul(argv[2]);
+  }
+
+  Coordinator coordinator(n_workers);
+  auto results = coordinator.run(jobs);
+
+  int exit_code = 0;
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    const auto& result = results[i];
+    std::cout << jobs[i].rom_path << " ";
+    if (result.success) {
+      std::cout << std::hex << std::setfill('0') << "state=" << std::setw(16)
+                << result.final_state_hash << " frames=" << std::setw(16)
+                << result.frames_hash << std::dec
+                << " instructions=" << result.n_instructions
+                << " duration_us=" << result.duration_ns / 1000;
+    } else {
+      std::cout << "error: " << result.error;
+      exit_code = 1;
+    }
+    std::cout << " attempts=" << result.n_attempts << "\n";
+  }
+
+  return exit_code;
+}
@@ -23,34 +23,86 @@
  * SOFTWARE.
  */
 
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#include "audio/audio_ring_buffer.h"
+#include "audio/audio_sink.h"
+#include "audio/beeper.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/clock.h"
 #include "emulator/emulator.h"
+#include "emulator/input_event_queue.h"
+#include "emulator/input_latency.h"
+#include "emulator/input_movie.h"
+#include "emulator/rewind_buffer.h"
+#include "emulator/run_ahead.h"
+#include "emulator/save_state.h"
 
 #include "display_ui/user_input_impl.h"
 
+#include "library/rom_watcher.h"
+
+#include "display_ui/audio_output_impl.h"
 #include "display_ui/display_view_impl.h"
 #include "display_ui/window.h"
-#include "emulator/display_controller.h"
-#include "emulator/display_model.h"
-#include "emulator/display_model_impl.h"
 
 using namespace chip8;
 
+// Ten minutes of frames at 60 Hz in less than 2 MiB, see RewindBuffer
+static const std::size_t REWIND_FRAMES = 10 * 60 * 60;
+static const std::size_t REWIND_STORAGE_SIZE = 1536 * 1024;
+static const std::size_t REWIND_KEYFRAME_INTERVAL = 120;
+static const double FRAME_FREQUENCY = 60;
+static const std::string RUN_AHEAD_OPTION = "--run-ahead=";
+static const std::size_t RUN_AHEAD_REPORT_INTERVAL = 10 * 60;
+static const std::string WAV_OPTION = "--wav=";
+static const std::string WATCH_OPTION = "--watch";
+static const std::string WATCH_RESTORE_OPTION = "--watch=restore";
+// A quarter of a second of audio can be buffered ahead of the device
+static const unsigned AUDIO_SAMPLE_RATE = 44100;
+static const std::size_t AUDIO_RING_SIZE = AUDIO_SAMPLE_RATE / 4;
+
 int main(int argc, char** argv) {
-  // First program argument is the path to the ROM
-  std::ifstream rom_file;
-  if (argc > 1) {
-    rom_file.open(argv[1], std::ios_base::out | std::ios_base::binary);
-  } else {
-    std::cout << "No file to load specified";
-    return -1;
+  // --run-ahead=N presents the frame N frames ahead to hide the input lag of
+  // the program, --wav=PATH writes the sound to a file instead of playing it,
+  // --watch reloads the ROM when it is rewritten and --watch=restore also
+  // restores the save state, the other arguments are positional
+  std::size_t run_ahead_frames = 0;
+  std::string wav_path;
+  bool watch = false;
+  bool watch_restore = false;
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg.compare(0, RUN_AHEAD_OPTION.size(), RUN_AHEAD_OPTION) == 0) {
+      try {
+        run_ahead_frames = std::stoul(arg.substr(RUN_AHEAD_OPTION.size()));
+      } catch (const std::exception&) {
+        std::cout << "Invalid number of run ahead frames";
+        return -1;
+      }
+    } else if (arg.compare(0, WAV_OPTION.size(), WAV_OPTION) == 0) {
+      wav_path = arg.substr(WAV_OPTION.size());
+    } else if (arg == WATCH_OPTION || arg == WATCH_RESTORE_OPTION) {
+      watch = true;
+      watch_restore = arg == WATCH_RESTORE_OPTION;
+    } else {
+      args.push_back(arg);
+    }
   }
 
-  if (!rom_file) {
-    std::cout << "Cannot open file";
+  // First program argument is the path to the ROM
+  if (args.empty()) {
+    std::cout << "No file to load specified";
     return -1;
   }
 
@@ -58,26 +110,170 @@ int main(int argc, char** argv) {
   SDLInputToKeyMap key_to_map;
   SDLKeyboardUserInputController keyboard_controller(key_to_map);
 
-  // Initialize display_ui
-  std::unique_ptr<DisplayModel> display_model(new DisplayModelImpl());
+  // Second optional argument is the path of an input movie to record. The
+  // emulator then runs frame by frame with the key events applied at the
+  // cycle matching their timestamp. The movie holds the keys at the end of
+  // each frame and the events are logged next to it, so that batch jobs
+  // replay the run at the cycle of each event. Run ahead needs the same frame
+  // by frame execution but samples the keys at the start of each frame, as
+  // the frames run ahead would apply the queued events.
+  const bool recording = args.size() > 1;
+  const bool frame_stepped = recording || run_ahead_frames > 0;
+  const bool queued_input = frame_stepped && run_ahead_frames == 0;
+  InputMovie movie;
+  BitmaskUserInputController recorded_keypad;
+  InputEventQueue input_events(CYCLES_PER_FRAME * FRAME_FREQUENCY);
+
+  // The guest reads the keys through the latency tracker which measures the
+  // time from the key events to the guest and to the screen
+  UserInputController& guest_input =
+      queued_input    ? static_cast<UserInputController&>(input_events)
+      : frame_stepped ? static_cast<UserInputController&>(recorded_keypad)
+                      : keyboard_controller;
+  InputLatencyTracker latency_tracker(
+      guest_input, []() { return std::chrono::steady_clock::now(); });
+
+  // Initialize emulator
+  std::unique_ptr<Emulator> loaded_emulator;
+  try {
+    loaded_emulator = std::make_unique<Emulator>(args[0], &latency_tracker);
+  } catch (const std::runtime_error& e) {
+    std::cout << e.what();
+    return -1;
+  }
+  Emulator& emulator = *loaded_emulator;
+  if (queued_input) {
+    emulator.setInputEventQueue(&input_events);
+  }
+  movie.setSeed(std::random_device()());
+  emulator.seed(movie.getSeed());
+  RunAhead run_ahead(emulator, recorded_keypad, run_ahead_frames);
+
+  // Save states are stored next to the ROM, F5 saves and F9 loads
+  const std::string save_state_path = args[0] + ".state";
+  RAM rom_image = emulator.getState().ram;
+  std::unique_ptr<SaveStateWriter> save_state_writer(
+      new SaveStateWriter(rom_image));
+
+  // Watch mode reloads the ROM into a reset machine when it is rewritten,
+  // within a millisecond as the watcher is polled by the main loop. Not
+  // available while recording as the movie could not be replayed.
+  std::unique_ptr<RomWatcher> rom_watcher;
+  if (watch && !recording) {
+    rom_watcher.reset(new RomWatcher(args[0]));
+    if (!rom_watcher->isWatching()) {
+      std::cout << "Cannot watch " << args[0] << std::endl;
+    }
+  }
+
+  // The samples of the buzzer are generated once per frame from the state of
+  // the machine, so the frames run ahead are not heard. They are played by the
+  // audio device or written to a WAV file.
+  AudioRingBuffer audio_ring(AUDIO_RING_SIZE);
+  Beeper beeper(AUDIO_SAMPLE_RATE);
+  std::unique_ptr<WavAudioSink> wav_sink;
+  std::unique_ptr<SDLAudioOutput> audio_output;
+  if (!wav_path.empty()) {
+    wav_sink.reset(new WavAudioSink(wav_path, AUDIO_SAMPLE_RATE));
+    if (!wav_sink->isOpen()) {
+      std::cout << "Cannot open WAV file";
+      return -1;
+    }
+  } else {
+    audio_output.reset(new SDLAudioOutput(audio_ring, AUDIO_SAMPLE_RATE));
+    if (!audio_output->isOpen()) {
+      std::cout << "Cannot open audio device: " << SDL_GetError()
+                << std::endl;
+    }
+  }
+
+  // A frame is stored for rewind at each tick of the frame clock, holding
+  // backspace steps back one frame per tick instead. Rewind is not available
+  // while recording as the movie could not be replayed.
+  RewindBuffer rewind_buffer(REWIND_FRAMES, REWIND_STORAGE_SIZE,
+                             REWIND_KEYFRAME_INTERVAL);
+  bool rewinding = false;
+  std::size_t n_frames = 0;
+  Clock frame_clock([]() { return std::chrono::system_clock::now(); });
+  frame_clock.registerCallback(
+      [&]() {
+        if (rewinding) {
+          MachineState state;
+          if (rewind_buffer.stepBack(state)) {
+            emulator.restoreState(state);
+            run_ahead.present();
+          }
+          return;
+        }
+
+        if (queued_input) {
+          input_events.sync(std::chrono::steady_clock::now(),
+                            emulator.countCycles());
+          emulator.runFrame();
+          run_ahead.present();
+          if (recording) {
+            movie.append(input_events.getKeys());
+          }
+        } else if (frame_stepped) {
+          uint16_t keys = readKeys(keyboard_controller);
+          if (recording) {
+            movie.append(keys);
+          }
+          run_ahead.runFrame(keys);
+        }
+        rewind_buffer.push(emulator.getState(),
+                           emulator.getRamWriteTracker());
+
+        beeper.generateFrame(emulator.getState().sound_timer_reg != 0,
+                             audio_ring);
+        if (wav_sink) {
+          drainAudio(audio_ring, *wav_sink);
+        }
+
+        if (run_ahead.getFrames() > 0 &&
+            ++n_frames % RUN_AHEAD_REPORT_INTERVAL == 0) {
+          std::cout << "Run ahead of " << run_ahead.getFrames()
+                    << " frames uses "
+                    << 100.0 * run_ahead.getFrameBudgetUsage()
+                    << "% of the frame" << std::endl;
+        }
+      },
+      FRAME_FREQUENCY);
+
+  // Initialize display_ui, the view renders the frame buffer of the emulator
+  // or the frame run ahead
+  const DisplayModel& presented_display = frame_stepped
+                                              ? run_ahead.getDisplayModel()
+                                              : emulator.getDisplayModel();
   std::unique_ptr<SDLDisplayView> display_view(
-      new SDLDisplayView(display_model.get()));
-  std::unique_ptr<DisplayController> display_controller(
-      new DisplayController(display_model.get(), display_view.get()));
+      new SDLDisplayView(&presented_display));
 
   // Add the display_ui element to the window
   Window main_window(640, 320, "Chip8 emulator");
   main_window.attachNewComponent(display_view.get());
 
-  // Initialize emulator
-  Emulator emulator(rom_file, std::move(display_controller),
-                    &keyboard_controller);
-
   // main loop
   bool quit = false;
   SDL_Event event;
   while (!quit) {
     if (SDL_PollEvent(&event) != 0) {
+      // The event timestamp is in the milliseconds of SDL_GetTicks()
+      if ((event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) &&
+          event.key.repeat == 0) {
+        const auto input_id = key_to_map.toInput(event.key.keysym.sym);
+        if (input_id) {
+          const auto timestamp = std::chrono::steady_clock::now() -
+                                 std::chrono::milliseconds(
+                                     SDL_GetTicks() - event.key.timestamp);
+          const InputState state =
+              event.type == SDL_KEYDOWN ? InputState::ON : InputState::OFF;
+          latency_tracker.keyEvent(*input_id, state, timestamp);
+          if (queued_input) {
+            input_events.pushHostEvent(*input_id, state, timestamp);
+          }
+        }
+      }
+
       // Process keyboard event
       if (keyboard_controller.processEvent(event)) continue;
 
@@ -85,15 +281,106 @@ int main(int argc, char** argv) {
         case SDL_QUIT:
           quit = true;
           break;
+        case SDL_KEYDOWN:
+          if (event.key.keysym.sym == SDLK_BACKSPACE && !recording) {
+            rewinding = true;
+          } else if (event.key.keysym.sym == SDLK_F5) {
+            save_state_writer->write(emulator.getState(), save_state_path);
+          } else if (event.key.keysym.sym == SDLK_F9 && !recording) {
+            std::ifstream save_state_file(save_state_path,
+                                          std::ios_base::binary);
+            MachineState state;
+            if (loadSaveState(save_state_file, rom_image, state)) {
+              emulator.restoreState(state);
+              run_ahead.present();
+            } else {
+              std::cout << "Cannot load save state" << std::endl;
+            }
+          }
+          break;
+        case SDL_KEYUP:
+          if (event.key.keysym.sym == SDLK_BACKSPACE) {
+            rewinding = false;
+          }
+          break;
+      }
+    }
+
+    if (rom_watcher && rom_watcher->poll()) {
+      try {
+        emulator.reload(args[0]);
+
+        // Save states hold the RAM as a difference with the ROM image they
+        // were written with, they are decoded with the previous image then
+        // the bytes changed by the new ROM replace the ones of the state.
+        // The save state is written again against the new image, so a save
+        // state written before an earlier reload cannot be restored.
+        const RAM previous_image = rom_image;
+        rom_image = emulator.getState().ram;
+        save_state_writer->flush();
+        save_state_writer.reset(new SaveStateWriter(rom_image));
+        std::ifstream save_state_file(save_state_path, std::ios_base::binary);
+        MachineState state;
+        if (loadSaveState(save_state_file, previous_image, state)) {
+          for (std::size_t i = 0; i < RAM::size(); ++i) {
+            if (rom_image[i] != previous_image[i]) {
+              state.ram[i] = rom_image[i];
+            }
+          }
+          save_state_writer->write(state, save_state_path);
+          if (watch_restore) {
+            emulator.restoreState(state);
+          }
+        }
+
+        // The history belongs to the previous version of the program
+        rewind_buffer.clear();
+        run_ahead.present();
+        std::cout << "Reloaded " << args[0] << std::endl;
+      } catch (const std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
       }
     }
 
-    emulator.update();
+    // The machine is paused while rewinding
+    if (!rewinding && !frame_stepped) {
+      emulator.update();
+    }
+    frame_clock.tick();
 
     main_window.update();
+    latency_tracker.framePresented(presented_display,
+                                   std::chrono::steady_clock::now());
 
     SDL_Delay(1);
   }
 
+  if (wav_sink && !wav_sink->close()) {
+    std::cout << "Cannot write WAV file" << std::endl;
+  }
+
+  std::cout << "Key event to guest latency: ";
+  latency_tracker.getObserveLatency().print(std::cout);
+  std::cout << "Key event to screen latency: ";
+  latency_tracker.getPresentLatency().print(std::cout);
+
+  if (recording) {
+    std::ofstream movie_file(args[1], std::ios_base::binary);
+    movie.save(movie_file);
+    if (!movie_file) {
+      std::cout << "Cannot write input movie" << std::endl;
+      return -1;
+    }
+
+    if (queued_input) {
+      std::ofstream events_file(args[1] + ".events", std::ios_base::binary);
+      saveInputEvents(events_file, input_events.getLog(), movie.getSeed());
+      if (!events_file) {
+        std::cout << "Cannot write input events" << std::endl;
+        return -1;
+      }
+    }
+  }
+
   return 0;
 }
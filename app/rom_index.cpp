@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "library/rom_index.h"
+
+using namespace chip8;
+
+static const std::string THREADS_OPTION = "--threads=";
+static const std::string SPEED_OPTION = "--speed=";
+
+int main(int argc, char** argv) {
+  if (argc < 3) {
+    std::cout << "Usage: " << argv[0]
+              << " <index> <directory>... [--threads=N] [--list]"
+                 " [--speed=HASH:CYCLES_PER_FRAME]...\n";
+    return -1;
+  }
+
+  std::size_t n_threads = std::thread::hardware_concurrency();
+  bool list = false;
+  std::vector<std::pair<uint64_t, uint32_t>> speeds;
+  std::vector<std::string> directories;
+  for (int i = 2; i < argc; ++i) {
+    const std::string arg(argv[i]);
+    if (arg.compare(0, THREADS_OPTION.size(), THREADS_OPTION) == 0) {
+      n_threads = std::stoul(arg.substr(THREADS_OPTION.size()));
+    } else if (arg == "--list") {
+      list = true;
+    } else if (arg.compare(0, SPEED_OPTION.size(), SPEED_OPTION) == 0) {
+      // Best known speed of a ROM, used by the batch jobs running it
+      const std::size_t separator = arg.find(':');
+      try {
+        speeds.emplace_back(
+            std::stoull(arg.substr(SPEED_OPTION.size(),
+                                   separator - SPEED_OPTION.size()),
+                        nullptr, 16),
+            std::stoul(arg.substr(separator + 1)));
+      } catch (const std::exception&) {
+        std::cout << "Invalid speed: " << arg << "\n";
+        return -1;
+      }
+    } else {
+      directories.push_back(arg);
+    }
+  }
+
+  // A missing or outdated index is rebuilt from scratch
+  const std::string index_path(argv[1]);
+  RomIndex index;
+  if (!index.load(index_path)) {
+    std::cout << "Creating index " << index_path << "\n";
+  }
+
+  const ScanStatistics statistics = index.scan(directories, n_threads);
+  for (const auto& speed : speeds) {
+    if (!index.setCyclesPerFrame(speed.first, speed.second)) {
+      std::cout << "Unknown ROM: " << std::hex << speed.first << std::dec
+                << "\n";
+    }
+  }
+  if (!index.save(index_path)) {
+    std::cout << "Cannot write index " << index_path << "\n";
+    return -1;
+  }
+
+  if (list) {
+    for (const auto& entry : index.getEntries()) {
+      std::cout << std::hex << std::setfill('0') << std::setw(16)
+                << entry.hash << std::dec
+                << (entry.analysis.variant == RomVariant::SUPER_CHIP
+                        ? " schip "
+                        : " chip8 ")
+                << std::setfill(' ') << std::setw(5) << entry.size << " "
+                << entry.path << "\n";
+    }
+  }
+
+  std::cout << statistics.n_roms << " ROMs, " << statistics.n_analyzed
+            << " analyzed, " << statistics.n_removed << " removed, "
+            << statistics.n_errors << " errors\n";
+  return statistics.n_errors == 0 ? 0 : 1;
+}
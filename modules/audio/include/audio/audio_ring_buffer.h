@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_AUDIO_AUDIO_RING_BUFFER_H_
+#define MODULES_AUDIO_AUDIO_RING_BUFFER_H_
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace chip8 {
+
+/*!
+ * @class AudioRingBuffer
+ * Lock free ring of audio samples between a single producer, the emulation
+ * thread, and a single consumer, e.g. the audio callback. Neither side ever
+ * waits: samples written while the ring is full are dropped and a read
+ * returns what is available.
+ */
+class AudioRingBuffer {
+ public:
+  /*!
+   * @param capacity number of samples, rounded up to a power of two
+   */
+  explicit AudioRingBuffer(std::size_t capacity);
+
+  AudioRingBuffer(const AudioRingBuffer&) = delete;
+  AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+  /*!
+   * Producer side
+   * @param samples
+   * @param n_samples
+   * @return number of samples written, the others are dropped
+   */
+  std::size_t write(const int16_t* samples, std::size_t n_samples);
+
+  /*!
+   * Consumer side
+   * @param samples filled with the oldest samples
+   * @param n_samples maximum number of samples to read
+   * @return number of samples read
+   */
+  std::size_t read(int16_t* samples, std::size_t n_samples);
+
+  /*!
+   * @return number of samples that can be read, exact from the consumer
+   */
+  std::size_t countAvailable() const;
+
+  std::size_t getCapacity() const { return m_samples.size(); }
+
+  /*!
+   * @return number of samples dropped because the ring was full
+   */
+  uint64_t countDropped() const {
+    return m_n_dropped.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::vector<int16_t> m_samples;
+  std::size_t m_mask;
+
+  // Each index is written by one side only, keep them on their own lines
+  alignas(64) std::atomic<uint64_t> m_write_index;
+  alignas(64) std::atomic<uint64_t> m_read_index;
+  alignas(64) std::atomic<uint64_t> m_n_dropped;
+};
+
+}  // namespace chip8
+#endif  // MODULES_AUDIO_AUDIO_RING_BUFFER_H_
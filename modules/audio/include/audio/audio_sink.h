@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_AUDIO_AUDIO_SINK_H_
+#define MODULES_AUDIO_AUDIO_SINK_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "audio_ring_buffer.h"
+
+namespace chip8 {
+
+/*!
+ * Consumer of the audio samples when there is no audio device, e.g. headless
+ */
+class AudioSink {
+ public:
+  virtual ~AudioSink() = default;
+  virtual void write(const int16_t* samples, std::size_t n_samples) = 0;
+};
+
+/*!
+ * Discard the samples, only count them
+ */
+class NullAudioSink : public AudioSink {
+ public:
+  NullAudioSink() : m_n_samples(0) {}
+
+  void write(const int16_t*, std::size_t n_samples) override {
+    m_n_samples += n_samples;
+  }
+
+  uint64_t countSamples() const { return m_n_samples; }
+
+ private:
+  uint64_t m_n_samples;
+};
+
+/*!
+ * Write the samples to a mono 16 bits PCM WAV file. The sizes in the header
+ * are updated when the file is closed.
+ */
+class WavAudioSink : public AudioSink {
+ public:
+  /*!
+   * @param path path of the file, overwritten
+   * @param sample_rate number of samples per second
+   */
+  WavAudioSink(const std::string& path, unsigned sample_rate);
+  ~WavAudioSink() override;
+
+  void write(const int16_t* samples, std::size_t n_samples) override;
+
+  /*!
+   * Update the header and close the file
+   * @return true if the whole file was written
+   */
+  bool close();
+
+  bool isOpen() const { return m_file.is_open(); }
+
+  uint64_t countSamples() const { return m_n_samples; }
+
+ private:
+  std::ofstream m_file;
+  unsigned m_sample_rate;
+  uint64_t m_n_samples;
+};
+
+/*!
+ * Move all the samples available in the ring to the sink
+ * @param ring
+ * @param sink
+ * @return number of samples moved
+ */
+std::size_t drainAudio(AudioRingBuffer& ring, AudioSink& sink);
+
+}  // namespace chip8
+#endif  // MODULES_AUDIO_AUDIO_SINK_H_
@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_AUDIO_BEEPER_H_
+#define MODULES_AUDIO_BEEPER_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "audio_ring_buffer.h"
+
+namespace chip8 {
+
+extern const double BEEPER_FREQUENCY;
+extern const int16_t BEEPER_AMPLITUDE;
+
+/*!
+ * @class Beeper
+ * Generate the samples of the Chip-8 buzzer, a square wave played while the
+ * sound timer is not zero. Silence is generated too so that the stream keeps
+ * the pace of the emulation.
+ */
+class Beeper {
+ public:
+  /*!
+   * @param sample_rate number of samples per second
+   * @param frequency frequency of the tone [Hz]
+   * @param amplitude
+   */
+  explicit Beeper(unsigned sample_rate, double frequency = BEEPER_FREQUENCY,
+                  int16_t amplitude = BEEPER_AMPLITUDE);
+
+  /*!
+   * Write the samples of a 60 Hz frame to the ring, never waits
+   * @param sounding true if the sound timer is not zero
+   * @param ring
+   * @return number of samples of the frame
+   */
+  std::size_t generateFrame(bool sounding, AudioRingBuffer& ring);
+
+  unsigned getSampleRate() const { return m_sample_rate; }
+
+ private:
+  unsigned m_sample_rate;
+  int16_t m_amplitude;
+  // Phase of the square wave and its increment per sample, in periods
+  double m_phase;
+  double m_phase_increment;
+  // Frames generated, the number of samples of a frame is rounded so that
+  // the stream does not drift
+  uint64_t m_n_frames;
+  std::vector<int16_t> m_frame_samples;
+};
+
+}  // namespace chip8
+#endif  // MODULES_AUDIO_BEEPER_H_
@@ -0,0 +1,90 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+
+#include "audio/audio_ring_buffer.h"
+
+namespace chip8 {
+
+static std::size_t roundUpToPowerOfTwo(std::size_t value) {
+  std::size_t power = 1;
+  while (power < value) {
+    power <<= 1;
+  }
+  return power;
+}
+
+AudioRingBuffer::AudioRingBuffer(std::size_t capacity)
+    : m_samples(roundUpToPowerOfTwo(std::max<std::size_t>(capacity, 1))),
+      m_mask(m_samples.size() - 1),
+      m_write_index(0),
+      m_read_index(0),
+      m_n_dropped(0) {}
+
+std::size_t AudioRingBuffer::write(const int16_t* samples,
+                                   std::size_t n_samples) {
+  const uint64_t write_index = m_write_index.load(std::memory_order_relaxed);
+  const uint64_t read_index = m_read_index.load(std::memory_order_acquire);
+  const std::size_t n_free =
+      m_samples.size() - static_cast<std::size_t>(write_index - read_index);
+  const std::size_t n_written = std::min(n_samples, n_free);
+
+  // The free space may wrap around the end of the ring
+  const std::size_t start = write_index & m_mask;
+  const std::size_t n_first = std::min(n_written, m_samples.size() - start);
+  std::copy(samples, samples + n_first, m_samples.begin() + start);
+  std::copy(samples + n_first, samples + n_written, m_samples.begin());
+
+  m_write_index.store(write_index + n_written, std::memory_order_release);
+  if (n_written != n_samples) {
+    m_n_dropped.fetch_add(n_samples - n_written, std::memory_order_relaxed);
+  }
+  return n_written;
+}
+
+std::size_t AudioRingBuffer::read(int16_t* samples, std::size_t n_samples) {
+  const uint64_t read_index = m_read_index.load(std::memory_order_relaxed);
+  const uint64_t write_index = m_write_index.load(std::memory_order_acquire);
+  const std::size_t n_read =
+      std::min(n_samples, static_cast<std::size_t>(write_index - read_index));
+
+  const std::size_t start = read_index & m_mask;
+  const std::size_t n_first = std::min(n_read, m_samples.size() - start);
+  std::copy_n(m_samples.begin() + start, n_first, samples);
+  std::copy_n(m_samples.begin(), n_read - n_first, samples + n_first);
+
+  m_read_index.store(read_index + n_read, std::memory_order_release);
+  return n_read;
+}
+
+std::size_t AudioRingBuffer::countAvailable() const {
+  return static_cast<std::size_t>(
+      m_write_index.load(std::memory_order_acquire) -
+      m_read_index.load(std::memory_order_acquire));
+}
+
+}  // namespace chip8
@@ -0,0 +1,97 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <array>
+
+#include "audio/audio_sink.h"
+
+#include "emulator/little_endian.h"
+
+namespace chip8 {
+
+static const uint32_t WAV_HEADER_SIZE = 44;
+static const uint16_t WAV_BITS_PER_SAMPLE = 16;
+static const std::size_t DRAIN_CHUNK_SIZE = 1024;
+
+static void writeWavHeader(std::ostream& output_stream, unsigned sample_rate,
+                           uint32_t data_size) {
+  const uint16_t block_align = WAV_BITS_PER_SAMPLE / 8;
+
+  output_stream.write("RIFF", 4);
+  writeValue(output_stream, WAV_HEADER_SIZE - 8 + data_size);
+  output_stream.write("WAVEfmt ", 8);
+  writeValue(output_stream, uint32_t(16));
+  writeValue(output_stream, uint16_t(1));  // PCM
+  writeValue(output_stream, uint16_t(1));  // mono
+  writeValue(output_stream, static_cast<uint32_t>(sample_rate));
+  writeValue(output_stream, static_cast<uint32_t>(sample_rate * block_align));
+  writeValue(output_stream, block_align);
+  writeValue(output_stream, WAV_BITS_PER_SAMPLE);
+  output_stream.write("data", 4);
+  writeValue(output_stream, data_size);
+}
+
+WavAudioSink::WavAudioSink(const std::string& path, unsigned sample_rate)
+    : m_file(path, std::ios_base::binary | std::ios_base::trunc),
+      m_sample_rate(sample_rate),
+      m_n_samples(0) {
+  writeWavHeader(m_file, sample_rate, 0);
+}
+
+WavAudioSink::~WavAudioSink() { close(); }
+
+void WavAudioSink::write(const int16_t* samples, std::size_t n_samples) {
+  for (std::size_t i = 0; i < n_samples; ++i) {
+    writeValue(m_file, static_cast<uint16_t>(samples[i]));
+  }
+  m_n_samples += n_samples;
+}
+
+bool WavAudioSink::close() {
+  if (!m_file.is_open()) {
+    return false;
+  }
+
+  m_file.seekp(0);
+  writeWavHeader(m_file, m_sample_rate,
+                 static_cast<uint32_t>(m_n_samples * WAV_BITS_PER_SAMPLE / 8));
+  const bool success = static_cast<bool>(m_file);
+  m_file.close();
+  return success;
+}
+
+std::size_t drainAudio(AudioRingBuffer& ring, AudioSink& sink) {
+  std::array<int16_t, DRAIN_CHUNK_SIZE> chunk;
+  std::size_t n_drained = 0;
+  std::size_t n_read = 0;
+  while ((n_read = ring.read(chunk.data(), chunk.size())) != 0) {
+    sink.write(chunk.data(), n_read);
+    n_drained += n_read;
+  }
+  return n_drained;
+}
+
+}  // namespace chip8
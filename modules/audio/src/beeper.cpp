@@ -0,0 +1,68 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+
+#include "audio/beeper.h"
+
+namespace chip8 {
+
+extern const double BEEPER_FREQUENCY = 440;
+extern const int16_t BEEPER_AMPLITUDE = 4096;
+
+static const unsigned FRAME_FREQUENCY = 60;
+
+Beeper::Beeper(unsigned sample_rate, double frequency, int16_t amplitude)
+    : m_sample_rate(sample_rate),
+      m_amplitude(amplitude),
+      m_phase(0),
+      m_phase_increment(frequency / sample_rate),
+      m_n_frames(0),
+      m_frame_samples(sample_rate / FRAME_FREQUENCY + 1) {}
+
+std::size_t Beeper::generateFrame(bool sounding, AudioRingBuffer& ring) {
+  const std::size_t n_samples = static_cast<std::size_t>(
+      (m_n_frames + 1) * m_sample_rate / FRAME_FREQUENCY -
+      m_n_frames * m_sample_rate / FRAME_FREQUENCY);
+  ++m_n_frames;
+
+  if (sounding) {
+    for (std::size_t i = 0; i < n_samples; ++i) {
+      m_frame_samples[i] = m_phase < 0.5 ? m_amplitude : -m_amplitude;
+      m_phase += m_phase_increment;
+      m_phase -= static_cast<int>(m_phase);
+    }
+  } else {
+    // Restart the tone on a period boundary to avoid clicks
+    std::fill_n(m_frame_samples.begin(), n_samples, 0);
+    m_phase = 0;
+  }
+
+  ring.write(m_frame_samples.data(), n_samples);
+  return n_samples;
+}
+
+}  // namespace chip8
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_BATCH_COORDINATOR_H_
+#define MODULES_BATCH_COORDINATOR_H_
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// linux
+#include <sys/types.h>
+
+#include "batch/job.h"
+
+namespace chip8 {
+
+extern const std::chrono::milliseconds DEFAULT_JOB_TIMEOUT;
+
+/*!
+ * @class Coordinator
+ * Shards a batch of jobs across forked worker processes. Each worker receives
+ * its jobs one by one over a UNIX domain socket and sends back the results.
+ * When a worker crashes, the job it was running is queued again and a new
+ * worker is forked, so the batch is never lost. A worker running a job for
+ * longer than the timeout is killed and handled the same way, so that a hung
+ * job cannot stall the batch. A job that keeps crashing or stalling its
+ * workers is reported as failed after a maximal number of attempts.
+ *
+ * Each worker runs its jobs on a single machine state allocated from an
+ * InstanceArena.
+ */
+class Coordinator {
+ public:
+  using JobRunner = std::function<JobResult(const Job&, MachineState&)>;
+
+  /*!
+   * @param n_workers number of worker processes
+   * @param max_attempts number of workers a job may crash before giving up
+   * @param job_runner function executing a job inside a worker, on the
+   * machine state of the worker
+   * @param job_timeout time a worker may spend on a job before it is killed
+   */
+  explicit Coordinator(
+      std::size_t n_workers, uint32_t max_attempts = 3,
+      JobRunner job_runner = static_cast<JobResult (*)(const Job&,
+                                                       MachineState&)>(runJob),
+      std::chrono::milliseconds job_timeout = DEFAULT_JOB_TIMEOUT);
+  ~Coordinator();
+
+  Coordinator(const Coordinator&) = delete;
+  Coordinator& operator=(const Coordinator&) = delete;
+
+  /*!
+   * Run all the jobs
+   * @param jobs
+   * @return one result per job, in the order of the jobs
+   */
+  std::vector<JobResult> run(const std::vector<Job>& jobs);
+
+  /*!
+   * @return number of workers restarted after a crash or a timeout since
+   * construction
+   */
+  std::size_t countRestarts() const { return m_n_restarts; }
+
+ private:
+  struct Worker {
+    pid_t pid;
+    int socket;
+    bool busy;
+    std::size_t job_index;
+    std::chrono::steady_clock::time_point deadline;
+  };
+
+  void startWorker(Worker& worker);
+  void stopWorker(Worker& worker);
+
+ private:
+  std::vector<Worker> m_workers;
+  uint32_t m_max_attempts;
+  JobRunner m_job_runner;
+  std::chrono::milliseconds m_job_timeout;
+  std::size_t m_n_restarts;
+};
+
+/*!
+ * Serve the jobs received on the socket until it is closed. This is the main
+ * loop of a worker process, the jobs run on a machine state allocated once
+ * from an InstanceArena.
+ * @param socket connected UNIX domain socket
+ * @param job_runner function executing the jobs
+ */
+void serveJobs(int socket, const Coordinator::JobRunner& job_runner);
+
+}  // namespace chip8
+#endif  // MODULES_BATCH_COORDINATOR_H_
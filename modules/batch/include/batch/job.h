@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_BATCH_JOB_H_
+#define MODULES_BATCH_JOB_H_
+
+// std
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "emulator/machine_state.h"
+
+namespace chip8 {
+
+/*!
+ * @struct Job
+ * Headless run of a ROM: the inputs of each frame and the seed of the random
+ * number generator are read from an input movie (no key is pressed and the
+ * seed is 0 if no movie is given). If a log of input events was recorded with
+ * the movie (same path with the ".events" suffix), the events are replayed
+ * at their cycle instead.
+ */
+struct Job {
+  std::string rom_path;
+  std::string movie_path;
+  uint64_t n_frames;
+  /// Speed of the ROM, e.g. its best known speed in the ROM index, 0 runs
+  /// CYCLES_PER_FRAME instructions per frame
+  uint32_t cycles_per_frame = 0;
+};
+
+/*!
+ * @struct JobResult
+ * Outcome of a job
+ */
+struct JobResult {
+  bool success;
+  std::string error;
+  uint64_t final_state_hash;
+  uint64_t frames_hash;  ///< chained hash of the display after each frame
+  uint64_t n_instructions;
+  uint64_t duration_ns;  ///< time spent running the job in the worker
+  uint32_t n_attempts;  ///< number of workers that ran the job
+};
+
+/*!
+ * Run a job in the current process
+ * @param job
+ * @return the result of the job, errors are reported in the result
+ */
+JobResult runJob(const Job& job);
+
+/*!
+ * Run a job in the current process on a machine state provided by the
+ * caller, e.g. a slot of an InstanceArena reused from one job to the next
+ * @param job
+ * @param state storage of the machine state, reset before the job runs
+ * @return the result of the job, errors are reported in the result
+ */
+JobResult runJob(const Job& job, MachineState& state);
+
+/*!
+ * Serialize a job into a message exchanged between processes
+ * @param job
+ * @return bytes of the message
+ */
+std::vector<uint8_t> encodeJob(const Job& job);
+
+/*!
+ * @param message bytes produced by encodeJob
+ * @param job decoded job
+ * @return true if the message was well formed
+ */
+bool decodeJob(const std::vector<uint8_t>& message, Job& job);
+
+/*!
+ * Serialize a job result into a message exchanged between processes
+ * @param result
+ * @return bytes of the message
+ */
+std::vector<uint8_t> encodeJobResult(const JobResult& result);
+
+/*!
+ * @param message bytes produced by encodeJobResult
+ * @param result decoded result
+ * @return true if the message was well formed
+ */
+bool decodeJobResult(const std::vector<uint8_t>& message, JobResult& result);
+
+}  // namespace chip8
+#endif  // MODULES_BATCH_JOB_H_
@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <limits>
+#include <string>
+#include <system_error>
+
+// linux
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "batch/coordinator.h"
+
+#include "emulator/instance_arena.h"
+
+namespace chip8 {
+
+extern const std::chrono::milliseconds DEFAULT_JOB_TIMEOUT =
+    std::chrono::minutes(10);
+
+namespace {
+
+bool sendAll(int socket, const void* data, std::size_t size) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  while (size > 0) {
+    // Never raise SIGPIPE if the peer crashed
+    ssize_t n_sent = send(socket, bytes, size, MSG_NOSIGNAL);
+    if (n_sent < 0 && errno == EINTR) continue;
+    if (n_sent <= 0) return false;
+    bytes += n_sent;
+    size -= static_cast<std::size_t>(n_sent);
+  }
+  return true;
+}
+
+bool receiveAll(int socket, void* data, std::size_t size) {
+  auto bytes = static_cast<uint8_t*>(data);
+  while (size > 0) {
+    ssize_t n_received = recv(socket, bytes, size, 0);
+    if (n_received < 0 && errno == EINTR) continue;
+    if (n_received <= 0) return false;
+    bytes += n_received;
+    size -= static_cast<std::size_t>(n_received);
+  }
+  return true;
+}
+
+// Messages are prefixed by their size, both ends run on the same host
+bool sendMessage(int socket, const std::vector<uint8_t>& message) {
+  auto size = static_cast<uint32_t>(message.size());
+  return sendAll(socket, &size, sizeof(size)) &&
+         sendAll(socket, message.data(), message.size());
+}
+
+bool receiveMessage(int socket, std::vector<uint8_t>& message) {
+  uint32_t size;
+  if (!receiveAll(socket, &size, sizeof(size))) {
+    return false;
+  }
+
+  message.resize(size);
+  return receiveAll(socket, message.data(), size);
+}
+
+JobResult makeFailure(const std::string& error, uint32_t n_attempts) {
+  return JobResult{false, error, 0, 0, 0, 0, n_attempts};
+}
+
+}  // namespace
+
+void serveJobs(int socket, const Coordinator::JobRunner& job_runner) {
+  // Every job of the worker reuses the same state
+  InstanceArena arena(1);
+  MachineState& state = *arena.allocate();
+
+  std::vector<uint8_t> message;
+  while (receiveMessage(socket, message)) {
+    Job job;
+    JobResult result;
+    if (!decodeJob(message, job)) {
+      result = makeFailure("malformed job", 1);
+    } else {
+      try {
+        result = job_runner(job, state);
+      } catch (const std::exception& e) {
+        result = makeFailure(e.what(), 1);
+      }
+    }
+
+    if (!sendMessage(socket, encodeJobResult(result))) {
+      return;
+    }
+  }
+}
+
+Coordinator::Coordinator(std::size_t n_workers, uint32_t max_attempts,
+                         JobRunner job_runner,
+                         std::chrono::milliseconds job_timeout)
+    : m_workers(std::max<std::size_t>(n_workers, 1),
+                Worker{-1, -1, false, 0, {}}),
+      m_max_attempts(std::max<uint32_t>(max_attempts, 1)),
+      m_job_runner(std::move(job_runner)),
+      m_job_timeout(job_timeout),
+      m_n_restarts(0) {
+  for (auto& worker : m_workers) {
+    startWorker(worker);
+  }
+}
+
+Coordinator::~Coordinator() {
+  for (auto& worker : m_workers) {
+    stopWorker(worker);
+  }
+}
+
+void Coordinator::startWorker(Worker& worker) {
+  int sockets[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+    throw std::system_error(errno, std::generic_category(), "socketpair");
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    int error = errno;
+    close(sockets[0]);
+    close(sockets[1]);
+    throw std::system_error(error, std::generic_category(), "fork");
+  }
+
+  if (pid == 0) {
+    // Worker process: only keep its own end of the connection
+    close(sockets[0]);
+    for (auto& other : m_workers) {
+      if (other.socket >= 0) {
+        close(other.socket);
+      }
+    }
+    serveJobs(sockets[1], m_job_runner);
+    _exit(0);
+  }
+
+  close(sockets[1]);
+  worker = Worker{pid, sockets[0], false, 0, {}};
+}
+
+void Coordinator::stopWorker(Worker& worker) {
+  if (worker.socket >= 0) {
+    // The worker exits as soon as its connection is closed
+    close(worker.socket);
+    waitpid(worker.pid, nullptr, 0);
+  }
+
+  worker = Worker{-1, -1, false, 0, {}};
+}
+
+std::vector<JobResult> Coordinator::run(const std::vector<Job>& jobs) {
+  std::vector<JobResult> results(jobs.size());
+  std::vector<uint32_t> n_attempts(jobs.size(), 0);
+  std::deque<std::size_t> pending_jobs;
+  for (std::size_t index = 0; index < jobs.size(); ++index) {
+    pending_jobs.push_back(index);
+  }
+
+  // Replace a worker that crashed or stalled and retry its job
+  std::size_t n_finished = 0;
+  auto restartWorker = [&](Worker& worker, const std::string& error) {
+    const std::size_t job_index = worker.job_index;
+    stopWorker(worker);
+    startWorker(worker);
+    ++m_n_restarts;
+
+    if (n_attempts[job_index] >= m_max_attempts) {
+      results[job_index] = makeFailure(error, n_attempts[job_index]);
+      ++n_finished;
+    } else {
+      pending_jobs.push_front(job_index);
+    }
+  };
+
+  std::vector<pollfd> poll_fds;
+  std::vector<Worker*> polled_workers;
+  while (n_finished < jobs.size()) {
+    // Give a job to each idle worker. A failed send is detected by poll.
+    for (auto& worker : m_workers) {
+      if (!worker.busy && !pending_jobs.empty()) {
+        worker.busy = true;
+        worker.job_index = pending_jobs.front();
+        worker.deadline = std::chrono::steady_clock::now() + m_job_timeout;
+        pending_jobs.pop_front();
+        ++n_attempts[worker.job_index];
+        sendMessage(worker.socket, encodeJob(jobs[worker.job_index]));
+      }
+    }
+
+    poll_fds.clear();
+    polled_workers.clear();
+    auto next_deadline = std::chrono::steady_clock::time_point::max();
+    for (auto& worker : m_workers) {
+      if (worker.busy) {
+        poll_fds.push_back(pollfd{worker.socket, POLLIN, 0});
+        polled_workers.push_back(&worker);
+        next_deadline = std::min(next_deadline, worker.deadline);
+      }
+    }
+
+    // Wake up at the first deadline to kill the worker if it is still busy
+    const auto timeout = std::chrono::ceil<std::chrono::milliseconds>(
+        next_deadline - std::chrono::steady_clock::now());
+    const int timeout_ms = static_cast<int>(
+        std::clamp<std::chrono::milliseconds::rep>(
+            timeout.count(), 0, std::numeric_limits<int>::max()));
+    if (poll(poll_fds.data(), poll_fds.size(), timeout_ms) < 0) {
+      if (errno == EINTR) continue;
+      throw std::system_error(errno, std::generic_category(), "poll");
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < poll_fds.size(); ++i) {
+      Worker& worker = *polled_workers[i];
+      if (poll_fds[i].revents == 0) {
+        if (now >= worker.deadline) {
+          kill(worker.pid, SIGKILL);
+          restartWorker(worker, "job timed out");
+        }
+        continue;
+      }
+
+      std::size_t job_index = worker.job_index;
+      std::vector<uint8_t> message;
+      JobResult result;
+      if (receiveMessage(worker.socket, message) &&
+          decodeJobResult(message, result)) {
+        result.n_attempts = n_attempts[job_index];
+        results[job_index] = result;
+        worker.busy = false;
+        ++n_finished;
+        continue;
+      }
+
+      // The worker died while running the job
+      restartWorker(worker, "job crashed its worker");
+    }
+  }
+
+  return results;
+}
+
+}  // namespace chip8
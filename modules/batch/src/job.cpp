@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+
+#include "batch/job.h"
+
+#include "emulator/emulator.h"
+#include "emulator/input_event_queue.h"
+#include "emulator/input_movie.h"
+#include "emulator/little_endian.h"
+#include "emulator/state_hash.h"
+
+namespace chip8 {
+
+namespace {
+
+class MessageWriter {
+ public:
+  template <typename T>
+  void write(T value) { appendValue(m_bytes, value); }
+
+  void write(const std::string& value) {
+    write(static_cast<uint32_t>(value.size()));
+    m_bytes.insert(m_bytes.end(), value.begin(), value.end());
+  }
+
+  std::vector<uint8_t> bytes() { return std::move(m_bytes); }
+
+ private:
+  std::vector<uint8_t> m_bytes;
+};
+
+class MessageReader {
+ public:
+  explicit MessageReader(const std::vector<uint8_t>& bytes)
+      : m_bytes(bytes), m_offset(0) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (m_bytes.size() - m_offset < sizeof(T)) {
+      return false;
+    }
+
+    value = readValue<T>(m_bytes.data() + m_offset);
+    m_offset += sizeof(T);
+    return true;
+  }
+
+  bool read(std::string& value) {
+    uint32_t size;
+    if (!read(size) || m_bytes.size() - m_offset < size) {
+      return false;
+    }
+
+    value.assign(m_bytes.begin() + m_offset, m_bytes.begin() + m_offset + size);
+    m_offset += size;
+    return true;
+  }
+
+  bool finished() const { return m_offset == m_bytes.size(); }
+
+ private:
+  const std::vector<uint8_t>& m_bytes;
+  std::size_t m_offset;
+};
+
+}  // namespace
+
+JobResult runJob(const Job& job) {
+  auto state = std::make_unique<MachineState>();
+  return runJob(job, *state);
+}
+
+JobResult runJob(const Job& job, MachineState& state) {
+  JobResult result{false, "", 0, HASH_SEED, 0, 0, 1};
+  auto start = std::chrono::steady_clock::now();
+
+  try {
+    InputMovie movie;
+    if (!job.movie_path.empty()) {
+      std::ifstream movie_file(job.movie_path, std::ios_base::binary);
+      if (!movie.load(movie_file)) {
+        throw std::runtime_error("cannot read input movie " + job.movie_path);
+      }
+    }
+
+    // The events logged next to a recorded movie are replayed at the cycle
+    // they were applied, the keys of the movie are only sampled once a frame
+    std::vector<InputEvent> events;
+    uint32_t events_seed = 0;
+    std::ifstream events_file(job.movie_path + ".events",
+                              std::ios_base::binary);
+    const bool replay_events =
+        !job.movie_path.empty() && events_file &&
+        loadInputEvents(events_file, events, events_seed);
+
+    // Replays are bit identical: same seed and same keys at each frame or at
+    // each cycle
+    InputMoviePlayer player(movie);
+    InputEventQueue input_events(0);
+    std::ifstream rom(job.rom_path, std::ios_base::binary);
+    if (!rom) {
+      throw std::runtime_error("cannot open ROM " + job.rom_path);
+    }
+    Emulator emulator(rom,
+                      replay_events
+                          ? static_cast<UserInputController*>(&input_events)
+                          : &player,
+                      state);
+    if (replay_events) {
+      for (const auto& event : events) {
+        input_events.push(event);
+      }
+      emulator.setInputEventQueue(&input_events);
+    }
+    emulator.seed(replay_events ? events_seed : movie.getSeed());
+    const uint64_t cycles_per_frame =
+        job.cycles_per_frame != 0 ? job.cycles_per_frame : CYCLES_PER_FRAME;
+    for (uint64_t frame = 0; frame < job.n_frames; ++frame) {
+      for (uint64_t cycle = 0; cycle < cycles_per_frame; ++cycle) {
+        emulator.step();
+      }
+      emulator.updateTimers();
+      player.nextFrame();
+      result.frames_hash =
+          hashBytes(emulator.getState().framebuffer.data(),
+                    emulator.getState().framebuffer.size(), result.frames_hash);
+    }
+
+    result.final_state_hash = hashState(emulator.getState());
+    result.n_instructions = job.n_frames * cycles_per_frame;
+    result.success = true;
+  } catch (const std::exception& e) {
+    result.error = e.what();
+  }
+
+  result.duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  return result;
+}
+
+std::vector<uint8_t> encodeJob(const Job& job) {
+  MessageWriter writer;
+  writer.write(job.rom_path);
+  writer.write(job.movie_path);
+  writer.write(job.n_frames);
+  writer.write(job.cycles_per_frame);
+  return writer.bytes();
+}
+
+bool decodeJob(const std::vector<uint8_t>& message, Job& job) {
+  MessageReader reader(message);
+  return reader.read(job.rom_path) && reader.read(job.movie_path) &&
+         reader.read(job.n_frames) && reader.read(job.cycles_per_frame) &&
+         reader.finished();
+}
+
+std::vector<uint8_t> encodeJobResult(const JobResult& result) {
+  MessageWriter writer;
+  writer.write(static_cast<uint8_t>(result.success));
+  writer.write(result.error);
+  writer.write(result.final_state_hash);
+  writer.write(result.frames_hash);
+  writer.write(result.n_instructions);
+  writer.write(result.duration_ns);
+  writer.write(result.n_attempts);
+  return writer.bytes();
+}
+
+bool decodeJobResult(const std::vector<uint8_t>& message, JobResult& result) {
+  MessageReader reader(message);
+  uint8_t success = 0;
+  bool well_formed =
+      reader.read(success) && reader.read(result.error) &&
+      reader.read(result.final_state_hash) && reader.read(result.frames_hash) &&
+      reader.read(result.n_instructions) && reader.read(result.duration_ns) &&
+      reader.read(result.n_attempts) && reader.finished();
+  result.success = success != 0;
+  return well_formed;
+}
+
+}  // namespace chip8
@@ -0,0 +1,155 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_CAPI_CHIP8_H_
+#define MODULES_CAPI_CHIP8_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define CHIP8_API __declspec(dllexport)
+#else
+#define CHIP8_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Stable C interface of the emulator, meant to be bound from other languages.
+ *
+ * Every pointer returned for an instance stays valid, at the same address,
+ * until the instance is destroyed: bindings can wrap them once (e.g. as numpy
+ * arrays) and read the machine after each call without any copy.
+ *
+ * Functions returning an int return CHIP8_OK on success or a negative error
+ * code. Accessors called with a NULL instance return NULL or 0.
+ */
+
+#define CHIP8_ABI_VERSION 2
+
+#define CHIP8_RAM_SIZE 4096
+#define CHIP8_REGISTER_COUNT 16
+#define CHIP8_DISPLAY_WIDTH 64
+#define CHIP8_DISPLAY_HEIGHT 32
+
+#define CHIP8_OK 0
+#define CHIP8_ERROR_INVALID_ARGUMENT -1
+#define CHIP8_ERROR_ROM_TOO_LARGE -2
+#define CHIP8_ERROR_NO_ROM -3
+#define CHIP8_ERROR_INTERNAL -4
+
+typedef struct chip8_instance chip8_instance;
+
+/* Version of the ABI the library was built with */
+CHIP8_API int chip8_abi_version(void);
+
+/* Create an instance with an empty machine. Returns NULL on failure. */
+CHIP8_API chip8_instance* chip8_create(void);
+
+CHIP8_API void chip8_destroy(chip8_instance* instance);
+
+/* Reset the machine and load the program stored in data at 0x200 */
+CHIP8_API int chip8_load_rom(chip8_instance* instance, const uint8_t* data,
+                             size_t size);
+
+/* Execute n_frames 60 Hz frames with the current keys */
+CHIP8_API int chip8_run_frames(chip8_instance* instance, uint32_t n_frames);
+
+/* Set the state of the 16 keys, bit i being the state of key i */
+CHIP8_API void chip8_set_keys(chip8_instance* instance, uint16_t keys);
+
+/*
+ * CHIP8_RAM_SIZE bytes of memory, read only: the emulator hashes the RAM on
+ * each write it makes, a write from outside would leave the hash stale
+ */
+CHIP8_API const uint8_t* chip8_ram(const chip8_instance* instance);
+
+/* CHIP8_REGISTER_COUNT general registers V0 to VF */
+CHIP8_API uint8_t* chip8_registers(chip8_instance* instance);
+
+/* CHIP8_DISPLAY_HEIGHT rows of CHIP8_DISPLAY_WIDTH pixels, 0 or 1 */
+CHIP8_API const uint8_t* chip8_framebuffer(const chip8_instance* instance);
+
+CHIP8_API uint16_t chip8_program_counter(const chip8_instance* instance);
+CHIP8_API uint16_t chip8_index_register(const chip8_instance* instance);
+CHIP8_API uint8_t chip8_delay_timer(const chip8_instance* instance);
+CHIP8_API uint8_t chip8_sound_timer(const chip8_instance* instance);
+
+/*
+ * Vector of environments for reinforcement learning, see VectorEnvironment.
+ * All the buffers are provided by the caller and hold one entry per
+ * environment, observations being chip8_vec_env_observation_size() bytes each.
+ */
+
+#define CHIP8_VEC_ENV_MAX_POOL 0x1
+#define CHIP8_VEC_ENV_BIT_PACKED 0x2
+
+typedef struct chip8_vec_env chip8_vec_env;
+
+typedef struct {
+  uint16_t address;
+  float scale;
+} chip8_reward_extractor;
+
+typedef struct {
+  uint16_t address;
+  uint8_t value;
+} chip8_terminal_condition;
+
+typedef struct {
+  uint32_t frame_skip;
+  uint32_t flags; /* CHIP8_VEC_ENV_* */
+  uint64_t max_episode_frames;
+  const chip8_reward_extractor* rewards;
+  size_t n_rewards;
+  const chip8_terminal_condition* terminal_conditions;
+  size_t n_terminal_conditions;
+} chip8_vec_env_config;
+
+/* Returns NULL if the config is invalid or on failure */
+CHIP8_API chip8_vec_env* chip8_vec_env_create(
+    const uint8_t* rom, size_t size, size_t n_environments,
+    const chip8_vec_env_config* config);
+
+CHIP8_API void chip8_vec_env_destroy(chip8_vec_env* env);
+
+CHIP8_API size_t chip8_vec_env_observation_size(const chip8_vec_env* env);
+
+/* seeds may be NULL to keep the random number generators running */
+CHIP8_API int chip8_vec_env_reset(chip8_vec_env* env, const uint64_t* seeds,
+                                  uint8_t* observations);
+
+CHIP8_API int chip8_vec_env_step(chip8_vec_env* env, const uint16_t* actions,
+                                 uint8_t* observations, float* rewards,
+                                 uint8_t* dones);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // MODULES_CAPI_CHIP8_H_
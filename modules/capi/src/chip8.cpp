@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+
+#include "chip8/chip8.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/machine_state.h"
+#include "emulator/rom_loader.h"
+
+using namespace chip8;
+
+static_assert(sizeof(GeneralRegister) == 1,
+              "registers are exposed as a plain byte array");
+static_assert(RAM::size() == CHIP8_RAM_SIZE, "RAM size mismatch");
+static_assert(DISPLAY_WIDTH == CHIP8_DISPLAY_WIDTH &&
+                  DISPLAY_HEIGHT == CHIP8_DISPLAY_HEIGHT,
+              "display size mismatch");
+
+struct chip8_instance {
+  // The emulator is rebuilt on each load but always runs on this state, so
+  // the pointers handed out stay valid
+  MachineState state;
+  BitmaskUserInputController keypad;
+  std::unique_ptr<Emulator> emulator;
+};
+
+int chip8_abi_version(void) { return CHIP8_ABI_VERSION; }
+
+chip8_instance* chip8_create(void) {
+  return new (std::nothrow) chip8_instance();
+}
+
+void chip8_destroy(chip8_instance* instance) { delete instance; }
+
+int chip8_load_rom(chip8_instance* instance, const uint8_t* data,
+                   size_t size) {
+  if (instance == nullptr || (data == nullptr && size != 0)) {
+    return CHIP8_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (size > MAX_PROGRAM_SIZE) {
+    return CHIP8_ERROR_ROM_TOO_LARGE;
+  }
+
+  // No exception can cross the C interface
+  try {
+    std::istringstream rom(
+        std::string(reinterpret_cast<const char*>(data), size));
+    instance->emulator.reset();
+    instance->emulator = std::make_unique<Emulator>(rom, &instance->keypad,
+                                                    instance->state);
+  } catch (...) {
+    return CHIP8_ERROR_INTERNAL;
+  }
+
+  return CHIP8_OK;
+}
+
+int chip8_run_frames(chip8_instance* instance, uint32_t n_frames) {
+  if (instance == nullptr) {
+    return CHIP8_ERROR_INVALID_ARGUMENT;
+  }
+
+  if (!instance->emulator) {
+    return CHIP8_ERROR_NO_ROM;
+  }
+
+  for (uint32_t frame = 0; frame < n_frames; ++frame) {
+    instance->emulator->runFrame();
+  }
+
+  return CHIP8_OK;
+}
+
+void chip8_set_keys(chip8_instance* instance, uint16_t keys) {
+  if (instance != nullptr) {
+    instance->keypad.setKeys(keys);
+  }
+}
+
+const uint8_t* chip8_ram(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.ram.data() : nullptr;
+}
+
+uint8_t* chip8_registers(chip8_instance* instance) {
+  return instance != nullptr
+             ? reinterpret_cast<uint8_t*>(instance->state.registers.data())
+             : nullptr;
+}
+
+const uint8_t* chip8_framebuffer(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.framebuffer.data() : nullptr;
+}
+
+uint16_t chip8_program_counter(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.pc : 0;
+}
+
+uint16_t chip8_index_register(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.index_reg : 0;
+}
+
+uint8_t chip8_delay_timer(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.delay_timer_reg : 0;
+}
+
+uint8_t chip8_sound_timer(const chip8_instance* instance) {
+  return instance != nullptr ? instance->state.sound_timer_reg : 0;
+}
@@ -0,0 +1,107 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <utility>
+#include <vector>
+
+#include "chip8/chip8.h"
+
+#include "emulator/rom_loader.h"
+#include "rl/vector_environment.h"
+
+using namespace chip8;
+
+struct chip8_vec_env {
+  chip8_vec_env(const std::vector<uint8_t>& rom, std::size_t n_environments,
+                EnvironmentConfig config)
+      : environment(rom, n_environments, std::move(config)) {}
+
+  VectorEnvironment environment;
+};
+
+chip8_vec_env* chip8_vec_env_create(const uint8_t* rom, size_t size,
+                                    size_t n_environments,
+                                    const chip8_vec_env_config* config) {
+  if ((rom == nullptr && size != 0) || config == nullptr ||
+      (config->rewards == nullptr && config->n_rewards != 0) ||
+      (config->terminal_conditions == nullptr &&
+       config->n_terminal_conditions != 0) ||
+      size > MAX_PROGRAM_SIZE) {
+    return nullptr;
+  }
+
+  // No exception can cross the C interface
+  try {
+    EnvironmentConfig env_config{
+        config->frame_skip,
+        (config->flags & CHIP8_VEC_ENV_MAX_POOL) != 0,
+        (config->flags & CHIP8_VEC_ENV_BIT_PACKED) != 0,
+        config->max_episode_frames,
+        {},
+        {}};
+    for (size_t i = 0; i < config->n_rewards; ++i) {
+      env_config.rewards.push_back(RewardExtractor{
+          config->rewards[i].address, config->rewards[i].scale});
+    }
+    for (size_t i = 0; i < config->n_terminal_conditions; ++i) {
+      env_config.terminal_conditions.push_back(
+          TerminalCondition{config->terminal_conditions[i].address,
+                            config->terminal_conditions[i].value});
+    }
+
+    return new chip8_vec_env(std::vector<uint8_t>(rom, rom + size),
+                             n_environments, std::move(env_config));
+  } catch (...) {
+    return nullptr;
+  }
+}
+
+void chip8_vec_env_destroy(chip8_vec_env* env) { delete env; }
+
+size_t chip8_vec_env_observation_size(const chip8_vec_env* env) {
+  return env != nullptr ? env->environment.observationSize() : 0;
+}
+
+int chip8_vec_env_reset(chip8_vec_env* env, const uint64_t* seeds,
+                        uint8_t* observations) {
+  if (env == nullptr || observations == nullptr) {
+    return CHIP8_ERROR_INVALID_ARGUMENT;
+  }
+
+  env->environment.reset(seeds, observations);
+  return CHIP8_OK;
+}
+
+int chip8_vec_env_step(chip8_vec_env* env, const uint16_t* actions,
+                       uint8_t* observations, float* rewards, uint8_t* dones) {
+  if (env == nullptr || actions == nullptr || observations == nullptr ||
+      rewards == nullptr || dones == nullptr) {
+    return CHIP8_ERROR_INVALID_ARGUMENT;
+  }
+
+  env->environment.step(actions, observations, rewards, dones);
+  return CHIP8_OK;
+}
@@ -0,0 +1,179 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_DEBUGGER_TIME_TRAVEL_DEBUGGER_H_
+#define MODULES_DEBUGGER_TIME_TRAVEL_DEBUGGER_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/debug_policy.h"
+#include "emulator/emulator.h"
+#include "emulator/machine_state.h"
+
+namespace chip8 {
+
+extern const std::size_t DEFAULT_SNAPSHOT_INTERVAL;
+extern const std::size_t DEFAULT_MAX_SNAPSHOTS;
+
+/*!
+ * @class TimeTravelDebugger
+ * Run a program instruction by instruction, forward and backward. The
+ * position is the number of instructions executed since the start of the
+ * session and the timers are updated every CYCLES_PER_FRAME instructions.
+ *
+ * The machine is snapshotted every snapshot_interval instructions and the keys
+ * are logged when they change, so execution is deterministic from any
+ * snapshot. Going back to a position restores the closest snapshot before it
+ * and executes the remaining instructions again: a reverse step costs at most
+ * one interval of instructions.
+ *
+ * Once max_snapshots are kept, every other snapshot is dropped and the
+ * interval is doubled. The memory stays bounded however long the session is,
+ * while a reverse step only grows with the logarithm of its length.
+ *
+ * The execution stops on breakpoints, i.e. before the instruction at a given
+ * address, and on watchpoints, i.e. after an instruction writing a given RAM
+ * address. Both are checked by a BreakpointPolicy before each instruction.
+ */
+class TimeTravelDebugger {
+ public:
+  /*!
+   * @param rom program to debug
+   * @param snapshot_interval number of instructions between two snapshots
+   * @param max_snapshots number of snapshots kept at most, 2 at least
+   */
+  explicit TimeTravelDebugger(
+      std::istream& rom,
+      std::size_t snapshot_interval = DEFAULT_SNAPSHOT_INTERVAL,
+      std::size_t max_snapshots = DEFAULT_MAX_SNAPSHOTS);
+  ~TimeTravelDebugger();
+
+  TimeTravelDebugger(const TimeTravelDebugger&) = delete;
+  TimeTravelDebugger& operator=(const TimeTravelDebugger&) = delete;
+
+  void addBreakpoint(uint16_t address) {
+    m_breakpoints.addBreakpoint(address);
+  }
+  void removeBreakpoint(uint16_t address) {
+    m_breakpoints.removeBreakpoint(address);
+  }
+  void addWatchpoint(uint16_t address) {
+    m_watchpoints.addWriteWatchpoint(address);
+  }
+  void removeWatchpoint(uint16_t address) {
+    m_watchpoints.removeWriteWatchpoint(address);
+  }
+
+  /*!
+   * Change the keys pressed from the current position. Changing them in the
+   * past discards the execution recorded after the current position.
+   * @param keys bit i is set if key i is pressed
+   */
+  void setKeys(uint16_t keys);
+
+  /*!
+   * Execute one instruction
+   */
+  void stepForward();
+
+  /*!
+   * Execute until a breakpoint or watchpoint is hit
+   * @param max_instructions the execution stops after that many instructions
+   * @return true if the execution stopped on a breakpoint or watchpoint
+   */
+  bool continueForward(uint64_t max_instructions);
+
+  /*!
+   * Go back to the state before the last instruction
+   * @return false at the start of the session
+   */
+  bool stepBackward();
+
+  /*!
+   * Go back to the last position before the current one where a breakpoint or
+   * watchpoint was hit, or to the start of the session
+   * @return true if the execution stopped on a breakpoint or watchpoint
+   */
+  bool continueBackward();
+
+  /*!
+   * @return number of instructions executed since the start of the session
+   */
+  uint64_t getPosition() const { return m_position; }
+
+  const Emulator& getEmulator() const { return *m_emulator; }
+
+  const MachineState& getState() const { return m_emulator->getState(); }
+
+  /*!
+   * @return number of snapshots kept, about 6 KiB each
+   */
+  std::size_t countSnapshots() const { return m_snapshots.size(); }
+
+  /*!
+   * @return number of instructions between two snapshots, doubled each time
+   * the snapshots are thinned
+   */
+  std::size_t getSnapshotInterval() const { return m_snapshot_interval; }
+
+ private:
+  struct Checkpoint {
+    uint64_t position;
+    MachineState state;
+    uint64_t memory_hash;
+  };
+
+  struct KeysChange {
+    uint64_t position;
+    uint16_t keys;
+  };
+
+  bool execute();
+  void seek(uint64_t position);
+  bool isOnBreakpoint();
+  void takeSnapshot();
+
+ private:
+  std::size_t m_snapshot_interval;
+  const std::size_t m_max_snapshots;
+  BitmaskUserInputController m_keypad;
+  std::unique_ptr<Emulator> m_emulator;
+  uint64_t m_position;
+  std::vector<std::unique_ptr<Checkpoint>> m_snapshots;
+  std::vector<KeysChange> m_keys_log;
+  std::size_t m_next_keys_change;
+  // Kept apart so that an instruction on a breakpoint still hits watchpoints
+  BreakpointPolicy m_breakpoints;
+  BreakpointPolicy m_watchpoints;
+};
+
+}  // namespace chip8
+#endif  // MODULES_DEBUGGER_TIME_TRAVEL_DEBUGGER_H_
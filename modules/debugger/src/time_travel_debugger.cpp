@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <iterator>
+
+#include "debugger/time_travel_debugger.h"
+
+namespace chip8 {
+
+// One second of emulation
+extern const std::size_t DEFAULT_SNAPSHOT_INTERVAL = 600;
+// About 6 MiB of snapshots
+extern const std::size_t DEFAULT_MAX_SNAPSHOTS = 1024;
+
+TimeTravelDebugger::TimeTravelDebugger(std::istream& rom,
+                                       std::size_t snapshot_interval,
+                                       std::size_t max_snapshots)
+    : m_snapshot_interval(std::max<std::size_t>(snapshot_interval, 1)),
+      m_max_snapshots(std::max<std::size_t>(max_snapshots, 2)),
+      m_emulator(std::make_unique<Emulator>(rom, &m_keypad)),
+      m_position(0),
+      m_keys_log{KeysChange{0, 0}},
+      m_next_keys_change(1) {
+  takeSnapshot();
+}
+
+TimeTravelDebugger::~TimeTravelDebugger() = default;
+
+void TimeTravelDebugger::setKeys(uint16_t keys) {
+  auto keys_change = std::upper_bound(
+      m_keys_log.begin(), m_keys_log.end(), m_position,
+      [](uint64_t position, const KeysChange& change) {
+        return position < change.position;
+      });
+  if (std::prev(keys_change)->keys == keys) {
+    return;
+  }
+
+  // The recorded execution after this position does not happen anymore
+  while (!m_keys_log.empty() && m_keys_log.back().position >= m_position) {
+    m_keys_log.pop_back();
+  }
+  while (m_snapshots.back()->position > m_position) {
+    m_snapshots.pop_back();
+  }
+
+  m_keys_log.push_back(KeysChange{m_position, keys});
+  m_next_keys_change = m_keys_log.size() - 1;
+}
+
+void TimeTravelDebugger::stepForward() { execute(); }
+
+bool TimeTravelDebugger::continueForward(uint64_t max_instructions) {
+  for (uint64_t i = 0; i < max_instructions; ++i) {
+    const bool watchpoint_hit = execute();
+    if (watchpoint_hit || isOnBreakpoint()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+bool TimeTravelDebugger::stepBackward() {
+  if (m_position == 0) {
+    return false;
+  }
+
+  seek(m_position - 1);
+  return true;
+}
+
+bool TimeTravelDebugger::continueBackward() {
+  if (m_position == 0) {
+    return false;
+  }
+
+  // Look for the last hit between each snapshot and the next position to
+  // check, starting from the most recent snapshot
+  uint64_t end = m_position;
+  std::size_t index = m_snapshots.size() - 1;
+  while (m_snapshots[index]->position >= end) {
+    --index;
+  }
+
+  while (true) {
+    const uint64_t start = m_snapshots[index]->position;
+    seek(start);
+
+    bool hit = index == 0 && isOnBreakpoint();
+    uint64_t hit_position = start;
+    while (m_position + 1 < end) {
+      const bool watchpoint_hit = execute();
+      if (watchpoint_hit || isOnBreakpoint()) {
+        hit = true;
+        hit_position = m_position;
+      }
+    }
+
+    if (hit) {
+      seek(hit_position);
+      return true;
+    }
+
+    if (index == 0) {
+      seek(0);
+      return false;
+    }
+
+    // A hit on the snapshot itself is found from the previous one, since
+    // watchpoints are detected while executing the instruction before
+    end = start + 1;
+    --index;
+  }
+}
+
+bool TimeTravelDebugger::execute() {
+  while (m_next_keys_change < m_keys_log.size() &&
+         m_keys_log[m_next_keys_change].position <= m_position) {
+    m_keypad.setKeys(m_keys_log[m_next_keys_change].keys);
+    ++m_next_keys_change;
+  }
+
+  // The policy stops before an instruction writing a watched byte, the
+  // watchpoint is hit once the instruction is executed anyway
+  const bool watchpoint_hit = !m_emulator->step(m_watchpoints);
+  if (watchpoint_hit) {
+    m_emulator->step();
+  }
+  ++m_position;
+  if (m_position % CYCLES_PER_FRAME == 0) {
+    m_emulator->updateTimers();
+  }
+
+  if (m_position % m_snapshot_interval == 0 &&
+      m_position > m_snapshots.back()->position) {
+    takeSnapshot();
+  }
+
+  return watchpoint_hit;
+}
+
+void TimeTravelDebugger::seek(uint64_t position) {
+  // Closest snapshot at or before the position
+  auto snapshot = std::upper_bound(
+      m_snapshots.begin(), m_snapshots.end(), position,
+      [](uint64_t position, const std::unique_ptr<Checkpoint>& checkpoint) {
+        return position < checkpoint->position;
+      });
+  const Checkpoint& checkpoint = **std::prev(snapshot);
+  m_emulator->restoreState(checkpoint.state, checkpoint.memory_hash);
+  m_position = checkpoint.position;
+
+  // Keys held at the snapshot
+  auto keys_change = std::upper_bound(
+      m_keys_log.begin(), m_keys_log.end(), m_position,
+      [](uint64_t position, const KeysChange& change) {
+        return position < change.position;
+      });
+  m_keypad.setKeys(std::prev(keys_change)->keys);
+  m_next_keys_change = std::distance(m_keys_log.begin(), keys_change);
+
+  while (m_position < position) {
+    execute();
+  }
+}
+
+bool TimeTravelDebugger::isOnBreakpoint() {
+  const MachineState& state = getState();
+  const uint16_t opcode = state.ram[wrapAddress(state.pc)] << 8 |
+                          state.ram[wrapAddress(state.pc + 1)];
+  return m_breakpoints.check(state, opcode);
+}
+
+void TimeTravelDebugger::takeSnapshot() {
+  m_snapshots.push_back(std::make_unique<Checkpoint>(
+      Checkpoint{m_position, getState(), m_emulator->getMemoryHash()}));
+  if (m_snapshots.size() <= m_max_snapshots) {
+    return;
+  }
+
+  // A snapshot is kept at every multiple of the interval up to the furthest
+  // position reached, the even ones are at the multiples of twice the
+  // interval. Snapshots are only taken past the last one, so no seek in
+  // progress is indexing them.
+  std::size_t n_kept = 0;
+  for (std::size_t i = 0; i < m_snapshots.size(); i += 2) {
+    m_snapshots[n_kept++] = std::move(m_snapshots[i]);
+  }
+  m_snapshots.resize(n_kept);
+  m_snapshot_interval *= 2;
+}
+
+}  // namespace chip8
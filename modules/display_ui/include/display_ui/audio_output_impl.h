@@ -0,0 +1,55 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_DISPLAY_AUDIO_OUTPUT_IMPL_H_
+#define MODULES_DISPLAY_AUDIO_OUTPUT_IMPL_H_
+
+#include "SDL2/SDL.h"
+
+#include "audio/audio_ring_buffer.h"
+
+namespace chip8 {
+
+// Play the samples of the ring on the default audio device. The SDL audio
+// thread consumes the ring and plays silence when it runs dry.
+class SDLAudioOutput {
+ public:
+  SDLAudioOutput(AudioRingBuffer& ring, unsigned sample_rate);
+  ~SDLAudioOutput();
+
+  SDLAudioOutput(const SDLAudioOutput&) = delete;
+  SDLAudioOutput& operator=(const SDLAudioOutput&) = delete;
+
+  bool isOpen() const { return m_device != 0; }
+
+ private:
+  static void fill(void* userdata, Uint8* stream, int len);
+
+  AudioRingBuffer& m_ring;
+  SDL_AudioDeviceID m_device;
+};
+
+}  // namespace chip8
+#endif  // MODULES_DISPLAY_AUDIO_OUTPUT_IMPL_H_
@@ -39,6 +39,7 @@ class SDLInputToKeyMap {
  public:
   SDLInputToKeyMap();
   std::optional<SDL_Keycode> toKey(InputId input_id) const;
+  std::optional<InputId> toInput(SDL_Keycode key) const;
 
  private:
   std::unordered_map<InputId, SDL_Keycode> m_input_to_key;
@@ -0,0 +1,73 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "display_ui/audio_output_impl.h"
+
+namespace chip8 {
+
+// About 10 ms at 44.1 kHz, the latency added by the device buffer
+static const Uint16 DEVICE_BUFFER_SAMPLES = 512;
+
+SDLAudioOutput::SDLAudioOutput(AudioRingBuffer& ring, unsigned sample_rate)
+    : m_ring(ring), m_device(0) {
+  SDL_Init(SDL_INIT_AUDIO);
+
+  SDL_AudioSpec desired;
+  std::memset(&desired, 0, sizeof(desired));
+  desired.freq = static_cast<int>(sample_rate);
+  desired.format = AUDIO_S16SYS;
+  desired.channels = 1;
+  desired.samples = DEVICE_BUFFER_SAMPLES;
+  desired.callback = &SDLAudioOutput::fill;
+  desired.userdata = this;
+
+  SDL_AudioSpec obtained;
+  m_device = SDL_OpenAudioDevice(nullptr, 0, &desired, &obtained, 0);
+  if (m_device != 0) {
+    SDL_PauseAudioDevice(m_device, 0);
+  }
+}
+
+SDLAudioOutput::~SDLAudioOutput() {
+  if (m_device != 0) {
+    SDL_CloseAudioDevice(m_device);
+  }
+}
+
+void SDLAudioOutput::fill(void* userdata, Uint8* stream, int len) {
+  auto* output = static_cast<SDLAudioOutput*>(userdata);
+  auto* samples = reinterpret_cast<int16_t*>(stream);
+  const std::size_t n_samples = static_cast<std::size_t>(len) / sizeof(int16_t);
+
+  const std::size_t n_read = output->m_ring.read(samples, n_samples);
+  std::fill(samples + n_read, samples + n_samples, 0);
+}
+
+}  // namespace chip8
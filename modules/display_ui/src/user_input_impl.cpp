@@ -56,6 +56,15 @@ std::optional<SDL_Keycode> SDLInputToKeyMap::toKey(InputId input_id) const {
   }
 }
 
+std::optional<InputId> SDLInputToKeyMap::toInput(SDL_Keycode key) const {
+  for (const auto& [input_id, input_key] : m_input_to_key) {
+    if (input_key == key) {
+      return input_id;
+    }
+  }
+  return std::optional<InputId>();
+}
+
 SDLKeyboardUserInputController::SDLKeyboardUserInputController(
     const SDLInputToKeyMap& input_to_key_map)
     : m_input_to_key_map(input_to_key_map) {
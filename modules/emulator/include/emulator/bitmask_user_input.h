@@ -0,0 +1,62 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_BITMASK_USER_INPUT_H_
+#define MODULES_INTERPRETER_BITMASK_USER_INPUT_H_
+
+// std
+#include <cstdint>
+
+#include "user_input.h"
+
+namespace chip8 {
+
+/*!
+ * User input controller whose state is a 16 bits mask, bit i being the state
+ * of key i. Used to drive the emulator without any window.
+ */
+class BitmaskUserInputController : public UserInputController {
+ public:
+  BitmaskUserInputController() : m_keys(0) {}
+
+  void setKeys(uint16_t keys) { m_keys = keys; }
+
+  uint16_t getKeys() const { return m_keys; }
+
+  std::optional<InputState> getInputState(InputId input_id) override {
+    if (input_id == InputId::INPUT_ERROR || input_id == InputId::INPUT_SIZE) {
+      return std::optional<InputState>();
+    }
+
+    return (m_keys >> static_cast<int>(input_id)) & 0x1 ? InputState::ON
+                                                        : InputState::OFF;
+  }
+
+ private:
+  uint16_t m_keys;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_BITMASK_USER_INPUT_H_
@@ -27,59 +27,35 @@
 #define MODULES_INTERPRETER_CONTROL_UNIT_IMPL_H_
 
 // std
-#include <random>
 #include <vector>
 
 #include "control_unit.h"
 #include "display_controller.h"
 #include "memory.h"
+#include "ram_write_tracker.h"
+#include "random.h"
+#include "state_hash.h"
 #include "user_input.h"
 
 namespace chip8 {
 
-/*!
- * @tparam T type of the random number generated (needs to be an integral type)
- * @tparam Distribution probabilistic distribution used for number generation
- */
-template<typename T, template<typename> class Distribution>
-class RandomNumberGenerator {
- public:
-  /*!
-   * Constructor
-   * @param min_value minimum value generated
-   * @param max_value maximal value generated
-   */
-  explicit RandomNumberGenerator(T min_value, T max_value)
-      : m_random_engine(m_random_device()),
-        m_distribution(min_value, max_value) {}
-
-  /*!
-   * Generate a random number
-   */
-  T generateNumber() { return m_distribution(m_random_engine); }
-
- private:
-  std::random_device m_random_device;
-  std::mt19937 m_random_engine;
-  Distribution<T> m_distribution;
-};
-
-/*!
- * Random number generator with uniform distribution
- */
-using UniformRandomNumberGenerator =
-    RandomNumberGenerator<uint8_t, std::uniform_int_distribution>;
-
 /*!
  * Implementation of the control unit
  */
 class ControlUnitImpl : public ControlUnit {
  public:
+  /*!
+   * @param random_state state of the generator used by RND, it belongs to the
+   * machine state like the registers
+   * @param random_policy generator used by RND
+   */
   ControlUnitImpl(ProgramCounter& pc, StackPointer& stack_ptr,
                   IndexRegister& index_reg, DelayTimerRegister& delay_timer_reg,
                   SoundTimerRegister& sound_timer_reg, Stack& stack,
-                  std::vector<GeneralRegister>& registers, RAM& ram,
-                  DisplayController& display, UserInputController& ui_ctrler);
+                  GeneralRegisters& registers, RAM& ram,
+                  DisplayController& display, UserInputController& ui_ctrler,
+                  RandomState& random_state,
+                  RandomPolicy random_policy = RandomPolicy::of<Pcg32>());
 
   void clearDisplay() override;
 
@@ -153,6 +129,31 @@ class ControlUnitImpl : public ControlUnit {
 
   void readMultipleRegister(register_id_t reg_x) override;
 
+  /*!
+   * Seed the generator used by RND
+   * @param seed
+   */
+  void seedRandomNumberGenerator(uint64_t seed);
+
+  /*!
+   * Update a hash on each write to the RAM
+   * @param state_hash may be null to stop the updates
+   */
+  void trackRamWrites(IncrementalStateHash* state_hash) {
+    m_state_hash = state_hash;
+  }
+
+  /*!
+   * Record the written bytes on each write to the RAM
+   * @param write_tracker may be null to stop the updates
+   */
+  void trackRamWrites(RamWriteTracker* write_tracker) {
+    m_write_tracker = write_tracker;
+  }
+
+ private:
+  void writeRam(std::size_t address, uint8_t value);
+
  private:
   ProgramCounter& m_pc;
   StackPointer& m_stack_ptr;
@@ -160,11 +161,14 @@ class ControlUnitImpl : public ControlUnit {
   DelayTimerRegister& m_delay_timer_reg;
   SoundTimerRegister& m_sound_timer_reg;
   Stack& m_stack;
-  std::vector<GeneralRegister>& m_registers;
+  GeneralRegisters& m_registers;
   RAM& m_ram;
   DisplayController& m_display_ctrler;
   UserInputController& m_ui_ctrler;
-  UniformRandomNumberGenerator m_rand_num_generator;
+  RandomState& m_random_state;
+  RandomPolicy m_random_policy;
+  IncrementalStateHash* m_state_hash;
+  RamWriteTracker* m_write_tracker;
 };
 
 }  // namespace chip8
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_DEBUG_POLICY_H_
+#define MODULES_INTERPRETER_DEBUG_POLICY_H_
+
+// std
+#include <bitset>
+#include <cstdint>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+/*!
+ * Reason why a debug policy stopped the execution
+ */
+enum class DebugEvent {
+  NONE,
+  BREAKPOINT,         ///< the PC is on a breakpoint
+  OPCODE_BREAKPOINT,  ///< the instruction belongs to a watched class
+  READ_WATCHPOINT,    ///< the instruction reads a watched RAM address
+  WRITE_WATCHPOINT    ///< the instruction writes a watched RAM address
+};
+
+/*!
+ * @struct NoDebugPolicy
+ * Policy of a plain run: Emulator::step(policy) compiles to Emulator::step()
+ */
+struct NoDebugPolicy {
+  static constexpr bool ENABLED = false;
+
+  bool check(const MachineState&, uint16_t) { return false; }
+};
+
+/*!
+ * @class BreakpointPolicy
+ * Stop before an instruction on a PC breakpoint, an opcode class breakpoint
+ * (e.g. every Dxyn) or accessing a watched RAM address. Each check is a test
+ * in a bitmap: one for the PC, one for the class and one per byte accessed.
+ *
+ * The RAM accesses are known before execution from the opcode and the index
+ * register: Dxyn reads I..I+n-1, Fx65 reads I..I+x, Fx33 writes I..I+2 and
+ * Fx55 writes I..I+x, addresses wrapping around the RAM.
+ */
+class BreakpointPolicy {
+ public:
+  static constexpr bool ENABLED = true;
+
+  BreakpointPolicy();
+
+  // Addresses wrap around the RAM like the accesses of the program
+  void addBreakpoint(uint16_t address) {
+    m_breakpoints.set(wrapAddress(address));
+  }
+  void removeBreakpoint(uint16_t address) {
+    m_breakpoints.reset(wrapAddress(address));
+  }
+
+  /*!
+   * @param prefix most significant nibble of the opcodes, e.g. 0xD for Dxyn
+   */
+  void addOpcodeBreakpoint(uint8_t prefix) {
+    m_opcode_breakpoints |= 1u << (prefix & 0xF);
+  }
+  void removeOpcodeBreakpoint(uint8_t prefix) {
+    m_opcode_breakpoints &= ~(1u << (prefix & 0xF));
+  }
+
+  void addReadWatchpoint(uint16_t address) {
+    m_read_watchpoints.set(wrapAddress(address));
+  }
+  void removeReadWatchpoint(uint16_t address) {
+    m_read_watchpoints.reset(wrapAddress(address));
+  }
+
+  void addWriteWatchpoint(uint16_t address) {
+    m_write_watchpoints.set(wrapAddress(address));
+  }
+  void removeWriteWatchpoint(uint16_t address) {
+    m_write_watchpoints.reset(wrapAddress(address));
+  }
+
+  /*!
+   * @param state machine about to execute the instruction
+   * @param opcode instruction at the PC
+   * @return true if the execution has to stop before the instruction
+   */
+  bool check(const MachineState& state, uint16_t opcode);
+
+  /*!
+   * @return reason of the last stop
+   */
+  DebugEvent getEvent() const { return m_event; }
+
+  /*!
+   * @return PC of a breakpoint or RAM address of a watchpoint of the last stop
+   */
+  uint16_t getEventAddress() const { return m_event_address; }
+
+ private:
+  bool checkRange(const std::bitset<RAM::size()>& watchpoints,
+                  std::size_t address, std::size_t size, DebugEvent event);
+
+ private:
+  std::bitset<RAM::size()> m_breakpoints;
+  std::bitset<RAM::size()> m_read_watchpoints;
+  std::bitset<RAM::size()> m_write_watchpoints;
+  uint16_t m_opcode_breakpoints;
+  DebugEvent m_event;
+  uint16_t m_event_address;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_DEBUG_POLICY_H_
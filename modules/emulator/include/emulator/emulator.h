@@ -27,31 +27,60 @@
 #define MODULES_INTERPRETER_EMULATOR_H_
 
 // std
+#include <functional>
 #include <istream>
 #include <memory>
-#include <vector>
+#include <string>
 
-#include "memory.h"
+#include "debug_policy.h"
+#include "machine_state.h"
+#include "ram_write_tracker.h"
+#include "rom_loader.h"
+#include "state_hash.h"
+#include "units.h"
 
 namespace chip8 {
 
+class DisplayModel;
 class DisplayController;
 class UserInputController;
-class ControlUnit;
+class ControlUnitImpl;
 class InstructionDecoder;
 class Clock;
+class SnapshotPublisher;
+class InputEventQueue;
+
+extern const std::size_t CYCLES_PER_FRAME;
 
 class Emulator {
  public:
   /*!
+   * Create an emulator owning its machine state
    * @param rom input program to be loaded
-   * @param display_controller display controller to be used
-   * @param user input controller
-   * @param ui_controller
+   * @param ui_controller user input controller
+   * @throw std::runtime_error if the program cannot be loaded
    */
-  Emulator(std::istream& rom,
-           std::unique_ptr<DisplayController> display_controller,
-           UserInputController* ui_controller);
+  Emulator(std::istream& rom, UserInputController* ui_controller);
+
+  /*!
+   * Create an emulator owning its machine state, the program is mapped from
+   * the file, see loadProgramFromFile()
+   * @param rom_path path of the program to be loaded
+   * @param ui_controller user input controller
+   * @throw std::runtime_error if the program cannot be loaded
+   */
+  Emulator(const std::string& rom_path, UserInputController* ui_controller);
+
+  /*!
+   * Create an emulator whose machine state lives in storage provided by the
+   * caller (e.g. a slot of an InstanceArena). The state is reset.
+   * @param rom input program to be loaded
+   * @param ui_controller user input controller
+   * @param state storage of the machine state, needs to outlive the emulator
+   * @throw std::runtime_error if the program cannot be loaded
+   */
+  Emulator(std::istream& rom, UserInputController* ui_controller,
+           MachineState& state);
 
   virtual ~Emulator();
 
@@ -60,26 +89,174 @@ class Emulator {
    */
   void update();
 
+  /*!
+   * Fetch, decode and execute a single instruction without waiting for the
+   * clock. Used to drive the emulator headless.
+   */
+  void step();
+
+  /*!
+   * Execute a single instruction unless a debug policy stops before it. The
+   * checks are only compiled in for enabled policies, e.g. BreakpointPolicy.
+   * To resume after a stop, the instruction is executed with step().
+   * @param policy
+   * @return false if the policy stopped the execution
+   */
+  template <typename DebugPolicy>
+  bool step(DebugPolicy& policy) {
+    if constexpr (DebugPolicy::ENABLED) {
+      if (policy.check(*m_state, fetchInstruction())) {
+        return false;
+      }
+    }
+
+    step();
+    return true;
+  }
+
+  /*!
+   * Execute the instructions of a whole 60 Hz frame then update the timers
+   */
+  void runFrame();
+
+  /*!
+   * Update the delay and sound timers, should be called once per 60 Hz frame
+   * when the emulator is driven with step()
+   */
+  void updateTimers();
+
+  /*!
+   * @return true if the last executed instruction was a Fx0A that found no key
+   * pressed. Executing again will poll the inputs again.
+   */
+  bool isWaitingForKey() const { return m_waiting_for_key; }
+
+  /*!
+   * @return model of the display, to be rendered by a view
+   */
+  const DisplayModel& getDisplayModel() const { return *m_display_model; }
+
+  /*!
+   * The RAM and display must not be written through the returned reference,
+   * use restoreState() instead so that the state hash stays up to date
+   */
+  MachineState& getState() { return *m_state; }
+  const MachineState& getState() const { return *m_state; }
+
+  /*!
+   * Hash of the whole machine state in constant time: the hash of the RAM and
+   * display is updated on each write. Debug builds check it against a full
+   * rehash.
+   * @return hash of the state, equal for equal states
+   */
+  uint64_t stateHash() const;
+
+  /*!
+   * Reset the machine and load a new version of its program, the input
+   * controller, observers and seed are kept. The machine is untouched if the
+   * program cannot be loaded.
+   * @param rom_path path of the program to be loaded
+   * @throw std::runtime_error if the program cannot be loaded
+   */
+  void reload(const std::string& rom_path);
+
+  /*!
+   * Replace the machine state, e.g. to go back to a snapshot
+   * @param state state to copy
+   */
+  void restoreState(const MachineState& state);
+
+  /*!
+   * Replace the machine state without rehashing its RAM and display. The state
+   * may be the one the emulator runs on, once it has been written in place
+   * @param state state to copy
+   * @param memory_hash value of getMemoryHash() when the state was captured
+   */
+  void restoreState(const MachineState& state, uint64_t memory_hash);
+
+  /*!
+   * @return hash of the RAM and display, kept with a snapshot to restore it
+   * in constant time
+   */
+  uint64_t getMemoryHash() const { return m_state_hash.getValue(); }
+
+  /*!
+   * Bytes of the RAM written by the program. Restoring a state marks the whole
+   * RAM as written.
+   */
+  RamWriteTracker& getRamWriteTracker() { return m_ram_writes; }
+  const RamWriteTracker& getRamWriteTracker() const { return m_ram_writes; }
+
+  /*!
+   * Publish a snapshot of the machine at the end of each frame, for observers
+   * running on other threads
+   * @param publisher may be null to stop publishing
+   */
+  void setSnapshotPublisher(SnapshotPublisher* publisher) {
+    m_publisher = publisher;
+  }
+
+  /*!
+   * @return number of frames run, i.e. of timer updates
+   */
+  uint64_t countFrames() const { return m_n_frames; }
+
+  /*!
+   * Start or end a speculative run, whose frames are discarded by restoring
+   * the state afterwards, e.g. to run ahead. Its frames are not published and
+   * the frame and cycle counts are restored when it ends.
+   * @param speculative
+   */
+  void setSpeculative(bool speculative);
+
+  /*!
+   * Apply the events of the queue at the cycle they are due before executing
+   * each instruction. The queue should be the input controller of the
+   * emulator, possibly through another controller forwarding to it.
+   * @param queue may be null to stop applying events
+   */
+  void setInputEventQueue(InputEventQueue* queue) { m_input_events = queue; }
+
+  /*!
+   * @return number of instructions executed, i.e. the current cycle
+   */
+  uint64_t countCycles() const { return m_n_cycles; }
+
+  /*!
+   * Seed the random number generator used by the program (RND instruction)
+   * @param seed
+   */
+  void seed(uint64_t seed);
+
  private:
+  void initialize(
+      const std::function<RomLoadResult(RAM&)>& load_program);
   void clockCycle();
-  void decrementDelayTimer();
+  void decrementTimers();
+  instruction_t fetchInstruction();
 
  private:
   // Memory components
-  ProgramCounter m_pc;
-  StackPointer m_stack_ptr;
-  IndexRegister m_index_reg;
-  DelayTimerRegister m_delay_timer_reg;
-  SoundTimerRegister m_sound_timer_reg;
-  Stack m_stack;
-  std::vector<GeneralRegister> m_registers;
-  RAM m_ram;
+  std::unique_ptr<MachineState> m_owned_state;
+  MachineState* m_state;
+  IncrementalStateHash m_state_hash;
+  RamWriteTracker m_ram_writes;
+  bool m_waiting_for_key;
+  uint64_t m_n_frames;
+  uint64_t m_n_cycles;
+  bool m_speculative;
+  uint64_t m_speculation_n_frames;
+  uint64_t m_speculation_n_cycles;
+  uint64_t m_seed;
+  SnapshotPublisher* m_publisher;
+  InputEventQueue* m_input_events;
 
   // Controllers
   UserInputController* m_ui_controller;
   std::unique_ptr<Clock> m_clock;
+  std::unique_ptr<DisplayModel> m_display_model;
   std::unique_ptr<DisplayController> m_display_controller;
-  std::unique_ptr<ControlUnit> m_ctrl_unit;
+  std::unique_ptr<ControlUnitImpl> m_ctrl_unit;
   std::unique_ptr<InstructionDecoder> m_instruction_decoder;
 };
 
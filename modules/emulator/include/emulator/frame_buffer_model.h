@@ -0,0 +1,82 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_DISPLAY_FRAME_BUFFER_MODEL_H_
+#define MODULES_DISPLAY_FRAME_BUFFER_MODEL_H_
+
+#include "emulator/display_model.h"
+#include "emulator/machine_state.h"
+#include "emulator/state_hash.h"
+
+namespace chip8 {
+
+/*!
+ * Display model storing its pixels in a frame buffer owned by someone else,
+ * typically the machine state of an emulator
+ */
+class FrameBufferModel : public DisplayModel {
+ public:
+  /*!
+   * @param pixels
+   * @param state_hash hash updated on each write, may be null
+   */
+  explicit FrameBufferModel(FrameBuffer& pixels,
+                            IncrementalStateHash* state_hash = nullptr)
+      : m_pixels(pixels), m_state_hash(state_hash) {}
+
+  void setPixelValue(column_t col, row_t row, uint8_t value) override {
+    uint8_t& pixel = m_pixels[row * DISPLAY_WIDTH + col];
+    if (m_state_hash) {
+      m_state_hash->updatePixel(row * DISPLAY_WIDTH + col, pixel, value);
+    }
+    pixel = value;
+  }
+
+  uint8_t getPixelValue(column_t col, row_t row) const override {
+    return m_pixels[row * DISPLAY_WIDTH + col];
+  }
+
+  void clear() override {
+    if (m_state_hash) {
+      for (std::size_t i = 0; i < m_pixels.size(); ++i) {
+        if (m_pixels[i] != 0) {
+          m_state_hash->updatePixel(i, m_pixels[i], 0);
+        }
+      }
+    }
+    m_pixels.fill(0);
+  }
+
+  std::size_t getWidth() const override { return DISPLAY_WIDTH; }
+
+  std::size_t getHeight() const override { return DISPLAY_HEIGHT; }
+
+ private:
+  FrameBuffer& m_pixels;
+  IncrementalStateHash* m_state_hash;
+};
+
+}  // namespace chip8
+#endif  // MODULES_DISPLAY_FRAME_BUFFER_MODEL_H_
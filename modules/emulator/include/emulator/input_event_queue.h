@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_INPUT_EVENT_QUEUE_H_
+#define MODULES_INTERPRETER_INPUT_EVENT_QUEUE_H_
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "user_input.h"
+
+namespace chip8 {
+
+/*!
+ * Press or release of a key at an emulated cycle
+ */
+struct InputEvent {
+  uint64_t cycle;
+  InputId input_id;
+  InputState state;
+
+  bool operator==(const InputEvent& other) const {
+    return cycle == other.cycle && input_id == other.input_id &&
+           state == other.state;
+  }
+};
+
+/*!
+ * @class InputEventQueue
+ * Input controller applying key events at the emulated cycle they are due,
+ * see Emulator::setInputEventQueue(). The keys read by the program then do
+ * not depend on when the host runs the emulator and a run is replayed
+ * exactly from the log of its events.
+ *
+ * Host events are timestamped and buffered until sync() is called before a
+ * batch of cycles is run. They are mapped to the cycles of the batch with the
+ * spacing they had since the previous sync, i.e. the input is delayed by one
+ * batch but without jitter.
+ */
+class InputEventQueue : public UserInputController {
+ public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  /*!
+   * @param cycles_per_second emulated frequency used to map host time
+   */
+  explicit InputEventQueue(double cycles_per_second);
+
+  std::optional<InputState> getInputState(InputId input_id) override;
+
+  /*!
+   * Queue an event at an emulated cycle. Events cannot be applied before the
+   * current cycle nor before the events already queued, they are delayed.
+   * @param event
+   */
+  void push(InputEvent event);
+
+  /*!
+   * Buffer a host event until the next sync
+   * @param input_id
+   * @param state
+   * @param timestamp time at which the event occurred on the host
+   */
+  void pushHostEvent(InputId input_id, InputState state, time_point timestamp);
+
+  /*!
+   * Queue the host events that occurred before now
+   * @param now current time of the host
+   * @param cycle cycle at which the next batch starts
+   */
+  void sync(time_point now, uint64_t cycle);
+
+  /*!
+   * Apply the events due at or before the cycle
+   * @param cycle cycle about to be executed
+   */
+  void advanceTo(uint64_t cycle);
+
+  /*!
+   * @return bitmask of the pressed keys, bit i being the state of key i
+   */
+  uint16_t getKeys() const { return m_keys; }
+
+  std::size_t countPending() const { return m_pending.size(); }
+
+  /*!
+   * @return events applied so far, in order, to replay the run
+   */
+  const std::vector<InputEvent>& getLog() const { return m_log; }
+
+ private:
+  struct HostEvent {
+    InputId input_id;
+    InputState state;
+    time_point timestamp;
+  };
+
+  double m_cycles_per_second;
+  uint16_t m_keys;
+  uint64_t m_cycle;
+  uint64_t m_last_queued_cycle;
+  std::optional<time_point> m_last_sync;
+  std::vector<HostEvent> m_host_events;
+  std::deque<InputEvent> m_pending;
+  std::vector<InputEvent> m_log;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_INPUT_EVENT_QUEUE_H_
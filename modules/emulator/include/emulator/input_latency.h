@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_INPUT_LATENCY_H_
+#define MODULES_INTERPRETER_INPUT_LATENCY_H_
+
+// std
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "display_model.h"
+#include "user_input.h"
+
+namespace chip8 {
+
+/*!
+ * @class LatencyHistogram
+ * Histogram of durations with logarithmic buckets, bucket i counts the
+ * durations in [2^i, 2^(i+1)) microseconds, the first one also counts the
+ * shorter ones and the last one the longer ones.
+ */
+class LatencyHistogram {
+ public:
+  static const std::size_t N_BUCKETS = 24;
+
+  LatencyHistogram();
+
+  void record(std::chrono::nanoseconds latency);
+
+  void reset();
+
+  uint64_t countSamples() const { return m_n_samples; }
+
+  uint64_t getBucket(std::size_t bucket) const { return m_buckets[bucket]; }
+
+  /*!
+   * @return lower bound of the durations counted in the bucket
+   */
+  static std::chrono::microseconds getBucketLowerBound(std::size_t bucket);
+
+  /*!
+   * @param quantile in [0, 1], e.g. 0.99 for the 99th percentile
+   * @return upper bound of the bucket holding the quantile, 0 without samples
+   */
+  std::chrono::microseconds getPercentile(double quantile) const;
+
+  std::chrono::nanoseconds getMean() const;
+
+  std::chrono::nanoseconds getMax() const { return m_max; }
+
+  /*!
+   * Write the count of samples, mean, percentiles and non empty buckets
+   */
+  void print(std::ostream& stream) const;
+
+ private:
+  std::array<uint64_t, N_BUCKETS> m_buckets;
+  uint64_t m_n_samples;
+  std::chrono::nanoseconds m_sum;
+  std::chrono::nanoseconds m_max;
+};
+
+/*!
+ * @class InputLatencyTracker
+ * Measure the latency from a key event to the guest and to the screen. The
+ * tracker is the input controller of the emulator and forwards to the actual
+ * one, the front end reports the key events with their timestamp and the
+ * frames it presents.
+ *
+ * A key event is observed the first time the guest reads the key in the
+ * state of the event, it is displayed by the first changed frame presented
+ * after that. The observe latency covers the event loop and the frame
+ * cadence, the difference between both histograms is the rendering.
+ */
+class InputLatencyTracker : public UserInputController {
+ public:
+  using time_point = std::chrono::steady_clock::time_point;
+
+  /*!
+   * @param input controller read by the guest
+   * @param get_current_time_cb function returning the current time
+   */
+  InputLatencyTracker(UserInputController& input,
+                      std::function<time_point()> get_current_time_cb);
+
+  std::optional<InputState> getInputState(InputId input_id) override;
+
+  /*!
+   * Start tracking a key event. An event of the same key not yet observed is
+   * dropped.
+   * @param input_id key of the event
+   * @param state state of the key after the event
+   * @param timestamp time at which the event occurred
+   */
+  void keyEvent(InputId input_id, InputState state, time_point timestamp);
+
+  /*!
+   * Report a presented frame
+   * @param display display that was presented
+   * @param timestamp time at which it was presented
+   */
+  void framePresented(const DisplayModel& display, time_point timestamp);
+
+  const LatencyHistogram& getObserveLatency() const { return m_observe; }
+  const LatencyHistogram& getPresentLatency() const { return m_present; }
+
+  /*!
+   * @return number of key events dropped before the guest observed them
+   */
+  uint64_t countDroppedEvents() const { return m_n_dropped; }
+
+ private:
+  struct PendingEvent {
+    bool active;
+    InputState state;
+    time_point timestamp;
+  };
+
+  UserInputController& m_input;
+  std::function<time_point()> m_get_current_time;
+  std::array<PendingEvent, static_cast<std::size_t>(InputId::INPUT_SIZE)>
+      m_pending;
+  std::vector<time_point> m_observed;
+  std::vector<uint8_t> m_last_frame;
+  LatencyHistogram m_observe;
+  LatencyHistogram m_present;
+  uint64_t m_n_dropped;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_INPUT_LATENCY_H_
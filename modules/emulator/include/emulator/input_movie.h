@@ -0,0 +1,148 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_INPUT_MOVIE_H_
+#define MODULES_INTERPRETER_INPUT_MOVIE_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <optional>
+#include <vector>
+
+#include "input_event_queue.h"
+#include "user_input.h"
+
+namespace chip8 {
+
+extern const uint32_t INPUT_MOVIE_MAGIC;
+extern const uint16_t INPUT_MOVIE_VERSION;
+extern const uint32_t INPUT_EVENTS_MAGIC;
+extern const std::size_t MAX_INPUT_MOVIE_FRAMES;
+
+/*!
+ * @class InputMovie
+ * Sequence of inputs to replay, one 16 keys bitmask per 60 Hz frame, and the
+ * seed of the random number generator of the recorded run
+ */
+class InputMovie {
+ public:
+  InputMovie() : m_seed(0) {}
+  explicit InputMovie(std::vector<uint16_t> frames, uint32_t seed = 0);
+
+  /*!
+   * Add the inputs of the next frame
+   * @param keys bitmask of the pressed keys
+   */
+  void append(uint16_t keys);
+
+  /*!
+   * @param frame index of the frame
+   * @return bitmask of the keys pressed during the frame, no key is pressed
+   * after the end of the movie
+   */
+  uint16_t getKeys(std::size_t frame) const;
+
+  std::size_t size() const { return m_frames.size(); }
+
+  uint32_t getSeed() const { return m_seed; }
+
+  void setSeed(uint32_t seed) { m_seed = seed; }
+
+  /*!
+   * Write the movie as a header (magic, version, seed, number of runs) then
+   * runs of identical frames (little endian 32 bits length, 16 bits mask)
+   * @param output_stream
+   */
+  void save(std::ostream& output_stream) const;
+
+  /*!
+   * Replace the movie by the one stored in the stream
+   * @param input_stream
+   * @return true if the movie was successfully read, false if it is
+   * corrupted or longer than MAX_INPUT_MOVIE_FRAMES
+   */
+  bool load(std::istream& input_stream);
+
+ private:
+  std::vector<uint16_t> m_frames;
+  uint32_t m_seed;
+};
+
+/*!
+ * @class InputMoviePlayer
+ * Replay driver: the keys pressed are the ones recorded in the movie for the
+ * current frame. Call nextFrame() after each emulated frame.
+ */
+class InputMoviePlayer : public UserInputController {
+ public:
+  explicit InputMoviePlayer(const InputMovie& movie)
+      : m_movie(movie), m_frame(0) {}
+
+  std::optional<InputState> getInputState(InputId input_id) override;
+
+  void nextFrame() { ++m_frame; }
+
+  std::size_t getFrame() const { return m_frame; }
+
+  bool isFinished() const { return m_frame >= m_movie.size(); }
+
+ private:
+  const InputMovie& m_movie;
+  std::size_t m_frame;
+};
+
+/*!
+ * Read the state of the 16 keys of a controller, used to record a movie
+ * @param ui_controller
+ * @return bitmask of the pressed keys, bit i being the state of key i
+ */
+uint16_t readKeys(UserInputController& ui_controller);
+
+/*!
+ * Write a log of input events, e.g. InputEventQueue::getLog(), to replay a run
+ * at the cycle. The header (magic, version, seed, number of events) is
+ * followed by the events (little endian 64 bits cycle, 8 bits key, 8 bits
+ * state).
+ * @param output_stream
+ * @param events events in the order of their cycles
+ * @param seed seed of the random number generator of the run
+ */
+void saveInputEvents(std::ostream& output_stream,
+                     const std::vector<InputEvent>& events, uint32_t seed);
+
+/*!
+ * @param input_stream
+ * @param events replaced by the events stored in the stream
+ * @param seed replaced by the seed stored in the stream
+ * @return true if the log was successfully read
+ */
+bool loadInputEvents(std::istream& input_stream,
+                     std::vector<InputEvent>& events, uint32_t& seed);
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_INPUT_MOVIE_H_
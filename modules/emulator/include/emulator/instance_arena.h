@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_INSTANCE_ARENA_H_
+#define MODULES_INTERPRETER_INSTANCE_ARENA_H_
+
+// std
+#include <cstddef>
+#include <vector>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+static const std::size_t CACHE_LINE_SIZE = 64;
+static const std::size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/*!
+ * @class InstanceArena
+ * Preallocated storage for the machine states of many emulators. The states
+ * are packed in 2 MiB huge pages to limit TLB misses. If no huge page can be
+ * reserved, the arena falls back to regular pages and asks the kernel for
+ * transparent huge pages. Each state starts on its own cache line so that
+ * instances driven by different threads never share one.
+ */
+class InstanceArena {
+ public:
+  /*!
+   * Reserve the memory for capacity machine states
+   * @param capacity maximal number of states stored in the arena
+   * @throw std::bad_alloc if the memory cannot be mapped
+   */
+  explicit InstanceArena(std::size_t capacity);
+  ~InstanceArena();
+
+  InstanceArena(const InstanceArena&) = delete;
+  InstanceArena& operator=(const InstanceArena&) = delete;
+
+  /*!
+   * @return a zero initialized machine state or nullptr if the arena is full
+   */
+  MachineState* allocate();
+
+  /*!
+   * Give back a state obtained with allocate()
+   * @param state
+   */
+  void release(MachineState* state);
+
+  std::size_t capacity() const { return m_capacity; }
+  std::size_t size() const { return m_capacity - m_free_slots.size(); }
+
+  /*!
+   * @return distance in bytes between two consecutive states
+   */
+  std::size_t stride() const { return m_stride; }
+
+  /*!
+   * @return true if the states are backed by explicitly reserved huge pages
+   */
+  bool usesHugePages() const { return m_huge_pages; }
+
+ private:
+  std::size_t m_capacity;
+  std::size_t m_stride;
+  std::size_t m_mapping_size;
+  void* m_mapping;
+  unsigned char* m_slots;
+  bool m_huge_pages;
+  std::vector<std::size_t> m_free_slots;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_INSTANCE_ARENA_H_
@@ -0,0 +1,114 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_LITTLE_ENDIAN_H_
+#define MODULES_INTERPRETER_LITTLE_ENDIAN_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+namespace chip8 {
+
+/*!
+ * Write an integer in little endian, whatever the byte order of the host. The
+ * binary files of the project (movies, indexes, WAV...) are written with it.
+ * @param output_stream
+ * @param value
+ */
+template <typename T>
+void writeValue(std::ostream& output_stream, T value) {
+  static_assert(std::is_integral<T>::value, "only integers are written");
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    output_stream.put(static_cast<char>(value >> (8 * i)));
+  }
+}
+
+/*!
+ * Read an integer written by writeValue()
+ * @param input_stream
+ * @param value replaced by the value read
+ * @return false if the stream ended before the value
+ */
+template <typename T>
+bool readValue(std::istream& input_stream, T& value) {
+  static_assert(std::is_integral<T>::value, "only integers are read");
+  char bytes[sizeof(T)];
+  if (!input_stream.read(bytes, sizeof(T))) {
+    return false;
+  }
+
+  value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+  }
+  return true;
+}
+
+/*!
+ * Write an integer in little endian to a buffer, e.g. a network packet
+ * @param bytes receives sizeof(T) bytes
+ * @param value
+ */
+template <typename T>
+void writeValue(uint8_t* bytes, T value) {
+  static_assert(std::is_integral<T>::value, "only integers are written");
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    bytes[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+/*!
+ * Append an integer in little endian to a growing buffer
+ * @param buffer
+ * @param value
+ */
+template <typename T>
+void appendValue(std::vector<uint8_t>& buffer, T value) {
+  buffer.resize(buffer.size() + sizeof(T));
+  writeValue(buffer.data() + buffer.size() - sizeof(T), value);
+}
+
+/*!
+ * Read an integer written to a buffer by writeValue() or appendValue()
+ * @param bytes holds at least sizeof(T) bytes
+ * @return value read
+ */
+template <typename T>
+T readValue(const uint8_t* bytes) {
+  static_assert(std::is_integral<T>::value, "only integers are read");
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(static_cast<T>(bytes[i]) << (8 * i));
+  }
+  return value;
+}
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_LITTLE_ENDIAN_H_
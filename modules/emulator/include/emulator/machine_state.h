@@ -0,0 +1,70 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_MACHINE_STATE_H_
+#define MODULES_INTERPRETER_MACHINE_STATE_H_
+
+// std
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+#include "memory.h"
+#include "random.h"
+
+namespace chip8 {
+
+static const std::size_t DISPLAY_WIDTH = 64;
+static const std::size_t DISPLAY_HEIGHT = 32;
+
+/*!
+ * Pixels of the display stored row by row, one byte per pixel
+ */
+using FrameBuffer = std::array<uint8_t, DISPLAY_WIDTH * DISPLAY_HEIGHT>;
+
+/*!
+ * @struct MachineState
+ * Whole state of a Chip-8 machine stored contiguously. It is trivially
+ * copyable so it can be copied, snapshotted or placed in preallocated storage
+ * with a plain memcpy.
+ */
+struct MachineState {
+  ProgramCounter pc;
+  StackPointer stack_ptr;
+  IndexRegister index_reg;
+  DelayTimerRegister delay_timer_reg;
+  SoundTimerRegister sound_timer_reg;
+  GeneralRegisters registers;
+  Stack stack;
+  RAM ram;
+  FrameBuffer framebuffer{};
+  RandomState random_state{};
+};
+
+static_assert(std::is_trivially_copyable<MachineState>::value,
+              "MachineState needs to be copyable with memcpy");
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_MACHINE_STATE_H_
@@ -27,10 +27,10 @@
 
 // std
 #include <array>
+#include <cassert>
 #include <ostream>
 #include <string>
 #include <type_traits>
-#include <vector>
 
 #include "boost/serialization/strong_typedef.hpp"
 
@@ -58,20 +58,32 @@ extern const std::size_t F_SPRITE_OFFSET;
 template <typename MemoryUnit, std::size_t MemorySize>
 class GenericMemory {
  public:
-  GenericMemory() : m_container(MemorySize, 0) {}
-  virtual ~GenericMemory() = default;
+  GenericMemory() : m_container{} {}
 
-  typedef typename std::vector<MemoryUnit>::iterator iterator;
-  typedef typename std::vector<MemoryUnit>::const_iterator const_iterator;
+  typedef typename std::array<MemoryUnit, MemorySize>::iterator iterator;
+  typedef typename std::array<MemoryUnit, MemorySize>::const_iterator
+      const_iterator;
   iterator begin() { return m_container.begin(); }
   [[nodiscard]] const_iterator begin() const { return m_container.begin(); }
   iterator end() { return m_container.end(); }
   [[nodiscard]] const_iterator end() const { return m_container.end(); }
 
-  MemoryUnit& operator[](size_t index) { return m_container[index]; }
+  MemoryUnit& operator[](size_t index) {
+    assert(index < MemorySize);
+    return m_container[index];
+  }
+  const MemoryUnit& operator[](size_t index) const {
+    assert(index < MemorySize);
+    return m_container[index];
+  }
+
+  MemoryUnit* data() { return m_container.data(); }
+  [[nodiscard]] const MemoryUnit* data() const { return m_container.data(); }
+
+  static constexpr std::size_t size() { return MemorySize; }
 
  private:
-  std::vector<MemoryUnit> m_container;
+  std::array<MemoryUnit, MemorySize> m_container;
 };
 
 using RAM = GenericMemory<uint8_t, 4096>;
@@ -79,16 +91,32 @@ using Stack = GenericMemory<uint16_t, 16>;
 
 std::ostream& operator<<(std::ostream& os, const RAM& ram);
 
+/*!
+ * Addresses are 12 bits wide: the interpreter wraps any address computed from
+ * the registers (I + n, PC + 1, ...) into the RAM rather than reading past it
+ * @param address address to wrap
+ * @return address within the RAM
+ */
+inline std::size_t wrapAddress(std::size_t address) {
+  return address % RAM::size();
+}
+
+/*!
+ * The stack pointer wraps the same way when a program overflows the stack
+ * @param stack_ptr stack pointer to wrap
+ * @return index within the stack
+ */
+inline std::size_t wrapStackIndex(std::size_t stack_ptr) {
+  return stack_ptr % Stack::size();
+}
+
 template <typename MemoryType>
 class Register {
  public:
   Register() : m_value(MemoryType()) {}
   explicit Register(MemoryType value) : m_value(value) {}
-  Register(const Register& register_) : m_value(register_.m_value) {}
-  Register& operator=(const Register& rhs) {
-    m_value = rhs.m_value;
-    return *this;
-  }
+  Register(const Register& register_) = default;
+  Register& operator=(const Register& rhs) = default;
   Register& operator=(const MemoryType& rhs) {
     m_value = rhs;
     return *this;
@@ -108,6 +136,7 @@ using ProgramCounter = Register<uint16_t>;
 using StackPointer = Register<uint8_t>;
 using DelayTimerRegister = Register<uint8_t>;
 using SoundTimerRegister = Register<uint8_t>;
+using GeneralRegisters = GenericMemory<GeneralRegister, 16>;
 
 void storeSpriteInMemory(RAM& ram);
 
@@ -0,0 +1,141 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_RAM_WRITE_TRACKER_H_
+#define MODULES_INTERPRETER_RAM_WRITE_TRACKER_H_
+
+// std
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "memory.h"
+
+namespace chip8 {
+
+/*!
+ * @class RamWriteTracker
+ * Records which bytes of the RAM have been written. The writes since the last
+ * checkpoint are kept in a 4096 bits bitmap, one 64 bits word per page of 64
+ * bytes, so that recording a write is a single OR and a page is dirty when its
+ * word is not zero.
+ *
+ * A checkpoint closes the current epoch: the bytes written during it are
+ * stamped with the epoch, which answers "written since epoch" queries for any
+ * earlier checkpoint, e.g. to invalidate decoded instructions or to build a
+ * delta snapshot.
+ */
+class RamWriteTracker {
+ public:
+  using epoch_t = uint32_t;
+
+  static constexpr std::size_t PAGE_SIZE = 64;
+  static constexpr std::size_t N_PAGES = RAM::size() / PAGE_SIZE;
+
+  RamWriteTracker();
+
+  /*!
+   * @param address address of the written byte, within the RAM
+   */
+  void markWritten(std::size_t address) {
+    assert(address < RAM::size());
+    m_dirty[address / PAGE_SIZE] |= uint64_t(1) << (address % PAGE_SIZE);
+  }
+
+  /*!
+   * Mark the whole RAM as written, e.g. when the state is replaced
+   */
+  void markAll();
+
+  /*!
+   * Close the current epoch and start a new one
+   * @return epoch to query the writes made from now on
+   */
+  epoch_t checkpoint();
+
+  epoch_t getEpoch() const { return m_epoch; }
+
+  /*!
+   * Forget every write and go back to the first epoch
+   */
+  void reset();
+
+  /*!
+   * @param address
+   * @return true if the byte was written since the last checkpoint
+   */
+  bool isDirty(std::size_t address) const {
+    return (m_dirty[address / PAGE_SIZE] >> (address % PAGE_SIZE)) & 0x1;
+  }
+
+  /*!
+   * @return mask of the pages written since the last checkpoint, bit i stands
+   * for the bytes [i * PAGE_SIZE, (i + 1) * PAGE_SIZE)
+   */
+  uint64_t getDirtyPages() const;
+
+  /*!
+   * @param page
+   * @return bitmap of the bytes of the page written since the last checkpoint
+   */
+  uint64_t getDirtyBytes(std::size_t page) const { return m_dirty[page]; }
+
+  /*!
+   * @param epoch value returned by checkpoint()
+   * @param address
+   * @return true if the byte was written since the checkpoint
+   */
+  bool isDirtySince(epoch_t epoch, std::size_t address) const {
+    return m_byte_stamps[address] > epoch || isDirty(address);
+  }
+
+  /*!
+   * @param epoch value returned by checkpoint()
+   * @return mask of the pages written since the checkpoint
+   */
+  uint64_t getDirtyPagesSince(epoch_t epoch) const;
+
+  /*!
+   * @param epoch value returned by checkpoint()
+   * @param address first byte of the range
+   * @param size number of bytes, the range wraps around the RAM
+   * @return true if any byte of the range was written since the checkpoint
+   */
+  bool isRangeDirtySince(epoch_t epoch, std::size_t address,
+                         std::size_t size) const;
+
+ private:
+  // Writes since the last checkpoint, one word per page
+  std::array<uint64_t, N_PAGES> m_dirty;
+  // Last epoch during which each byte and page was written plus one, zero if
+  // never written
+  std::array<epoch_t, RAM::size()> m_byte_stamps;
+  std::array<epoch_t, N_PAGES> m_page_stamps;
+  epoch_t m_epoch;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_RAM_WRITE_TRACKER_H_
@@ -0,0 +1,163 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_RANDOM_H_
+#define MODULES_INTERPRETER_RANDOM_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace chip8 {
+
+/*!
+ * @struct RandomState
+ * 16 bytes state of a random number generator. It is part of the machine state
+ * so that it is saved, restored and cloned with the rest of the machine.
+ */
+struct RandomState {
+  uint64_t state;
+  uint64_t increment;
+};
+
+/*!
+ * @class Pcg32
+ * PCG-XSH-RR generator with 64 bits state and selectable stream. The state of
+ * a zero initialized RandomState is valid.
+ */
+class Pcg32 {
+ public:
+  static void seed(RandomState& random_state, uint64_t seed) {
+    random_state.state = 0;
+    random_state.increment = (seed << 1) | 1;
+    next(random_state);
+    random_state.state += seed;
+    next(random_state);
+  }
+
+  static uint32_t next(RandomState& random_state) {
+    uint64_t old_state = random_state.state;
+    random_state.state =
+        old_state * MULTIPLIER + (random_state.increment | 1);
+    auto xorshifted =
+        static_cast<uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+    auto rotation = static_cast<uint32_t>(old_state >> 59);
+    return (xorshifted >> rotation) | (xorshifted << ((32 - rotation) & 31));
+  }
+
+ private:
+  static constexpr uint64_t MULTIPLIER = 6364136223846793005ULL;
+};
+
+/*!
+ * @class Xorshift128Plus
+ * xorshift128+ generator, the state needs to be seeded before use
+ */
+class Xorshift128Plus {
+ public:
+  static void seed(RandomState& random_state, uint64_t seed) {
+    // Expand the seed with splitmix64 so that the state is never all zeros
+    random_state.state = splitMix64(seed);
+    random_state.increment = splitMix64(seed);
+  }
+
+  static uint32_t next(RandomState& random_state) {
+    uint64_t s1 = random_state.state;
+    const uint64_t s0 = random_state.increment;
+    random_state.state = s0;
+    s1 ^= s1 << 23;
+    random_state.increment = s1 ^ s0 ^ (s1 >> 17) ^ (s0 >> 26);
+    return static_cast<uint32_t>((random_state.increment + s0) >> 32);
+  }
+
+ private:
+  static uint64_t splitMix64(uint64_t& seed) {
+    uint64_t value = (seed += 0x9e3779b97f4a7c15ULL);
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+  }
+};
+
+/*!
+ * @struct RandomPolicy
+ * Generator used by the control unit for RND, selected at construction
+ */
+struct RandomPolicy {
+  void (*seed)(RandomState& random_state, uint64_t seed);
+  uint32_t (*next)(RandomState& random_state);
+
+  template <typename Generator>
+  static constexpr RandomPolicy of() {
+    return RandomPolicy{&Generator::seed, &Generator::next};
+  }
+};
+
+/*!
+ * Draw one number from each of many independent generators, used to step a
+ * batch of machines together
+ * @tparam Generator Pcg32 or Xorshift128Plus
+ * @param random_states states of the generators
+ * @param n_states number of generators
+ * @param values buffer of n_states numbers
+ */
+template <typename Generator>
+void generateBatch(RandomState* random_states, std::size_t n_states,
+                   uint32_t* values) {
+  for (std::size_t i = 0; i < n_states; ++i) {
+    values[i] = Generator::next(random_states[i]);
+  }
+}
+
+/*!
+ * @class RandomEngine
+ * Adapter of a generator owning its state to the standard uniform random bit
+ * generator requirements, to be used with the standard distributions
+ */
+template <typename Generator>
+class RandomEngine {
+ public:
+  using result_type = uint32_t;
+
+  explicit RandomEngine(uint64_t seed = 0) : m_state{} {
+    Generator::seed(m_state, seed);
+  }
+
+  void seed(uint64_t seed) { Generator::seed(m_state, seed); }
+
+  result_type operator()() { return Generator::next(m_state); }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+ private:
+  RandomState m_state;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_RANDOM_H_
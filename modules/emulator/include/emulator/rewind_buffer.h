@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_REWIND_BUFFER_H_
+#define MODULES_INTERPRETER_REWIND_BUFFER_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "machine_state.h"
+#include "ram_write_tracker.h"
+
+namespace chip8 {
+
+/*!
+ * @class RewindBuffer
+ * Rolling window of the last frames of a machine, stored in a fixed amount of
+ * memory. Every keyframe_interval frames a keyframe is stored, the other
+ * frames are stored as the XOR with their keyframe where runs of zeros are
+ * compressed. Restoring any frame costs at most one keyframe and one delta
+ * decode. When the storage is full the oldest frames are dropped.
+ *
+ * Given the RAM write tracker of the machine, the RAM pages not written since
+ * the keyframe are not compared when encoding a delta, most frames write a
+ * few bytes of the RAM at most.
+ */
+class RewindBuffer {
+ public:
+  /*!
+   * @param max_frames maximum number of frames kept
+   * @param storage_size bytes available for the compressed frames
+   * @param keyframe_interval number of frames between two keyframes
+   * @throw std::invalid_argument if the storage cannot hold two keyframes or
+   * the interval is not in [1, 65535]
+   */
+  RewindBuffer(std::size_t max_frames, std::size_t storage_size,
+               std::size_t keyframe_interval);
+
+  /*!
+   * Record the state of the next frame
+   * @param state
+   */
+  void push(const MachineState& state);
+
+  /*!
+   * Record the state of the next frame, skipping the RAM pages the tracker
+   * did not see written since the keyframe. The tracker is checkpointed at
+   * each keyframe.
+   * @param state
+   * @param ram_writes tracker of the writes of the machine of the state
+   */
+  void push(const MachineState& state, RamWriteTracker& ram_writes);
+
+  /*!
+   * Drop the newest frame and restore the one before it
+   * @param state filled with the restored frame
+   * @return false if there is no frame to go back to
+   */
+  bool stepBack(MachineState& state);
+
+  void clear();
+
+  /*!
+   * @return number of frames stored
+   */
+  std::size_t size() const { return m_size; }
+
+  std::size_t capacity() const { return m_entries.size(); }
+
+  /*!
+   * @return memory allocated by the buffer in bytes, constant over its life
+   */
+  std::size_t memoryUsage() const;
+
+ private:
+  struct Entry {
+    uint32_t offset;
+    uint16_t size;
+    uint16_t keyframe_distance;  ///< frames since the keyframe, 0 for one
+  };
+
+  Entry& entryOf(uint64_t frame) { return m_entries[frame % m_entries.size()]; }
+  void push(const MachineState& state, RamWriteTracker* ram_writes);
+  std::size_t allocate(std::size_t size);
+  void evictOldest();
+  void loadKeyframe(uint64_t frame);
+
+ private:
+  std::vector<Entry> m_entries;
+  std::vector<uint8_t> m_storage;
+  std::size_t m_keyframe_interval;
+  uint64_t m_first_frame;
+  std::size_t m_size;
+  std::size_t m_head;
+  uint64_t m_keyframe_frame;  ///< frame whose state is in m_keyframe
+  /// epoch of the tracker when the last keyframe was pushed, if tracked
+  std::optional<RamWriteTracker::epoch_t> m_keyframe_epoch;
+  std::vector<uint8_t> m_keyframe;
+  std::vector<uint8_t> m_packed;
+  std::vector<uint8_t> m_record;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_REWIND_BUFFER_H_
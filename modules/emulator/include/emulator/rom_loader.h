@@ -27,21 +27,53 @@
 #define MODULES_INTERPRETER_ROM_LOADER_H_
 
 // std
+#include <cstddef>
 #include <cstdint>
-#include <iostream>
-#include <vector>
+#include <istream>
+#include <string>
 
 #include "memory.h"
 
 namespace chip8 {
 
+extern const std::size_t PROGRAM_START_ADDRESS;
+// The program fills the RAM from 0x200 to 0xFFF at most
+extern const std::size_t MAX_PROGRAM_SIZE;
+
+/*!
+ * @struct RomLoadResult
+ * Outcome of loading a program, converts to true on success
+ */
+struct RomLoadResult {
+  bool success;
+  // Number of bytes of the program copied to the RAM
+  std::size_t size;
+  // Why the program could not be loaded, empty on success
+  std::string error;
+
+  explicit operator bool() const { return success; }
+};
+
 /*!
- * Copy the rom stored in the input stream to the ram memory
- * @param buffer
+ * Read the program stored in the input stream straight into the RAM, by
+ * bounded chunks so that pipes and stdin work as well as files. A program
+ * which does not fit is an error, the RAM then holds its beginning.
+ * @param ram
  * @param input_stream
- * @return true if program was successfully loaded
+ * @return result of the load
+ */
+RomLoadResult loadProgramFromStream(RAM& ram, std::istream& input_stream);
+
+/*!
+ * Load the program stored in a file. The file is read by bounded chunks
+ * straight into the RAM, without any intermediate buffer, whether it is a
+ * regular file or not (pipes, character devices). Regular files larger than
+ * the RAM are rejected from their size before anything is read.
+ * @param ram
+ * @param path
+ * @return result of the load
  */
-bool loadProgramFromStream(RAM& buffer, std::istream& input_stream);
+RomLoadResult loadProgramFromFile(RAM& ram, const std::string& path);
 
 }  // namespace chip8
 #endif  // MODULES_INTERPRETER_ROM_LOADER_H_
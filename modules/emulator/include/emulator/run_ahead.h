@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_RUN_AHEAD_H_
+#define MODULES_INTERPRETER_RUN_AHEAD_H_
+
+// std
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bitmask_user_input.h"
+#include "emulator.h"
+#include "frame_buffer_model.h"
+#include "machine_state.h"
+
+namespace chip8 {
+
+extern const std::size_t MAX_RUN_AHEAD_FRAMES;
+
+/*!
+ * @class RunAhead
+ * Hide the input lag of a program. After each frame the machine is saved, run
+ * a few frames ahead with the current keys, the display of that future frame
+ * is kept to be presented and the machine is restored. Programs polling the
+ * keys with Fx0A or ExA1 loops react a few frames after a key press, the
+ * presented frame shows the reaction as soon as the key is pressed.
+ *
+ * The extra frames cost CPU time on every frame, the average cost is measured
+ * so that the number of frames can be chosen accordingly. They run as a
+ * speculative run of the emulator: they do not count in
+ * Emulator::countFrames() nor reach its snapshot publisher.
+ */
+class RunAhead {
+ public:
+  /*!
+   * @param emulator emulator driven frame by frame
+   * @param keypad input controller of the emulator
+   * @param n_frames number of frames run ahead, 0 presents the current frame
+   */
+  RunAhead(Emulator& emulator, BitmaskUserInputController& keypad,
+           std::size_t n_frames);
+
+  /*!
+   * Run a frame with the keys then run ahead to the frame to present
+   * @param keys bit i is set if key i is pressed
+   */
+  void runFrame(uint16_t keys);
+
+  /*!
+   * Present the current frame of the emulator, e.g. after its state was
+   * restored
+   */
+  void present();
+
+  /*!
+   * @param n_frames number of frames run ahead, at most MAX_RUN_AHEAD_FRAMES
+   */
+  void setFrames(std::size_t n_frames);
+  std::size_t getFrames() const { return m_n_frames; }
+
+  /*!
+   * @return display of the frame to present
+   */
+  const DisplayModel& getDisplayModel() const { return m_presented_model; }
+
+  /*!
+   * @return average time spent running ahead per frame
+   */
+  std::chrono::nanoseconds getAverageCost() const {
+    return std::chrono::nanoseconds(static_cast<int64_t>(m_average_cost));
+  }
+
+  /*!
+   * @return share of a 60 Hz frame spent running ahead, 1 is the whole frame
+   */
+  double getFrameBudgetUsage() const;
+
+ private:
+  Emulator& m_emulator;
+  BitmaskUserInputController& m_keypad;
+  std::size_t m_n_frames;
+  std::unique_ptr<MachineState> m_saved_state;
+  FrameBuffer m_presented;
+  FrameBufferModel m_presented_model;
+  double m_average_cost;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_RUN_AHEAD_H_
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_SAVE_STATE_H_
+#define MODULES_INTERPRETER_SAVE_STATE_H_
+
+// std
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+extern const uint32_t SAVE_STATE_MAGIC;
+extern const uint16_t SAVE_STATE_VERSION;
+
+/*!
+ * Serialize a machine state. Registers, timers, stack and the state of the
+ * random number generator are stored as is, the RAM is stored as the run
+ * length encoded XOR with the reference image so that only the bytes written
+ * by the program take space, and the display is stored bit packed and run
+ * length encoded. The buffer ends with a checksum.
+ * @param state
+ * @param reference RAM right after the ROM was loaded
+ * @return encoded state, a few hundred bytes for a typical program
+ */
+std::vector<uint8_t> encodeSaveState(const MachineState& state,
+                                     const RAM& reference);
+
+/*!
+ * @param data encoded state
+ * @param size size of the encoded state in bytes
+ * @param reference RAM image the state was encoded against
+ * @param state filled with the decoded state, untouched on failure
+ * @return true if the buffer is a valid save state of the current version
+ */
+bool decodeSaveState(const uint8_t* data, std::size_t size,
+                     const RAM& reference, MachineState& state);
+
+/*!
+ * Read and decode a save state written by a SaveStateWriter
+ * @param input_stream
+ * @param reference RAM image the state was encoded against
+ * @param state filled with the decoded state, untouched on failure
+ * @return true if the state was successfully read
+ */
+bool loadSaveState(std::istream& input_stream, const RAM& reference,
+                   MachineState& state);
+
+/*!
+ * @class SaveStateWriter
+ * Encode and write save states on a background thread. Capturing a state is a
+ * copy of the machine state, the emulation loop never waits for the encoding
+ * or the file system.
+ */
+class SaveStateWriter {
+ public:
+  /*!
+   * @param reference RAM right after the ROM was loaded
+   */
+  explicit SaveStateWriter(const RAM& reference);
+
+  /*!
+   * Write the pending states before stopping the background thread
+   */
+  ~SaveStateWriter();
+
+  SaveStateWriter(const SaveStateWriter&) = delete;
+  SaveStateWriter& operator=(const SaveStateWriter&) = delete;
+
+  /*!
+   * Queue a copy of the state to be written to a file
+   * @param state
+   * @param path file replaced by the save state
+   */
+  void write(const MachineState& state, std::string path);
+
+  /*!
+   * Block until every queued state is written
+   */
+  void flush();
+
+  /*!
+   * @return number of states which could not be written
+   */
+  std::size_t countFailures() const;
+
+ private:
+  void run();
+
+ private:
+  const RAM m_reference;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_pending_condition;
+  std::condition_variable m_written_condition;
+  std::deque<std::pair<MachineState, std::string>> m_pending;
+  bool m_busy;
+  bool m_stopping;
+  std::size_t m_n_failures;
+  std::thread m_thread;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_SAVE_STATE_H_
@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_SNAPSHOT_PUBLISHER_H_
+#define MODULES_INTERPRETER_SNAPSHOT_PUBLISHER_H_
+
+// std
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+/*!
+ * @struct Snapshot
+ * Machine state published at the end of a frame
+ */
+struct Snapshot {
+  // Number of frames run by the emulator when the state was published
+  uint64_t frame;
+  MachineState state;
+};
+
+/*!
+ * @class SnapshotPublisher
+ * Publish snapshots of the machine from the emulation thread to any number of
+ * observer threads (debugger, overlay, metrics...) under a seqlock. The writer
+ * never waits: it makes the sequence odd, copies the snapshot and makes it
+ * even again. A reader copies the snapshot and retries if the sequence was odd
+ * or changed meanwhile, so it never sees a torn state.
+ *
+ * The snapshot is stored as relaxed atomic words, so publishing costs a copy
+ * of the state and nothing else.
+ */
+class SnapshotPublisher {
+ public:
+  SnapshotPublisher();
+
+  SnapshotPublisher(const SnapshotPublisher&) = delete;
+  SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+  /*!
+   * Publish a snapshot, must be called from a single thread
+   * @param frame number of frames run by the emulator
+   * @param state
+   */
+  void publish(uint64_t frame, const MachineState& state);
+
+  /*!
+   * Copy the last published snapshot if no publication is in progress
+   * @param snapshot filled with the snapshot, untouched on failure
+   * @return true if the copy is consistent
+   */
+  bool tryRead(Snapshot& snapshot) const;
+
+  /*!
+   * Copy the last published snapshot, retrying while it is being published
+   * @param snapshot
+   * @return false if nothing was published yet
+   */
+  bool read(Snapshot& snapshot) const;
+
+  /*!
+   * @return number of publications, increases by one for each snapshot
+   */
+  uint64_t countPublications() const {
+    return m_sequence.load(std::memory_order_acquire) / 2;
+  }
+
+ private:
+  static constexpr std::size_t N_WORDS =
+      (sizeof(Snapshot) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+  // Readers and writer spin on the sequence, keep it apart from the data
+  alignas(64) std::atomic<uint64_t> m_sequence;
+  alignas(64) std::array<std::atomic<uint64_t>, N_WORDS> m_words;
+};
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_SNAPSHOT_PUBLISHER_H_
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_STATE_CORPUS_H_
+#define MODULES_INTERPRETER_STATE_CORPUS_H_
+
+// std
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+class Emulator;
+
+extern const uint32_t STATE_CORPUS_MAGIC;
+extern const std::size_t STATE_CORPUS_DEFAULT_MAX_RECORDS;
+
+/*!
+ * A state of the corpus, stored as is so that it is restored by a copy
+ */
+struct StateRecord {
+  uint64_t state_hash;
+  uint64_t memory_hash;
+  MachineState state;
+};
+
+/*!
+ * @class StateCorpus
+ * Append only store of machine states on disk. The records have a fixed
+ * layout and the file is mapped in memory, so restoring a state is a copy
+ * from the page cache without any decoding. The hashes of the states are
+ * appended to an index file next to it (<path>.idx) which is loaded in a hash
+ * table when the corpus is opened, so that a state is stored only once.
+ *
+ * A single process appends to a corpus, any number of threads and processes
+ * read it. The whole file is mapped once with room for max_records states:
+ * the mapping never moves and a record is published by incrementing the
+ * count in the header after it is written.
+ */
+class StateCorpus {
+ public:
+  StateCorpus();
+  ~StateCorpus();
+
+  StateCorpus(const StateCorpus&) = delete;
+  StateCorpus& operator=(const StateCorpus&) = delete;
+
+  /*!
+   * Open or create a corpus
+   * @param path file of the records
+   * @param writable true to append, fails if another process appends already
+   * @param max_records number of records the mapping has room for
+   * @return true if the corpus was opened, false if the files could not be
+   * opened or were written with another layout
+   */
+  bool open(const std::string& path, bool writable,
+            std::size_t max_records = STATE_CORPUS_DEFAULT_MAX_RECORDS);
+
+  void close();
+
+  bool isOpen() const { return m_header != nullptr; }
+
+  /*!
+   * @return number of records published, including the ones appended by
+   * another process since the last refresh(), up to the max_records given to
+   * open()
+   */
+  std::size_t size() const;
+
+  /*!
+   * Store a state unless it is already in the corpus
+   * @param state
+   * @param memory_hash hash of the RAM and display of the state, see
+   * Emulator::getMemoryHash()
+   * @return index of the record holding the state, nullopt if the corpus is
+   * read only or full
+   */
+  std::optional<std::size_t> append(const MachineState& state,
+                                    uint64_t memory_hash);
+
+  /*!
+   * @param state_hash hash of the whole state, see Emulator::stateHash()
+   * @return index of the record holding the state if it is in the corpus
+   */
+  std::optional<std::size_t> find(uint64_t state_hash) const;
+
+  /*!
+   * Index the records appended by another process since the corpus was
+   * opened
+   */
+  void refresh();
+
+  /*!
+   * @param index index of a published record
+   * @return record, mapped from the file
+   * @throw std::out_of_range if the index is not below size()
+   */
+  const StateRecord& getRecord(std::size_t index) const;
+
+  /*!
+   * Copy a record into an emulator
+   * @param index index of a published record
+   * @param emulator
+   * @throw std::out_of_range if the index is not below size()
+   */
+  void restore(std::size_t index, Emulator& emulator) const;
+
+ private:
+  struct Header;
+
+  std::size_t countPublished() const;
+  const StateRecord& record(std::size_t index) const;
+  bool reserve(std::size_t n_records);
+
+ private:
+  int m_fd;
+  int m_index_fd;
+  bool m_writable;
+  uint8_t* m_mapping;
+  std::size_t m_mapping_size;
+  Header* m_header;
+  std::size_t m_max_records;
+  std::size_t m_n_reserved;
+
+  // Hash index of the records, shared between the reading threads
+  mutable std::shared_mutex m_index_mutex;
+  std::unordered_map<uint64_t, std::size_t> m_index;
+  std::size_t m_n_indexed;
+};
+
+/*!
+ * Rewrite a corpus with the records to keep. The corpus must not be opened for
+ * writing during the compaction, readers which opened it before keep reading
+ * the previous files.
+ * @param path file of the records
+ * @param keep predicate selecting the records to keep
+ * @return true if the corpus was rewritten
+ */
+bool compactStateCorpus(const std::string& path,
+                        const std::function<bool(const StateRecord&)>& keep);
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_STATE_CORPUS_H_
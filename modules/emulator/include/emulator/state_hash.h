@@ -0,0 +1,126 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_INTERPRETER_STATE_HASH_H_
+#define MODULES_INTERPRETER_STATE_HASH_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+
+#include "machine_state.h"
+
+namespace chip8 {
+
+static const uint64_t HASH_SEED = 0xcbf29ce484222325ULL;
+
+/*!
+ * Hash a buffer with 64 bits FNV-1a
+ * @param data buffer to hash
+ * @param size size of the buffer in bytes
+ * @param seed previous hash value, allows chaining several buffers
+ * @return hash value
+ */
+uint64_t hashBytes(const void* data, std::size_t size,
+                   uint64_t seed = HASH_SEED);
+
+/*!
+ * @param framebuffer
+ * @return hash of the pixels of the display
+ */
+uint64_t hashFrameBuffer(const FrameBuffer& framebuffer);
+
+/*!
+ * Hash every component of the machine state: registers, timers, stack, RAM,
+ * display and random number generator.
+ * @param state
+ * @return hash value
+ */
+uint64_t hashState(const MachineState& state);
+
+/*!
+ * @class IncrementalStateHash
+ * Hash of the RAM and the display which is updated on each write instead of
+ * being recomputed. It is the XOR of one term per byte depending on the
+ * address and the value of the byte, so a write only replaces one term.
+ */
+class IncrementalStateHash {
+ public:
+  IncrementalStateHash() : m_value(0) {}
+
+  /*!
+   * Recompute the hash from scratch, needed when the state is written without
+   * going through the update methods
+   * @param state
+   */
+  void reset(const MachineState& state) { m_value = hashMemory(state); }
+
+  /*!
+   * @param value hash of the current state, known from an earlier getValue()
+   */
+  void setValue(uint64_t value) { m_value = value; }
+
+  void updateRam(std::size_t address, uint8_t old_value, uint8_t new_value) {
+    m_value ^= term(address, old_value) ^ term(address, new_value);
+  }
+
+  void updatePixel(std::size_t index, uint8_t old_value, uint8_t new_value) {
+    m_value ^= term(RAM::size() + index, old_value) ^
+               term(RAM::size() + index, new_value);
+  }
+
+  uint64_t getValue() const { return m_value; }
+
+  /*!
+   * @param state
+   * @return hash of the RAM and display of the state computed from scratch
+   */
+  static uint64_t hashMemory(const MachineState& state);
+
+ private:
+  static uint64_t term(std::size_t position, uint8_t value) {
+    // splitmix64 finalizer
+    uint64_t term = (static_cast<uint64_t>(position) << 8 | value) +
+                    0x9e3779b97f4a7c15ULL;
+    term = (term ^ (term >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    term = (term ^ (term >> 27)) * 0x94d049bb133111ebULL;
+    return term ^ (term >> 31);
+  }
+
+ private:
+  uint64_t m_value;
+};
+
+/*!
+ * Combine the hash of the RAM and display with the registers, timers, stack
+ * and random number generator, which are small enough to be hashed each time
+ * @param state
+ * @param memory_hash hash of the RAM and display of the state
+ * @return hash of the whole state
+ */
+uint64_t combineStateHash(const MachineState& state, uint64_t memory_hash);
+
+}  // namespace chip8
+#endif  // MODULES_INTERPRETER_STATE_HASH_H_
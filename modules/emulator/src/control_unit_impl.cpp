@@ -33,8 +33,9 @@ namespace chip8 {
 ControlUnitImpl::ControlUnitImpl(
     ProgramCounter& pc, StackPointer& stack_ptr, IndexRegister& mem_add_reg,
     DelayTimerRegister& delay_timer_reg, SoundTimerRegister& sound_timer_reg,
-    Stack& stack, std::vector<GeneralRegister>& registers, RAM& ram,
-    DisplayController& display_ctrler, UserInputController& ui_ctrler)
+    Stack& stack, GeneralRegisters& registers, RAM& ram,
+    DisplayController& display_ctrler, UserInputController& ui_ctrler,
+    RandomState& random_state, RandomPolicy random_policy)
     : m_pc(pc),
       m_stack_ptr(stack_ptr),
       m_index_reg(mem_add_reg),
@@ -45,19 +46,23 @@ ControlUnitImpl::ControlUnitImpl(
       m_ram(ram),
       m_display_ctrler(display_ctrler),
       m_ui_ctrler(ui_ctrler),
-      m_rand_num_generator(0, 255) {}
+      m_random_state(random_state),
+      m_random_policy(random_policy),
+      m_state_hash(nullptr),
+      m_write_tracker(nullptr) {}
 
 void ControlUnitImpl::clearDisplay() { m_display_ctrler.clear(); }
 
 void ControlUnitImpl::returnFromSubroutine() {
-  m_pc = m_stack[m_stack_ptr];
-  --m_stack_ptr;
+  m_pc = m_stack[wrapStackIndex(m_stack_ptr)];
+  m_stack_ptr =
+      static_cast<uint8_t>(wrapStackIndex(m_stack_ptr + Stack::size() - 1));
 }
 
 void ControlUnitImpl::jumpToLocation(address_t address) { m_pc = address - 2; }
 
 void ControlUnitImpl::callSubroutineAt(address_t address) {
-  ++m_stack_ptr;
+  m_stack_ptr = static_cast<uint8_t>(wrapStackIndex(m_stack_ptr + 1));
   m_stack[m_stack_ptr] = m_pc;
   m_pc = address - 2;
 }
@@ -166,7 +171,10 @@ void ControlUnitImpl::setPCToV0PlusValue(address_t value) {
 
 void ControlUnitImpl::registerEqualRandomValue(uint8_t value,
                                                register_id_t reg) {
-  m_registers[reg] = (value & m_rand_num_generator.generateNumber());
+  // The high bits of the generators are the best distributed ones
+  auto random_byte =
+      static_cast<uint8_t>(m_random_policy.next(m_random_state) >> 24);
+  m_registers[reg] = (value & random_byte);
 }
 
 void ControlUnitImpl::displayOnScreen(uint16_t n_bytes_to_read,
@@ -176,7 +184,7 @@ void ControlUnitImpl::displayOnScreen(uint16_t n_bytes_to_read,
   for (uint16_t i = 0; i < n_bytes_to_read; ++i) {
     any_pixel_modified |= m_display_ctrler.setSprite(
         column_t(m_registers[reg_x]), row_t(m_registers[reg_y] + i),
-        byteToSprite(m_ram[m_index_reg + i]));
+        byteToSprite(m_ram[wrapAddress(m_index_reg + i)]));
   }
 
   if (any_pixel_modified) {
@@ -233,24 +241,37 @@ void ControlUnitImpl::setIndexRegToSpriteLocation(register_id_t reg_x) {
 }
 
 void ControlUnitImpl::storeBCDRepresentation(register_id_t reg_x) {
-  m_ram[m_index_reg + 2] = m_registers[reg_x] % 10;
-  m_ram[m_index_reg + 1] =
-      (m_registers[reg_x] % 100 - m_ram[m_index_reg + 2]) / 10;
-  m_ram[m_index_reg] = (m_registers[reg_x] % 1000 -
-                        m_ram[m_index_reg + 1] * 10 - m_ram[m_index_reg + 2]) /
-                       100;
+  uint8_t value = m_registers[reg_x];
+  writeRam(m_index_reg, value / 100);
+  writeRam(m_index_reg + 1, value / 10 % 10);
+  writeRam(m_index_reg + 2, value % 10);
 }
 
 void ControlUnitImpl::storeMultipleRegister(register_id_t reg_x) {
   for (register_id_t reg_id(0); reg_id <= reg_x; ++reg_id) {
-    m_ram[m_index_reg + reg_id] = m_registers[reg_id];
+    writeRam(m_index_reg + reg_id, m_registers[reg_id]);
   }
 }
 
 void ControlUnitImpl::readMultipleRegister(register_id_t reg_x) {
   for (register_id_t reg_id(0); reg_id <= reg_x; ++reg_id) {
-    m_registers[reg_id] = m_ram[reg_id + m_index_reg];
+    m_registers[reg_id] = m_ram[wrapAddress(reg_id + m_index_reg)];
   }
 }
 
+void ControlUnitImpl::writeRam(std::size_t address, uint8_t value) {
+  address = wrapAddress(address);
+  if (m_state_hash) {
+    m_state_hash->updateRam(address, m_ram[address], value);
+  }
+  if (m_write_tracker) {
+    m_write_tracker->markWritten(address);
+  }
+  m_ram[address] = value;
+}
+
+void ControlUnitImpl::seedRandomNumberGenerator(uint64_t seed) {
+  m_random_policy.seed(m_random_state, seed);
+}
+
 }  // namespace chip8
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "emulator/debug_policy.h"
+
+namespace chip8 {
+
+static const uint16_t PREFIX_DISPLAY = 0xD;
+static const uint16_t PREFIX_SINGLE_REG = 0xF;
+static const uint16_t POSTFIX_BCD = 0x33;
+static const uint16_t POSTFIX_STORE_REGISTERS = 0x55;
+static const uint16_t POSTFIX_READ_REGISTERS = 0x65;
+
+BreakpointPolicy::BreakpointPolicy()
+    : m_opcode_breakpoints(0), m_event(DebugEvent::NONE), m_event_address(0) {}
+
+bool BreakpointPolicy::check(const MachineState& state, uint16_t opcode) {
+  m_event = DebugEvent::NONE;
+
+  const std::size_t pc = wrapAddress(state.pc);
+  if (m_breakpoints[pc]) {
+    m_event = DebugEvent::BREAKPOINT;
+    m_event_address = pc;
+    return true;
+  }
+
+  const uint16_t prefix = opcode >> 12;
+  if ((m_opcode_breakpoints >> prefix) & 0x1) {
+    m_event = DebugEvent::OPCODE_BREAKPOINT;
+    m_event_address = pc;
+    return true;
+  }
+
+  const std::size_t reg_x = (opcode >> 8) & 0xF;
+  if (prefix == PREFIX_DISPLAY) {
+    return checkRange(m_read_watchpoints, state.index_reg, opcode & 0xF,
+                      DebugEvent::READ_WATCHPOINT);
+  }
+  if (prefix == PREFIX_SINGLE_REG) {
+    switch (opcode & 0xFF) {
+      case POSTFIX_BCD:
+        return checkRange(m_write_watchpoints, state.index_reg, 3,
+                          DebugEvent::WRITE_WATCHPOINT);
+      case POSTFIX_STORE_REGISTERS:
+        return checkRange(m_write_watchpoints, state.index_reg, reg_x + 1,
+                          DebugEvent::WRITE_WATCHPOINT);
+      case POSTFIX_READ_REGISTERS:
+        return checkRange(m_read_watchpoints, state.index_reg, reg_x + 1,
+                          DebugEvent::READ_WATCHPOINT);
+      default:
+        break;
+    }
+  }
+
+  return false;
+}
+
+bool BreakpointPolicy::checkRange(const std::bitset<RAM::size()>& watchpoints,
+                                  std::size_t address, std::size_t size,
+                                  DebugEvent event) {
+  for (std::size_t i = 0; i < size; ++i) {
+    const std::size_t byte = wrapAddress(address + i);
+    if (watchpoints[byte]) {
+      m_event = event;
+      m_event_address = byte;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace chip8
@@ -25,8 +25,10 @@
  */
 
 // std
+#include <cassert>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
 #include <utility>
 
 #include "emulator/emulator.h"
@@ -35,66 +37,225 @@
 #include "emulator/display_controller.h"
 #include "emulator/display_model.h"
 #include "emulator/display_view.h"
+#include "emulator/frame_buffer_model.h"
+#include "emulator/input_event_queue.h"
 #include "emulator/instruction_decoder.h"
 #include "emulator/rom_loader.h"
+#include "emulator/snapshot_publisher.h"
 #include "emulator/user_input.h"
 #include "emulator/clock.h"
 
 namespace chip8 {
 
-Emulator::Emulator(std::istream &rom,
-                   std::unique_ptr<DisplayController> display_controller,
-                   UserInputController *ui_controller)
-    : m_clock(new Clock([]() { return std::chrono::system_clock::now(); })),
-      m_display_controller(std::move(display_controller)),
+static const double CPU_FREQUENCY = 600;
+static const double TIMER_FREQUENCY = 60;
+static const uint16_t MASK_WAIT_FOR_KEY = 0xF0FF;
+static const uint16_t INSTRUCTION_WAIT_FOR_KEY = 0xF00A;
+
+extern const std::size_t CYCLES_PER_FRAME =
+    static_cast<std::size_t>(CPU_FREQUENCY / TIMER_FREQUENCY);
+
+Emulator::Emulator(std::istream& rom, UserInputController* ui_controller)
+    : m_owned_state(new MachineState()),
+      m_state(m_owned_state.get()),
       m_ui_controller(ui_controller),
-      m_registers(16),
-      m_ctrl_unit(new ControlUnitImpl(m_pc, m_stack_ptr, m_index_reg,
-                                      m_delay_timer_reg, m_sound_timer_reg,
-                                      m_stack, m_registers, m_ram,
-                                      *m_display_controller, *m_ui_controller)),
-      m_instruction_decoder(new InstructionDecoder(m_ctrl_unit.get())) {
+      m_clock(new Clock([]() { return std::chrono::system_clock::now(); })) {
+  initialize([&rom](RAM& ram) { return loadProgramFromStream(ram, rom); });
+}
+
+Emulator::Emulator(const std::string& rom_path,
+                   UserInputController* ui_controller)
+    : m_owned_state(new MachineState()),
+      m_state(m_owned_state.get()),
+      m_ui_controller(ui_controller),
+      m_clock(new Clock([]() { return std::chrono::system_clock::now(); })) {
+  initialize(
+      [&rom_path](RAM& ram) { return loadProgramFromFile(ram, rom_path); });
+}
+
+Emulator::Emulator(std::istream& rom, UserInputController* ui_controller,
+                   MachineState& state)
+    : m_state(&state),
+      m_ui_controller(ui_controller),
+      m_clock(new Clock([]() { return std::chrono::system_clock::now(); })) {
+  *m_state = MachineState();
+  initialize([&rom](RAM& ram) { return loadProgramFromStream(ram, rom); });
+}
+
+void Emulator::initialize(
+    const std::function<RomLoadResult(RAM&)>& load_program) {
+  // The display is rendered from the frame buffer of the machine state
+  m_display_model.reset(
+      new FrameBufferModel(m_state->framebuffer, &m_state_hash));
+  m_display_controller.reset(
+      new DisplayController(m_display_model.get(), nullptr));
+  m_ctrl_unit.reset(new ControlUnitImpl(
+      m_state->pc, m_state->stack_ptr, m_state->index_reg,
+      m_state->delay_timer_reg, m_state->sound_timer_reg, m_state->stack,
+      m_state->registers, m_state->ram, *m_display_controller,
+      *m_ui_controller, m_state->random_state));
+  m_ctrl_unit->trackRamWrites(&m_state_hash);
+  m_ctrl_unit->trackRamWrites(&m_ram_writes);
+  m_instruction_decoder.reset(new InstructionDecoder(m_ctrl_unit.get()));
+
   // Load the program
-  // TODO: throw exception if load fails
-  loadProgramFromStream(m_ram, rom);
+  const RomLoadResult program = load_program(m_state->ram);
+  if (!program) {
+    throw std::runtime_error("cannot load ROM: " + program.error);
+  }
 
   // Load the sprites in memory
-  storeSpriteInMemory(m_ram);
+  storeSpriteInMemory(m_state->ram);
 
   // Register callbacks that will drive the emulator
-  m_clock->registerCallback([this]() { this->clockCycle(); }, 600);
-  m_clock->registerCallback([this]() { this->decrementDelayTimer(); }, 60);
+  m_clock->registerCallback([this]() { this->clockCycle(); }, CPU_FREQUENCY);
+  m_clock->registerCallback([this]() { this->updateTimers(); },
+                            TIMER_FREQUENCY);
 
   // Init components
-  m_pc = 0x200;
-  m_stack_ptr = 0x0;
-  m_delay_timer_reg = 0x0;
+  m_state->pc = PROGRAM_START_ADDRESS;
+  m_state->stack_ptr = 0x0;
+  m_state->delay_timer_reg = 0x0;
+  m_state->sound_timer_reg = 0x0;
+  m_waiting_for_key = false;
+  m_n_frames = 0;
+  m_n_cycles = 0;
+  m_speculative = false;
+  m_speculation_n_frames = 0;
+  m_speculation_n_cycles = 0;
+  m_seed = 0;
+  m_publisher = nullptr;
+  m_input_events = nullptr;
+
+  // Runs are reproducible unless the emulator is seeded differently
+  m_ctrl_unit->seedRandomNumberGenerator(m_seed);
+
+  m_state_hash.reset(*m_state);
+  m_ram_writes.reset();
 }
 
 Emulator::~Emulator() = default;
 
 void Emulator::update() { m_clock->tick(); }
 
-void Emulator::decrementDelayTimer() {
-  if (m_delay_timer_reg != 0) {
-    --m_delay_timer_reg;
+void Emulator::decrementTimers() {
+  if (m_state->delay_timer_reg != 0) {
+    --m_state->delay_timer_reg;
+  }
+  if (m_state->sound_timer_reg != 0) {
+    --m_state->sound_timer_reg;
   }
 }
 
-void Emulator::clockCycle() {
-  // Fetch Opcode
-  instruction_t instruction{
-      static_cast<uint16_t>(m_ram[m_pc] << 8 | m_ram[m_pc + 1])};
+void Emulator::restoreState(const MachineState& state) {
+  *m_state = state;
+  m_state_hash.reset(*m_state);
+  m_ram_writes.markAll();
+  m_waiting_for_key = false;
+}
+
+void Emulator::restoreState(const MachineState& state,
+                            uint64_t memory_hash) {
+  if (&state != m_state) {
+    *m_state = state;
+  }
+  m_state_hash.setValue(memory_hash);
+  m_ram_writes.markAll();
+  m_waiting_for_key = false;
+}
+
+uint64_t Emulator::stateHash() const {
+  assert(m_state_hash.getValue() ==
+         IncrementalStateHash::hashMemory(*m_state));
+  return combineStateHash(*m_state, m_state_hash.getValue());
+}
+
+void Emulator::seed(uint64_t seed) {
+  m_seed = seed;
+  m_ctrl_unit->seedRandomNumberGenerator(seed);
+}
+
+void Emulator::reload(const std::string& rom_path) {
+  std::unique_ptr<MachineState> state(new MachineState());
+  const RomLoadResult program = loadProgramFromFile(state->ram, rom_path);
+  if (!program) {
+    throw std::runtime_error("cannot load ROM: " + program.error);
+  }
+
+  storeSpriteInMemory(state->ram);
+  state->pc = PROGRAM_START_ADDRESS;
+  restoreState(*state);
+  m_ctrl_unit->seedRandomNumberGenerator(m_seed);
+}
+
+void Emulator::runFrame() {
+  for (std::size_t cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle) {
+    step();
+  }
+
+  updateTimers();
+}
+
+void Emulator::updateTimers() {
+  decrementTimers();
+  ++m_n_frames;
+
+  if (m_publisher && !m_speculative) {
+    m_publisher->publish(m_n_frames, *m_state);
+  }
+}
+
+void Emulator::setSpeculative(bool speculative) {
+  if (speculative == m_speculative) {
+    return;
+  }
 
+  if (speculative) {
+    m_speculation_n_frames = m_n_frames;
+    m_speculation_n_cycles = m_n_cycles;
+  } else {
+    m_n_frames = m_speculation_n_frames;
+    m_n_cycles = m_speculation_n_cycles;
+  }
+  m_speculative = speculative;
+}
+
+void Emulator::clockCycle() {
   // Dump instruction
   std::cout << "Executed instruction: " << std::setfill('0') << std::setw(4)
-            << std::hex << instruction << "\n";
+            << std::hex << fetchInstruction() << "\n";
+
+  step();
+}
+
+void Emulator::step() {
+  if (m_input_events) {
+    m_input_events->advanceTo(m_n_cycles);
+  }
+  ++m_n_cycles;
+
+  // Fetch Opcode
+  instruction_t instruction = fetchInstruction();
+  ProgramCounter& pc = m_state->pc;
+  uint16_t pc_before_execution = pc;
 
   // Decode and execute instruction
   m_instruction_decoder->decode(instruction);
 
+  // Fx0A moves the PC back on itself while no key is pressed
+  m_waiting_for_key =
+      (instruction & MASK_WAIT_FOR_KEY) == INSTRUCTION_WAIT_FOR_KEY &&
+      pc != pc_before_execution;
+
   // Increment PC
-  m_pc += 2;
+  pc += 2;
+}
+
+instruction_t Emulator::fetchInstruction() {
+  const RAM& ram = m_state->ram;
+  const ProgramCounter& pc = m_state->pc;
+  return instruction_t{static_cast<uint16_t>(ram[wrapAddress(pc)] << 8 |
+                                             ram[wrapAddress(pc + 1)])};
 }
 
 }  // namespace chip8
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cmath>
+
+#include "emulator/input_event_queue.h"
+
+namespace chip8 {
+
+static bool isKey(InputId input_id) {
+  return input_id != InputId::INPUT_ERROR && input_id != InputId::INPUT_SIZE;
+}
+
+InputEventQueue::InputEventQueue(double cycles_per_second)
+    : m_cycles_per_second(cycles_per_second),
+      m_keys(0),
+      m_cycle(0),
+      m_last_queued_cycle(0) {}
+
+std::optional<InputState> InputEventQueue::getInputState(InputId input_id) {
+  if (!isKey(input_id)) {
+    return std::optional<InputState>();
+  }
+
+  return (m_keys >> static_cast<int>(input_id)) & 0x1 ? InputState::ON
+                                                      : InputState::OFF;
+}
+
+void InputEventQueue::push(InputEvent event) {
+  if (!isKey(event.input_id)) {
+    return;
+  }
+
+  event.cycle = std::max({event.cycle, m_cycle, m_last_queued_cycle});
+  m_last_queued_cycle = event.cycle;
+  m_pending.push_back(event);
+}
+
+void InputEventQueue::pushHostEvent(InputId input_id, InputState state,
+                                    time_point timestamp) {
+  m_host_events.push_back(HostEvent{input_id, state, timestamp});
+}
+
+void InputEventQueue::sync(time_point now, uint64_t cycle) {
+  // The first batch has no previous sync, its events are all due at once
+  const time_point last_sync = m_last_sync.value_or(now);
+  m_last_sync = now;
+
+  std::stable_sort(m_host_events.begin(), m_host_events.end(),
+                   [](const HostEvent& lhs, const HostEvent& rhs) {
+                     return lhs.timestamp < rhs.timestamp;
+                   });
+
+  auto event = m_host_events.begin();
+  for (; event != m_host_events.end() && event->timestamp <= now; ++event) {
+    const std::chrono::duration<double> offset =
+        std::max(event->timestamp - last_sync, time_point::duration(0));
+    push(InputEvent{
+        cycle + static_cast<uint64_t>(
+                    std::floor(offset.count() * m_cycles_per_second)),
+        event->input_id, event->state});
+  }
+  m_host_events.erase(m_host_events.begin(), event);
+}
+
+void InputEventQueue::advanceTo(uint64_t cycle) {
+  m_cycle = std::max(m_cycle, cycle);
+  while (!m_pending.empty() && m_pending.front().cycle <= m_cycle) {
+    const InputEvent& event = m_pending.front();
+    const uint16_t mask = static_cast<uint16_t>(
+        1 << static_cast<int>(event.input_id));
+    m_keys = event.state == InputState::ON ? m_keys | mask : m_keys & ~mask;
+    m_log.push_back(event);
+    m_pending.pop_front();
+  }
+}
+
+}  // namespace chip8
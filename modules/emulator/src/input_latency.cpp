@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+
+#include "emulator/input_latency.h"
+
+namespace chip8 {
+
+const std::size_t LatencyHistogram::N_BUCKETS;
+
+LatencyHistogram::LatencyHistogram() { reset(); }
+
+void LatencyHistogram::record(std::chrono::nanoseconds latency) {
+  const auto us = std::max<int64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(latency).count(),
+      1);
+  std::size_t bucket = 0;
+  while (bucket + 1 < N_BUCKETS && (us >> (bucket + 1)) != 0) {
+    ++bucket;
+  }
+
+  ++m_buckets[bucket];
+  ++m_n_samples;
+  m_sum += latency;
+  m_max = std::max(m_max, latency);
+}
+
+void LatencyHistogram::reset() {
+  m_buckets.fill(0);
+  m_n_samples = 0;
+  m_sum = std::chrono::nanoseconds(0);
+  m_max = std::chrono::nanoseconds(0);
+}
+
+std::chrono::microseconds LatencyHistogram::getBucketLowerBound(
+    std::size_t bucket) {
+  return std::chrono::microseconds(bucket == 0 ? 0 : int64_t(1) << bucket);
+}
+
+std::chrono::microseconds LatencyHistogram::getPercentile(
+    double quantile) const {
+  if (m_n_samples == 0) {
+    return std::chrono::microseconds(0);
+  }
+
+  const auto rank = static_cast<uint64_t>(quantile * (m_n_samples - 1)) + 1;
+  uint64_t count = 0;
+  std::size_t bucket = 0;
+  for (; bucket + 1 < N_BUCKETS; ++bucket) {
+    count += m_buckets[bucket];
+    if (count >= rank) {
+      break;
+    }
+  }
+
+  return std::chrono::microseconds(int64_t(1) << (bucket + 1));
+}
+
+std::chrono::nanoseconds LatencyHistogram::getMean() const {
+  return m_n_samples == 0 ? std::chrono::nanoseconds(0)
+                          : m_sum / static_cast<int64_t>(m_n_samples);
+}
+
+void LatencyHistogram::print(std::ostream& stream) const {
+  using std::chrono::microseconds;
+  using std::chrono::duration_cast;
+
+  stream << m_n_samples << " samples, mean "
+         << duration_cast<microseconds>(getMean()).count() << " us, p50 < "
+         << getPercentile(0.5).count() << " us, p99 < "
+         << getPercentile(0.99).count() << " us, max "
+         << duration_cast<microseconds>(m_max).count() << " us\n";
+  for (std::size_t bucket = 0; bucket < N_BUCKETS; ++bucket) {
+    if (m_buckets[bucket] != 0) {
+      stream << "  >= " << getBucketLowerBound(bucket).count()
+             << " us: " << m_buckets[bucket] << "\n";
+    }
+  }
+}
+
+InputLatencyTracker::InputLatencyTracker(
+    UserInputController& input, std::function<time_point()> get_current_time_cb)
+    : m_input(input),
+      m_get_current_time(std::move(get_current_time_cb)),
+      m_pending(),
+      m_n_dropped(0) {}
+
+std::optional<InputState> InputLatencyTracker::getInputState(
+    InputId input_id) {
+  const auto state = m_input.getInputState(input_id);
+  if (!state || input_id == InputId::INPUT_ERROR ||
+      input_id == InputId::INPUT_SIZE) {
+    return state;
+  }
+
+  PendingEvent& pending = m_pending[static_cast<std::size_t>(input_id)];
+  if (pending.active && pending.state == *state) {
+    pending.active = false;
+    m_observe.record(m_get_current_time() - pending.timestamp);
+    m_observed.push_back(pending.timestamp);
+  }
+
+  return state;
+}
+
+void InputLatencyTracker::keyEvent(InputId input_id, InputState state,
+                                   time_point timestamp) {
+  if (input_id == InputId::INPUT_ERROR || input_id == InputId::INPUT_SIZE) {
+    return;
+  }
+
+  PendingEvent& pending = m_pending[static_cast<std::size_t>(input_id)];
+  if (pending.active) {
+    ++m_n_dropped;
+  }
+  pending = PendingEvent{true, state, timestamp};
+}
+
+void InputLatencyTracker::framePresented(const DisplayModel& display,
+                                         time_point timestamp) {
+  const std::size_t width = display.getWidth();
+  const std::size_t height = display.getHeight();
+  m_last_frame.resize(width * height);
+
+  bool changed = false;
+  for (std::size_t row = 0; row < height; ++row) {
+    for (std::size_t col = 0; col < width; ++col) {
+      const uint8_t value = display.getPixelValue(column_t(col), row_t(row));
+      uint8_t& last_value = m_last_frame[row * width + col];
+      changed |= value != last_value;
+      last_value = value;
+    }
+  }
+
+  if (!changed) {
+    return;
+  }
+
+  for (const auto& event_timestamp : m_observed) {
+    m_present.record(timestamp - event_timestamp);
+  }
+  m_observed.clear();
+}
+
+}  // namespace chip8
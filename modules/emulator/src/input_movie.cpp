@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <utility>
+
+#include "emulator/input_movie.h"
+#include "emulator/little_endian.h"
+
+namespace chip8 {
+
+const uint32_t INPUT_MOVIE_MAGIC = 0x564D3843;  // "C8MV"
+const uint16_t INPUT_MOVIE_VERSION = 1;
+const uint32_t INPUT_EVENTS_MAGIC = 0x45493843;  // "C8IE"
+// A day at 60 Hz, the runs of a corrupted movie cannot exhaust the memory
+const std::size_t MAX_INPUT_MOVIE_FRAMES = 24 * 60 * 60 * 60;
+
+static const std::size_t KEYS_COUNT = 16;
+
+InputMovie::InputMovie(std::vector<uint16_t> frames, uint32_t seed)
+    : m_frames(std::move(frames)), m_seed(seed) {}
+
+void InputMovie::append(uint16_t keys) { m_frames.push_back(keys); }
+
+uint16_t InputMovie::getKeys(std::size_t frame) const {
+  return frame < m_frames.size() ? m_frames[frame] : 0;
+}
+
+void InputMovie::save(std::ostream& output_stream) const {
+  // Keys are held during many frames so runs are much shorter than frames
+  std::vector<std::pair<uint32_t, uint16_t>> runs;
+  for (auto keys : m_frames) {
+    if (!runs.empty() && runs.back().second == keys &&
+        runs.back().first < UINT32_MAX) {
+      ++runs.back().first;
+    } else {
+      runs.emplace_back(1, keys);
+    }
+  }
+
+  writeValue(output_stream, INPUT_MOVIE_MAGIC);
+  writeValue(output_stream, INPUT_MOVIE_VERSION);
+  writeValue(output_stream, m_seed);
+  writeValue(output_stream, static_cast<uint32_t>(runs.size()));
+  for (const auto& run : runs) {
+    writeValue(output_stream, run.first);
+    writeValue(output_stream, run.second);
+  }
+}
+
+bool InputMovie::load(std::istream& input_stream) {
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint32_t seed = 0;
+  uint32_t n_runs = 0;
+  if (!readValue(input_stream, magic) || magic != INPUT_MOVIE_MAGIC ||
+      !readValue(input_stream, version) || version != INPUT_MOVIE_VERSION ||
+      !readValue(input_stream, seed) || !readValue(input_stream, n_runs)) {
+    return false;
+  }
+
+  // A truncated run means the movie is corrupted
+  std::vector<uint16_t> frames;
+  for (uint32_t run = 0; run < n_runs; ++run) {
+    uint32_t length = 0;
+    uint16_t keys = 0;
+    if (!readValue(input_stream, length) || !readValue(input_stream, keys) ||
+        length == 0 || length > MAX_INPUT_MOVIE_FRAMES - frames.size()) {
+      return false;
+    }
+    frames.insert(frames.end(), length, keys);
+  }
+
+  m_frames = std::move(frames);
+  m_seed = seed;
+  return true;
+}
+
+std::optional<InputState> InputMoviePlayer::getInputState(InputId input_id) {
+  if (input_id == InputId::INPUT_ERROR || input_id == InputId::INPUT_SIZE) {
+    return std::optional<InputState>();
+  }
+
+  return (m_movie.getKeys(m_frame) >> static_cast<int>(input_id)) & 0x1
+             ? InputState::ON
+             : InputState::OFF;
+}
+
+uint16_t readKeys(UserInputController& ui_controller) {
+  uint16_t keys = 0;
+  for (std::size_t key = 0; key < KEYS_COUNT; ++key) {
+    auto state = ui_controller.getInputState(static_cast<InputId>(key));
+    if (state && *state == InputState::ON) {
+      keys |= static_cast<uint16_t>(1 << key);
+    }
+  }
+
+  return keys;
+}
+
+void saveInputEvents(std::ostream& output_stream,
+                     const std::vector<InputEvent>& events, uint32_t seed) {
+  writeValue(output_stream, INPUT_EVENTS_MAGIC);
+  writeValue(output_stream, INPUT_MOVIE_VERSION);
+  writeValue(output_stream, seed);
+  writeValue(output_stream, static_cast<uint32_t>(events.size()));
+  for (const auto& event : events) {
+    writeValue(output_stream, event.cycle);
+    writeValue(output_stream, static_cast<uint8_t>(event.input_id));
+    writeValue(output_stream, static_cast<uint8_t>(event.state));
+  }
+}
+
+bool loadInputEvents(std::istream& input_stream,
+                     std::vector<InputEvent>& events, uint32_t& seed) {
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint32_t stored_seed = 0;
+  uint32_t n_events = 0;
+  if (!readValue(input_stream, magic) || magic != INPUT_EVENTS_MAGIC ||
+      !readValue(input_stream, version) || version != INPUT_MOVIE_VERSION ||
+      !readValue(input_stream, stored_seed) ||
+      !readValue(input_stream, n_events)) {
+    return false;
+  }
+
+  // Events out of order or of unknown keys mean the log is corrupted
+  std::vector<InputEvent> stored_events;
+  for (uint32_t i = 0; i < n_events; ++i) {
+    uint64_t cycle = 0;
+    uint8_t key = 0;
+    uint8_t state = 0;
+    if (!readValue(input_stream, cycle) || !readValue(input_stream, key) ||
+        !readValue(input_stream, state) || key >= KEYS_COUNT || state > 1 ||
+        (!stored_events.empty() && cycle < stored_events.back().cycle)) {
+      return false;
+    }
+    stored_events.push_back(InputEvent{cycle, static_cast<InputId>(key),
+                                       static_cast<InputState>(state)});
+  }
+
+  events = std::move(stored_events);
+  seed = stored_seed;
+  return true;
+}
+
+}  // namespace chip8
@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstdint>
+#include <new>
+
+// linux
+#include <sys/mman.h>
+
+#include "emulator/instance_arena.h"
+
+namespace chip8 {
+
+static std::size_t roundUp(std::size_t value, std::size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+InstanceArena::InstanceArena(std::size_t capacity)
+    : m_capacity(capacity),
+      m_stride(roundUp(sizeof(MachineState), CACHE_LINE_SIZE)),
+      m_mapping_size(roundUp(capacity * m_stride, HUGE_PAGE_SIZE)),
+      m_mapping(MAP_FAILED),
+      m_slots(nullptr),
+      m_huge_pages(false) {
+#ifdef MAP_HUGETLB
+  // Explicit huge pages are only available if the administrator reserved them
+  m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  m_huge_pages = m_mapping != MAP_FAILED;
+#endif
+
+  if (m_mapping == MAP_FAILED) {
+    // Over-allocate to be able to align the states on a huge page boundary
+    m_mapping_size += HUGE_PAGE_SIZE;
+    m_mapping = mmap(nullptr, m_mapping_size, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m_mapping == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+  }
+
+  auto address = reinterpret_cast<std::uintptr_t>(m_mapping);
+  m_slots = static_cast<unsigned char*>(m_mapping) +
+            (roundUp(address, HUGE_PAGE_SIZE) - address);
+
+#ifdef MADV_HUGEPAGE
+  if (!m_huge_pages) {
+    // Best effort, the kernel may ignore the advice
+    madvise(m_slots, m_mapping_size - HUGE_PAGE_SIZE, MADV_HUGEPAGE);
+  }
+#endif
+
+  // Hand out the slots in address order
+  m_free_slots.reserve(capacity);
+  for (std::size_t slot = capacity; slot > 0; --slot) {
+    m_free_slots.push_back(slot - 1);
+  }
+}
+
+InstanceArena::~InstanceArena() { munmap(m_mapping, m_mapping_size); }
+
+MachineState* InstanceArena::allocate() {
+  if (m_free_slots.empty()) {
+    return nullptr;
+  }
+
+  std::size_t slot = m_free_slots.back();
+  m_free_slots.pop_back();
+  return new (m_slots + slot * m_stride) MachineState();
+}
+
+void InstanceArena::release(MachineState* state) {
+  auto offset = reinterpret_cast<unsigned char*>(state) - m_slots;
+  m_free_slots.push_back(static_cast<std::size_t>(offset) / m_stride);
+}
+
+}  // namespace chip8
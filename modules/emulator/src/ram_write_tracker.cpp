@@ -0,0 +1,98 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "emulator/ram_write_tracker.h"
+
+namespace chip8 {
+
+RamWriteTracker::RamWriteTracker() { reset(); }
+
+void RamWriteTracker::markAll() { m_dirty.fill(~uint64_t(0)); }
+
+RamWriteTracker::epoch_t RamWriteTracker::checkpoint() {
+  // Only the written bytes are stamped, the cost follows the number of writes
+  const epoch_t stamp = m_epoch + 1;
+  for (std::size_t page = 0; page < N_PAGES; ++page) {
+    uint64_t bytes = m_dirty[page];
+    if (bytes == 0) {
+      continue;
+    }
+
+    m_page_stamps[page] = stamp;
+    while (bytes != 0) {
+      const std::size_t offset = __builtin_ctzll(bytes);
+      m_byte_stamps[page * PAGE_SIZE + offset] = stamp;
+      bytes &= bytes - 1;
+    }
+    m_dirty[page] = 0;
+  }
+
+  return ++m_epoch;
+}
+
+void RamWriteTracker::reset() {
+  m_dirty.fill(0);
+  m_byte_stamps.fill(0);
+  m_page_stamps.fill(0);
+  m_epoch = 0;
+}
+
+uint64_t RamWriteTracker::getDirtyPages() const {
+  uint64_t pages = 0;
+  for (std::size_t page = 0; page < N_PAGES; ++page) {
+    pages |= static_cast<uint64_t>(m_dirty[page] != 0) << page;
+  }
+  return pages;
+}
+
+uint64_t RamWriteTracker::getDirtyPagesSince(epoch_t epoch) const {
+  uint64_t pages = getDirtyPages();
+  for (std::size_t page = 0; page < N_PAGES; ++page) {
+    pages |= static_cast<uint64_t>(m_page_stamps[page] > epoch) << page;
+  }
+  return pages;
+}
+
+bool RamWriteTracker::isRangeDirtySince(epoch_t epoch, std::size_t address,
+                                        std::size_t size) const {
+  for (std::size_t i = 0; i < size; ++i) {
+    const std::size_t byte = wrapAddress(address + i);
+
+    // Skip the pages which were not written at all
+    const std::size_t page = byte / PAGE_SIZE;
+    if (m_dirty[page] == 0 && m_page_stamps[page] <= epoch) {
+      i += PAGE_SIZE - 1 - byte % PAGE_SIZE;
+      continue;
+    }
+
+    if (isDirtySince(epoch, byte)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace chip8
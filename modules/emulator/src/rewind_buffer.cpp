@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "emulator/rewind_buffer.h"
+
+namespace chip8 {
+
+static const std::size_t PIXELS_PER_BYTE = 8;
+
+// pc, index, stack pointer, timers, V0-VF, stack, random number generator,
+// RAM, display bit packed
+static const std::size_t PACKED_STATE_SIZE =
+    2 + 2 + 1 + 1 + 1 + GeneralRegisters::size() + 2 * Stack::size() +
+    sizeof(RandomState) + RAM::size() +
+    DISPLAY_WIDTH * DISPLAY_HEIGHT / PIXELS_PER_BYTE;
+
+// A record is a sequence of (zeros count, literals count, literals) with
+// varint counts, a run of literals only stops on three zeros so that the
+// encoding grows by a few bytes at most
+static const std::size_t MIN_ZERO_RUN = 3;
+static const std::size_t MAX_RECORD_SIZE = PACKED_STATE_SIZE + 8;
+
+static const uint64_t NO_KEYFRAME = std::numeric_limits<uint64_t>::max();
+
+// The RAM follows the registers, the stack and the random number generator
+static const std::size_t PACKED_RAM_OFFSET =
+    2 + 2 + 1 + 1 + 1 + GeneralRegisters::size() + 2 * Stack::size() +
+    sizeof(RandomState);
+
+static void packState(const MachineState& state, uint8_t* packed) {
+  *packed++ = static_cast<uint8_t>(state.pc & 0xFF);
+  *packed++ = static_cast<uint8_t>(state.pc >> 8);
+  *packed++ = static_cast<uint8_t>(state.index_reg & 0xFF);
+  *packed++ = static_cast<uint8_t>(state.index_reg >> 8);
+  *packed++ = state.stack_ptr;
+  *packed++ = state.delay_timer_reg;
+  *packed++ = state.sound_timer_reg;
+  for (const auto& reg : state.registers) {
+    *packed++ = reg;
+  }
+  for (auto address : state.stack) {
+    *packed++ = static_cast<uint8_t>(address & 0xFF);
+    *packed++ = static_cast<uint8_t>(address >> 8);
+  }
+  std::memcpy(packed, &state.random_state, sizeof(RandomState));
+  packed += sizeof(RandomState);
+  packed = std::copy(state.ram.begin(), state.ram.end(), packed);
+
+  std::fill(packed, packed + state.framebuffer.size() / PIXELS_PER_BYTE, 0);
+  for (std::size_t i = 0; i < state.framebuffer.size(); ++i) {
+    packed[i / PIXELS_PER_BYTE] |= static_cast<uint8_t>(
+        (state.framebuffer[i] & 0x1) << (7 - i % PIXELS_PER_BYTE));
+  }
+}
+
+static void unpackState(const uint8_t* packed, MachineState& state) {
+  state.pc = static_cast<uint16_t>(packed[0] | packed[1] << 8);
+  state.index_reg = static_cast<uint16_t>(packed[2] | packed[3] << 8);
+  state.stack_ptr = packed[4];
+  state.delay_timer_reg = packed[5];
+  state.sound_timer_reg = packed[6];
+  packed += 7;
+  for (auto& reg : state.registers) {
+    reg = *packed++;
+  }
+  for (auto& address : state.stack) {
+    address = static_cast<uint16_t>(packed[0] | packed[1] << 8);
+    packed += 2;
+  }
+  std::memcpy(&state.random_state, packed, sizeof(RandomState));
+  packed += sizeof(RandomState);
+  std::copy(packed, packed + RAM::size(), state.ram.begin());
+  packed += RAM::size();
+
+  for (std::size_t i = 0; i < state.framebuffer.size(); ++i) {
+    state.framebuffer[i] =
+        (packed[i / PIXELS_PER_BYTE] >> (7 - i % PIXELS_PER_BYTE)) & 0x1;
+  }
+}
+
+static void writeVarint(std::vector<uint8_t>& record, std::size_t value) {
+  while (value >= 0x80) {
+    record.push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  record.push_back(static_cast<uint8_t>(value));
+}
+
+static std::size_t readVarint(const uint8_t*& data) {
+  std::size_t value = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = *data++;
+    value |= static_cast<std::size_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return value;
+    }
+  }
+}
+
+/*!
+ * Encode the XOR of the packed state with the reference, a null reference
+ * being all zeros. The RAM pages set in clean_pages are known to be equal in
+ * both and are skipped without being compared.
+ */
+static void encodeRecord(const uint8_t* packed, const uint8_t* reference,
+                         uint64_t clean_pages, std::vector<uint8_t>& record) {
+  auto delta = [packed, reference](std::size_t i) {
+    return reference ? static_cast<uint8_t>(packed[i] ^ reference[i])
+                     : packed[i];
+  };
+
+  record.clear();
+  std::size_t position = 0;
+  while (position < PACKED_STATE_SIZE) {
+    std::size_t zeros = 0;
+    while (position + zeros < PACKED_STATE_SIZE) {
+      const std::size_t ram_address = position + zeros - PACKED_RAM_OFFSET;
+      if (position + zeros >= PACKED_RAM_OFFSET &&
+          ram_address < RAM::size() &&
+          ram_address % RamWriteTracker::PAGE_SIZE == 0 &&
+          (clean_pages >> (ram_address / RamWriteTracker::PAGE_SIZE)) & 0x1) {
+        zeros += RamWriteTracker::PAGE_SIZE;
+      } else if (delta(position + zeros) == 0) {
+        ++zeros;
+      } else {
+        break;
+      }
+    }
+    position += zeros;
+
+    std::size_t length = 0;
+    std::size_t trailing_zeros = 0;
+    while (position + length < PACKED_STATE_SIZE &&
+           trailing_zeros < MIN_ZERO_RUN) {
+      trailing_zeros = delta(position + length) == 0 ? trailing_zeros + 1 : 0;
+      ++length;
+    }
+    length -= trailing_zeros;
+
+    writeVarint(record, zeros);
+    writeVarint(record, length);
+    for (std::size_t i = 0; i < length; ++i) {
+      record.push_back(delta(position + i));
+    }
+    position += length;
+  }
+}
+
+static void decodeRecord(const uint8_t* record, std::size_t size,
+                         const uint8_t* reference, uint8_t* packed) {
+  if (reference) {
+    std::memcpy(packed, reference, PACKED_STATE_SIZE);
+  } else {
+    std::memset(packed, 0, PACKED_STATE_SIZE);
+  }
+
+  const uint8_t* end = record + size;
+  std::size_t position = 0;
+  while (record < end) {
+    position += readVarint(record);
+    std::size_t length = readVarint(record);
+    for (std::size_t i = 0; i < length; ++i) {
+      packed[position++] ^= *record++;
+    }
+  }
+}
+
+RewindBuffer::RewindBuffer(std::size_t max_frames, std::size_t storage_size,
+                           std::size_t keyframe_interval)
+    : m_entries(max_frames),
+      m_storage(storage_size),
+      m_keyframe_interval(keyframe_interval),
+      m_first_frame(0),
+      m_size(0),
+      m_head(0),
+      m_keyframe_frame(NO_KEYFRAME),
+      m_keyframe_epoch(),
+      m_keyframe(PACKED_STATE_SIZE),
+      m_packed(PACKED_STATE_SIZE) {
+  if (max_frames == 0 || storage_size < 2 * MAX_RECORD_SIZE ||
+      storage_size > std::numeric_limits<uint32_t>::max()) {
+    throw std::invalid_argument("invalid rewind buffer size");
+  }
+  if (keyframe_interval == 0 ||
+      keyframe_interval > std::numeric_limits<uint16_t>::max()) {
+    throw std::invalid_argument("invalid keyframe interval");
+  }
+
+  // Encoding never allocates once the buffer is constructed
+  m_record.reserve(MAX_RECORD_SIZE);
+}
+
+void RewindBuffer::push(const MachineState& state) { push(state, nullptr); }
+
+void RewindBuffer::push(const MachineState& state,
+                        RamWriteTracker& ram_writes) {
+  push(state, &ram_writes);
+}
+
+void RewindBuffer::push(const MachineState& state,
+                        RamWriteTracker* ram_writes) {
+  packState(state, m_packed.data());
+
+  if (m_size == m_entries.size()) {
+    evictOldest();
+  }
+
+  const uint64_t frame = m_first_frame + m_size;
+  bool is_keyframe = m_size == 0 ||
+                     frame - m_keyframe_frame >= m_keyframe_interval;
+  // The pages not written since the keyframe are equal to the keyframe
+  const uint64_t clean_pages =
+      !is_keyframe && ram_writes && m_keyframe_epoch
+          ? ~ram_writes->getDirtyPagesSince(*m_keyframe_epoch)
+          : 0;
+  encodeRecord(m_packed.data(), is_keyframe ? nullptr : m_keyframe.data(),
+               clean_pages, m_record);
+  std::size_t offset = allocate(m_record.size());
+
+  // Making room may have dropped the keyframe of the delta
+  if (!is_keyframe && m_keyframe_frame < m_first_frame) {
+    is_keyframe = true;
+    encodeRecord(m_packed.data(), nullptr, 0, m_record);
+    offset = allocate(m_record.size());
+  }
+
+  std::copy(m_record.begin(), m_record.end(), m_storage.begin() + offset);
+  entryOf(frame) = Entry{
+      static_cast<uint32_t>(offset), static_cast<uint16_t>(m_record.size()),
+      static_cast<uint16_t>(is_keyframe ? 0 : frame - m_keyframe_frame)};
+  m_head = offset + m_record.size();
+  ++m_size;
+
+  if (is_keyframe) {
+    m_keyframe.swap(m_packed);
+    m_keyframe_frame = frame;
+    m_keyframe_epoch = ram_writes ? std::optional<RamWriteTracker::epoch_t>(
+                                        ram_writes->checkpoint())
+                                  : std::nullopt;
+  }
+}
+
+bool RewindBuffer::stepBack(MachineState& state) {
+  if (m_size < 2) {
+    return false;
+  }
+
+  // The storage of the dropped frame is reused by the next push
+  --m_size;
+  const uint64_t frame = m_first_frame + m_size - 1;
+  const Entry& entry = entryOf(frame);
+  m_head = entry.offset + entry.size;
+
+  loadKeyframe(frame - entry.keyframe_distance);
+  if (entry.keyframe_distance == 0) {
+    unpackState(m_keyframe.data(), state);
+  } else {
+    decodeRecord(m_storage.data() + entry.offset, entry.size,
+                 m_keyframe.data(), m_packed.data());
+    unpackState(m_packed.data(), state);
+  }
+
+  return true;
+}
+
+void RewindBuffer::clear() {
+  m_first_frame = 0;
+  m_size = 0;
+  m_head = 0;
+  m_keyframe_frame = NO_KEYFRAME;
+  m_keyframe_epoch.reset();
+}
+
+std::size_t RewindBuffer::memoryUsage() const {
+  return m_entries.size() * sizeof(Entry) + m_storage.size() +
+         m_keyframe.size() + m_packed.size() + m_record.capacity();
+}
+
+std::size_t RewindBuffer::allocate(std::size_t size) {
+  if (m_size == 0) {
+    m_head = 0;
+  }
+
+  // Records are contiguous, the end of the storage is skipped when too small
+  // which drops the oldest records stored there
+  if (m_head + size > m_storage.size()) {
+    while (m_size > 0 && entryOf(m_first_frame).offset >= m_head) {
+      evictOldest();
+    }
+    m_head = 0;
+  }
+
+  while (m_size > 0 && entryOf(m_first_frame).offset >= m_head &&
+         entryOf(m_first_frame).offset < m_head + size) {
+    evictOldest();
+  }
+
+  return m_head;
+}
+
+void RewindBuffer::evictOldest() {
+  // Deltas are useless without their keyframe so the buffer always starts
+  // with a keyframe
+  do {
+    ++m_first_frame;
+    --m_size;
+  } while (m_size > 0 && entryOf(m_first_frame).keyframe_distance != 0);
+}
+
+void RewindBuffer::loadKeyframe(uint64_t frame) {
+  if (m_keyframe_frame == frame) {
+    return;
+  }
+
+  const Entry& entry = entryOf(frame);
+  decodeRecord(m_storage.data() + entry.offset, entry.size, nullptr,
+               m_keyframe.data());
+  m_keyframe_frame = frame;
+  // The writes are only known since the last keyframe pushed
+  m_keyframe_epoch.reset();
+}
+
+}  // namespace chip8
@@ -23,33 +23,120 @@
  * SOFTWARE.
  */
 
-#include "emulator/rom_loader.h"
-
+// std
 #include <algorithm>
-#include <iterator>
+#include <cerrno>
+#include <cstring>
+
+// posix
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "emulator/rom_loader.h"
 
 namespace chip8 {
 
-bool loadProgramFromStream(RAM& ram, std::istream& input_stream) {
-  if (input_stream) {
-    // Get length of file:
-    input_stream.seekg (0, std::istream::end);
-    int length = input_stream.tellg();
-    input_stream.seekg (0, std::istream::beg);
+extern const std::size_t PROGRAM_START_ADDRESS = 0x200;
+extern const std::size_t MAX_PROGRAM_SIZE =
+    RAM::size() - PROGRAM_START_ADDRESS;
+
+// Largest read issued to a stream or a file descriptor
+static const std::size_t READ_CHUNK_SIZE = 512;
+
+static RomLoadResult success(std::size_t size) {
+  return RomLoadResult{true, size, ""};
+}
+
+static RomLoadResult failure(std::size_t size, const std::string& error) {
+  return RomLoadResult{false, size, error};
+}
+
+static RomLoadResult tooLarge(std::size_t size) {
+  return failure(size, "program larger than " +
+                           std::to_string(MAX_PROGRAM_SIZE) + " bytes");
+}
+
+RomLoadResult loadProgramFromStream(RAM& ram, std::istream& input_stream) {
+  if (!input_stream) {
+    return failure(0, "cannot read program");
+  }
+
+  uint8_t* program = ram.data() + PROGRAM_START_ADDRESS;
+  std::size_t size = 0;
+  while (size < MAX_PROGRAM_SIZE) {
+    const std::size_t n_requested =
+        std::min(READ_CHUNK_SIZE, MAX_PROGRAM_SIZE - size);
+    input_stream.read(reinterpret_cast<char*>(program + size),
+                      static_cast<std::streamsize>(n_requested));
+    size += static_cast<std::size_t>(input_stream.gcount());
+    if (!input_stream) {
+      break;
+    }
+  }
+
+  if (input_stream.bad()) {
+    return failure(size, "cannot read program");
+  }
 
-    std::cout << length;
+  // A full RAM is only valid if the program ends there
+  if (size == MAX_PROGRAM_SIZE &&
+      input_stream.peek() != std::istream::traits_type::eof()) {
+    return tooLarge(size);
+  }
 
-    char * buffer = new char [length];
-    input_stream.read (buffer,length);
+  return success(size);
+}
 
-    // TODO: move memory to avoid huge copy
-    std::copy(buffer, buffer+length, ram.begin() + 0x200);
+static RomLoadResult readProgram(RAM& ram, int fd) {
+  uint8_t* program = ram.data() + PROGRAM_START_ADDRESS;
+  std::size_t size = 0;
+  while (true) {
+    // One more byte than the RAM can hold tells a program that is too large
+    uint8_t extra_byte;
+    uint8_t* destination = size < MAX_PROGRAM_SIZE ? program + size
+                                                   : &extra_byte;
+    const std::size_t n_requested =
+        size < MAX_PROGRAM_SIZE
+            ? std::min(READ_CHUNK_SIZE, MAX_PROGRAM_SIZE - size)
+            : 1;
+    const ssize_t n_read = ::read(fd, destination, n_requested);
+    if (n_read < 0 && errno == EINTR) {
+      continue;
+    } else if (n_read < 0) {
+      return failure(size, std::string("cannot read program: ") +
+                               std::strerror(errno));
+    } else if (n_read == 0) {
+      return success(size);
+    } else if (size == MAX_PROGRAM_SIZE) {
+      return tooLarge(size);
+    }
+    size += static_cast<std::size_t>(n_read);
+  }
+}
 
-    delete[] buffer;
+RomLoadResult loadProgramFromFile(RAM& ram, const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return failure(0, "cannot open " + path + ": " + std::strerror(errno));
+  }
 
-    return true;
+  struct stat status;
+  RomLoadResult result;
+  if (::fstat(fd, &status) != 0) {
+    result = failure(0, std::string("cannot stat program: ") +
+                            std::strerror(errno));
+  } else if (S_ISREG(status.st_mode) &&
+             static_cast<std::size_t>(status.st_size) > MAX_PROGRAM_SIZE) {
+    // Rejected before touching the RAM
+    result = tooLarge(0);
+  } else {
+    // A file truncated meanwhile only gives a shorter read, unlike a mapping
+    result = readProgram(ram, fd);
   }
 
-  return false;
+  ::close(fd);
+  return result;
 }
+
 }  // namespace chip8
@@ -0,0 +1,88 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+
+#include "emulator/run_ahead.h"
+
+namespace chip8 {
+
+extern const std::size_t MAX_RUN_AHEAD_FRAMES = 8;
+
+static const double FRAME_DURATION_NS = 1e9 / 60;
+// Weight of the last frame in the average cost
+static const double COST_SMOOTHING = 1.0 / 16;
+
+RunAhead::RunAhead(Emulator& emulator, BitmaskUserInputController& keypad,
+                   std::size_t n_frames)
+    : m_emulator(emulator),
+      m_keypad(keypad),
+      m_n_frames(std::min(n_frames, MAX_RUN_AHEAD_FRAMES)),
+      m_saved_state(std::make_unique<MachineState>()),
+      m_presented(emulator.getState().framebuffer),
+      m_presented_model(m_presented),
+      m_average_cost(0) {}
+
+void RunAhead::runFrame(uint16_t keys) {
+  m_keypad.setKeys(keys);
+  m_emulator.runFrame();
+
+  if (m_n_frames == 0) {
+    present();
+    return;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  *m_saved_state = m_emulator.getState();
+  const uint64_t memory_hash = m_emulator.getMemoryHash();
+  m_emulator.setSpeculative(true);
+  for (std::size_t frame = 0; frame < m_n_frames; ++frame) {
+    m_emulator.runFrame();
+  }
+  present();
+  m_emulator.restoreState(*m_saved_state, memory_hash);
+  m_emulator.setSpeculative(false);
+
+  const std::chrono::duration<double, std::nano> cost =
+      std::chrono::steady_clock::now() - start;
+  m_average_cost += COST_SMOOTHING * (cost.count() - m_average_cost);
+}
+
+void RunAhead::present() { m_presented = m_emulator.getState().framebuffer; }
+
+void RunAhead::setFrames(std::size_t n_frames) {
+  m_n_frames = std::min(n_frames, MAX_RUN_AHEAD_FRAMES);
+  if (m_n_frames == 0) {
+    m_average_cost = 0;
+  }
+}
+
+double RunAhead::getFrameBudgetUsage() const {
+  return m_average_cost / FRAME_DURATION_NS;
+}
+
+}  // namespace chip8
@@ -0,0 +1,337 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include "emulator/little_endian.h"
+#include "emulator/save_state.h"
+#include "emulator/state_hash.h"
+
+namespace chip8 {
+
+const uint32_t SAVE_STATE_MAGIC = 0x53533843;  // "C8SS"
+const uint16_t SAVE_STATE_VERSION = 2;
+
+// A control byte with the MSB set is followed by nothing and stands for
+// (control & 0x7F) + 1 zero bytes, otherwise it is followed by control + 1
+// literal bytes
+static const uint8_t ZERO_RUN_FLAG = 0x80;
+static const std::size_t MAX_RUN_LENGTH = 128;
+static const std::size_t PIXELS_PER_BYTE = 8;
+static const std::size_t CHECKSUM_SIZE = sizeof(uint64_t);
+
+static void encodeRuns(const uint8_t* data, std::size_t size,
+                       std::vector<uint8_t>& buffer) {
+  std::size_t position = 0;
+  while (position < size) {
+    std::size_t zeros = 0;
+    while (position + zeros < size && data[position + zeros] == 0 &&
+           zeros < MAX_RUN_LENGTH) {
+      ++zeros;
+    }
+
+    // A single zero is cheaper inside a literal run
+    if (zeros > 1) {
+      buffer.push_back(static_cast<uint8_t>(ZERO_RUN_FLAG | (zeros - 1)));
+      position += zeros;
+      continue;
+    }
+
+    std::size_t length = 1;
+    while (position + length < size && length < MAX_RUN_LENGTH &&
+           !(data[position + length] == 0 && position + length + 1 < size &&
+             data[position + length + 1] == 0)) {
+      ++length;
+    }
+    buffer.push_back(static_cast<uint8_t>(length - 1));
+    buffer.insert(buffer.end(), data + position, data + position + length);
+    position += length;
+  }
+}
+
+/*!
+ * Bounds checked reading of an encoded save state
+ */
+class SaveStateReader {
+ public:
+  SaveStateReader(const uint8_t* data, std::size_t size)
+      : m_data(data), m_size(size), m_position(0) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (m_size - m_position < sizeof(T)) {
+      return false;
+    }
+    value = readValue<T>(m_data + m_position);
+    m_position += sizeof(T);
+    return true;
+  }
+
+  bool readRuns(uint8_t* data, std::size_t size) {
+    std::size_t position = 0;
+    while (position < size) {
+      uint8_t control = 0;
+      if (!read(control)) {
+        return false;
+      }
+
+      std::size_t length = (control & ~ZERO_RUN_FLAG) + 1;
+      if (position + length > size) {
+        return false;
+      }
+
+      if (control & ZERO_RUN_FLAG) {
+        std::fill(data + position, data + position + length, 0);
+      } else {
+        if (m_position + length > m_size) {
+          return false;
+        }
+        std::copy(m_data + m_position, m_data + m_position + length,
+                  data + position);
+        m_position += length;
+      }
+      position += length;
+    }
+
+    return true;
+  }
+
+  std::size_t getPosition() const { return m_position; }
+
+ private:
+  const uint8_t* m_data;
+  std::size_t m_size;
+  std::size_t m_position;
+};
+
+std::vector<uint8_t> encodeSaveState(const MachineState& state,
+                                     const RAM& reference) {
+  std::vector<uint8_t> buffer;
+  buffer.reserve(512);
+
+  appendValue(buffer, SAVE_STATE_MAGIC);
+  appendValue(buffer, SAVE_STATE_VERSION);
+  appendValue<uint16_t>(buffer, state.pc);
+  appendValue<uint16_t>(buffer, state.index_reg);
+  buffer.push_back(state.stack_ptr);
+  buffer.push_back(state.delay_timer_reg);
+  buffer.push_back(state.sound_timer_reg);
+  for (const auto& reg : state.registers) {
+    buffer.push_back(reg);
+  }
+  for (auto address : state.stack) {
+    appendValue(buffer, address);
+  }
+  appendValue(buffer, state.random_state.state);
+  appendValue(buffer, state.random_state.increment);
+
+  RAM delta;
+  for (std::size_t i = 0; i < RAM::size(); ++i) {
+    delta[i] = state.ram[i] ^ reference[i];
+  }
+  encodeRuns(delta.data(), delta.size(), buffer);
+
+  std::array<uint8_t, DISPLAY_WIDTH * DISPLAY_HEIGHT / PIXELS_PER_BYTE>
+      pixels{};
+  for (std::size_t i = 0; i < state.framebuffer.size(); ++i) {
+    pixels[i / PIXELS_PER_BYTE] |= static_cast<uint8_t>(
+        (state.framebuffer[i] & 0x1) << (7 - i % PIXELS_PER_BYTE));
+  }
+  encodeRuns(pixels.data(), pixels.size(), buffer);
+
+  appendValue(buffer, hashBytes(buffer.data(), buffer.size()));
+  return buffer;
+}
+
+bool decodeSaveState(const uint8_t* data, std::size_t size,
+                     const RAM& reference, MachineState& state) {
+  if (size < CHECKSUM_SIZE) {
+    return false;
+  }
+
+  // Reject corrupted buffers before parsing them
+  if (readValue<uint64_t>(data + size - CHECKSUM_SIZE) !=
+      hashBytes(data, size - CHECKSUM_SIZE)) {
+    return false;
+  }
+
+  SaveStateReader reader(data, size - CHECKSUM_SIZE);
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  if (!reader.read(magic) || magic != SAVE_STATE_MAGIC ||
+      !reader.read(version) || version != SAVE_STATE_VERSION) {
+    return false;
+  }
+
+  MachineState decoded;
+  uint16_t pc = 0;
+  uint16_t index_reg = 0;
+  uint8_t stack_ptr = 0;
+  uint8_t delay_timer = 0;
+  uint8_t sound_timer = 0;
+  if (!reader.read(pc) || !reader.read(index_reg) ||
+      !reader.read(stack_ptr) || !reader.read(delay_timer) ||
+      !reader.read(sound_timer) || stack_ptr >= Stack::size()) {
+    return false;
+  }
+  decoded.pc = pc;
+  decoded.index_reg = index_reg;
+  decoded.stack_ptr = stack_ptr;
+  decoded.delay_timer_reg = delay_timer;
+  decoded.sound_timer_reg = sound_timer;
+
+  for (auto& reg : decoded.registers) {
+    if (!reader.read<uint8_t>(reg)) {
+      return false;
+    }
+  }
+  for (auto& address : decoded.stack) {
+    if (!reader.read(address)) {
+      return false;
+    }
+  }
+  if (!reader.read(decoded.random_state.state) ||
+      !reader.read(decoded.random_state.increment)) {
+    return false;
+  }
+
+  if (!reader.readRuns(decoded.ram.data(), decoded.ram.size())) {
+    return false;
+  }
+  for (std::size_t i = 0; i < RAM::size(); ++i) {
+    decoded.ram[i] ^= reference[i];
+  }
+
+  std::array<uint8_t, DISPLAY_WIDTH * DISPLAY_HEIGHT / PIXELS_PER_BYTE>
+      pixels{};
+  if (!reader.readRuns(pixels.data(), pixels.size())) {
+    return false;
+  }
+  for (std::size_t i = 0; i < decoded.framebuffer.size(); ++i) {
+    decoded.framebuffer[i] =
+        (pixels[i / PIXELS_PER_BYTE] >> (7 - i % PIXELS_PER_BYTE)) & 0x1;
+  }
+
+  // Trailing bytes mean the buffer is not what was encoded
+  if (reader.getPosition() != size - CHECKSUM_SIZE) {
+    return false;
+  }
+
+  state = decoded;
+  return true;
+}
+
+bool loadSaveState(std::istream& input_stream, const RAM& reference,
+                   MachineState& state) {
+  if (!input_stream) {
+    return false;
+  }
+
+  std::vector<uint8_t> buffer((std::istreambuf_iterator<char>(input_stream)),
+                              std::istreambuf_iterator<char>());
+  return decodeSaveState(buffer.data(), buffer.size(), reference, state);
+}
+
+SaveStateWriter::SaveStateWriter(const RAM& reference)
+    : m_reference(reference),
+      m_busy(false),
+      m_stopping(false),
+      m_n_failures(0),
+      m_thread(&SaveStateWriter::run, this) {}
+
+SaveStateWriter::~SaveStateWriter() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_pending_condition.notify_one();
+  m_thread.join();
+}
+
+void SaveStateWriter::write(const MachineState& state, std::string path) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.emplace_back(state, std::move(path));
+  }
+  m_pending_condition.notify_one();
+}
+
+void SaveStateWriter::flush() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_written_condition.wait(lock,
+                           [this] { return m_pending.empty() && !m_busy; });
+}
+
+std::size_t SaveStateWriter::countFailures() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_n_failures;
+}
+
+void SaveStateWriter::run() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true) {
+    m_pending_condition.wait(
+        lock, [this] { return m_stopping || !m_pending.empty(); });
+    if (m_pending.empty()) {
+      return;
+    }
+
+    auto pending = std::move(m_pending.front());
+    m_pending.pop_front();
+    m_busy = true;
+    lock.unlock();
+
+    // Write to a temporary file first so that an existing save state is never
+    // left half written
+    auto buffer = encodeSaveState(pending.first, m_reference);
+    const std::string temporary_path = pending.second + ".tmp";
+    bool success = false;
+    {
+      std::ofstream file(temporary_path, std::ios_base::binary);
+      file.write(reinterpret_cast<const char*>(buffer.data()),
+                 static_cast<std::streamsize>(buffer.size()));
+      success = static_cast<bool>(file);
+    }
+    success = success &&
+              std::rename(temporary_path.c_str(), pending.second.c_str()) == 0;
+    if (!success) {
+      std::remove(temporary_path.c_str());
+    }
+
+    lock.lock();
+    if (!success) {
+      ++m_n_failures;
+    }
+    m_busy = false;
+    m_written_condition.notify_all();
+  }
+}
+
+}  // namespace chip8
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "emulator/snapshot_publisher.h"
+
+namespace chip8 {
+
+static_assert(std::is_trivially_copyable<Snapshot>::value,
+              "Snapshot is copied word by word");
+
+SnapshotPublisher::SnapshotPublisher() : m_sequence(0) {
+  for (auto& word : m_words) {
+    word.store(0, std::memory_order_relaxed);
+  }
+}
+
+void SnapshotPublisher::publish(uint64_t frame, const MachineState& state) {
+  // Laid out as a Snapshot
+  std::array<uint64_t, N_WORDS> words{};
+  auto* bytes = reinterpret_cast<uint8_t*>(words.data());
+  std::memcpy(bytes + offsetof(Snapshot, frame), &frame, sizeof(frame));
+  std::memcpy(bytes + offsetof(Snapshot, state), &state, sizeof(MachineState));
+
+  const uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+  m_sequence.store(sequence + 1, std::memory_order_relaxed);
+  // The odd sequence is visible before any word is modified
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (std::size_t i = 0; i < N_WORDS; ++i) {
+    m_words[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool SnapshotPublisher::tryRead(Snapshot& snapshot) const {
+  const uint64_t sequence = m_sequence.load(std::memory_order_acquire);
+  if (sequence % 2 != 0) {
+    return false;
+  }
+
+  std::array<uint64_t, N_WORDS> words;
+  for (std::size_t i = 0; i < N_WORDS; ++i) {
+    words[i] = m_words[i].load(std::memory_order_relaxed);
+  }
+
+  // The words are read before the sequence is checked again
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (m_sequence.load(std::memory_order_relaxed) != sequence) {
+    return false;
+  }
+
+  // Laid out by publish()
+  const auto* bytes = reinterpret_cast<const uint8_t*>(words.data());
+  std::memcpy(&snapshot.frame, bytes + offsetof(Snapshot, frame),
+              sizeof(snapshot.frame));
+  std::memcpy(static_cast<void*>(&snapshot.state),
+              bytes + offsetof(Snapshot, state), sizeof(MachineState));
+  return true;
+}
+
+bool SnapshotPublisher::read(Snapshot& snapshot) const {
+  if (countPublications() == 0) {
+    return false;
+  }
+
+  while (!tryRead(snapshot)) {
+    std::this_thread::yield();
+  }
+  return true;
+}
+
+}  // namespace chip8
@@ -0,0 +1,345 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// posix
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "emulator/emulator.h"
+#include "emulator/save_state.h"
+#include "emulator/state_corpus.h"
+#include "emulator/state_hash.h"
+
+namespace chip8 {
+
+// "C8SC" in a little endian file
+extern const uint32_t STATE_CORPUS_MAGIC = 0x43533843;
+extern const std::size_t STATE_CORPUS_DEFAULT_MAX_RECORDS = 1 << 22;
+
+static const std::size_t HEADER_SIZE = 64;
+// Records start on a cache line
+static const std::size_t RECORD_STRIDE = (sizeof(StateRecord) + 63) / 64 * 64;
+static const std::size_t GROWTH_RECORDS = 1024;
+// The index starts with the identifier of the corpus it belongs to
+static const std::size_t INDEX_HEADER_SIZE = sizeof(uint64_t);
+
+struct StateCorpus::Header {
+  uint32_t magic;
+  // The states follow the save state versions
+  uint16_t version;
+  uint16_t padding;
+  uint32_t record_size;
+  uint32_t padding_2;
+  // Changes when the corpus is rewritten, ties the index to the records
+  uint64_t identifier;
+  std::atomic<uint64_t> n_records;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the record count is shared between processes");
+static_assert(sizeof(StateRecord) % alignof(StateRecord) == 0 &&
+                  RECORD_STRIDE % alignof(StateRecord) == 0,
+              "records must be aligned in the mapping");
+
+static std::string indexPath(const std::string& path) { return path + ".idx"; }
+
+static bool writeAll(int fd, const void* data, std::size_t size, off_t offset) {
+  return ::pwrite(fd, data, size, offset) == static_cast<ssize_t>(size);
+}
+
+StateCorpus::StateCorpus()
+    : m_fd(-1),
+      m_index_fd(-1),
+      m_writable(false),
+      m_mapping(nullptr),
+      m_mapping_size(0),
+      m_header(nullptr),
+      m_max_records(0),
+      m_n_reserved(0),
+      m_n_indexed(0) {}
+
+StateCorpus::~StateCorpus() { close(); }
+
+bool StateCorpus::open(const std::string& path, bool writable,
+                       std::size_t max_records) {
+  close();
+
+  m_fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  m_index_fd = ::open(indexPath(path).c_str(),
+                      writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+  // A single process appends
+  if (m_fd < 0 || m_index_fd < 0 ||
+      (writable && ::flock(m_fd, LOCK_EX | LOCK_NB) != 0)) {
+    close();
+    return false;
+  }
+
+  struct stat file_status {};
+  if (::fstat(m_fd, &file_status) != 0) {
+    close();
+    return false;
+  }
+
+  std::size_t file_size = file_status.st_size;
+  if (file_size == 0 && writable) {
+    Header header{};
+    header.magic = STATE_CORPUS_MAGIC;
+    header.version = SAVE_STATE_VERSION;
+    header.record_size = sizeof(StateRecord);
+    header.identifier = (static_cast<uint64_t>(std::random_device()()) << 32) |
+                        std::random_device()();
+    if (::ftruncate(m_fd, HEADER_SIZE) != 0 ||
+        !writeAll(m_fd, &header, sizeof(Header), 0) ||
+        ::ftruncate(m_index_fd, 0) != 0 ||
+        !writeAll(m_index_fd, &header.identifier, INDEX_HEADER_SIZE, 0)) {
+      close();
+      return false;
+    }
+    file_size = HEADER_SIZE;
+  }
+
+  if (file_size < HEADER_SIZE) {
+    close();
+    return false;
+  }
+
+  // Map the room for every record once so that the records never move
+  m_mapping_size = HEADER_SIZE + max_records * RECORD_STRIDE;
+  void* mapping =
+      ::mmap(nullptr, m_mapping_size, PROT_READ | (writable ? PROT_WRITE : 0),
+             MAP_SHARED | MAP_NORESERVE, m_fd, 0);
+  if (mapping == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  m_mapping = static_cast<uint8_t*>(mapping);
+  m_header = reinterpret_cast<Header*>(m_mapping);
+  m_writable = writable;
+  m_max_records = max_records;
+  m_n_reserved = (file_size - HEADER_SIZE) / RECORD_STRIDE;
+
+  if (m_header->magic != STATE_CORPUS_MAGIC ||
+      m_header->version != SAVE_STATE_VERSION ||
+      m_header->record_size != sizeof(StateRecord) ||
+      countPublished() > m_n_reserved) {
+    close();
+    return false;
+  }
+
+  refresh();
+  return true;
+}
+
+void StateCorpus::close() {
+  if (m_mapping) {
+    ::munmap(m_mapping, m_mapping_size);
+  }
+  if (m_index_fd >= 0) {
+    ::close(m_index_fd);
+  }
+  // Releases the lock of the writer
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+
+  m_fd = -1;
+  m_index_fd = -1;
+  m_writable = false;
+  m_mapping = nullptr;
+  m_mapping_size = 0;
+  m_header = nullptr;
+  m_max_records = 0;
+  m_n_reserved = 0;
+
+  std::unique_lock<std::shared_mutex> lock(m_index_mutex);
+  m_index.clear();
+  m_n_indexed = 0;
+}
+
+std::size_t StateCorpus::size() const {
+  // The records past the mapping of this process are not visible
+  return std::min(countPublished(), m_max_records);
+}
+
+std::optional<std::size_t> StateCorpus::append(const MachineState& state,
+                                               uint64_t memory_hash) {
+  if (!m_writable) {
+    return std::nullopt;
+  }
+
+  const uint64_t state_hash = combineStateHash(state, memory_hash);
+  if (auto index = find(state_hash)) {
+    return index;
+  }
+
+  const std::size_t index = size();
+  if (index >= m_max_records || !reserve(index + 1)) {
+    return std::nullopt;
+  }
+
+  // Readers do not look at the record before the count is incremented
+  auto& new_record = *reinterpret_cast<StateRecord*>(
+      m_mapping + HEADER_SIZE + index * RECORD_STRIDE);
+  new_record.state_hash = state_hash;
+  new_record.memory_hash = memory_hash;
+  std::memcpy(&new_record.state, &state, sizeof(MachineState));
+
+  if (!writeAll(m_index_fd, &state_hash, sizeof(state_hash),
+                INDEX_HEADER_SIZE + index * sizeof(state_hash))) {
+    return std::nullopt;
+  }
+
+  m_header->n_records.store(index + 1, std::memory_order_release);
+
+  std::unique_lock<std::shared_mutex> lock(m_index_mutex);
+  m_index.emplace(state_hash, index);
+  m_n_indexed = index + 1;
+  return index;
+}
+
+std::optional<std::size_t> StateCorpus::find(uint64_t state_hash) const {
+  std::shared_lock<std::shared_mutex> lock(m_index_mutex);
+  auto it = m_index.find(state_hash);
+  if (it == m_index.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void StateCorpus::refresh() {
+  const std::size_t n_records = size();
+  std::unique_lock<std::shared_mutex> lock(m_index_mutex);
+  if (n_records <= m_n_indexed) {
+    return;
+  }
+
+  // The index file is trusted only if it belongs to these records, otherwise
+  // the hashes are read from the records themselves
+  uint64_t identifier = 0;
+  std::vector<uint64_t> hashes(n_records - m_n_indexed);
+  const bool index_valid =
+      ::pread(m_index_fd, &identifier, INDEX_HEADER_SIZE, 0) ==
+          static_cast<ssize_t>(INDEX_HEADER_SIZE) &&
+      identifier == m_header->identifier &&
+      ::pread(m_index_fd, hashes.data(), hashes.size() * sizeof(uint64_t),
+              INDEX_HEADER_SIZE + m_n_indexed * sizeof(uint64_t)) ==
+          static_cast<ssize_t>(hashes.size() * sizeof(uint64_t));
+
+  for (std::size_t i = 0; i < hashes.size(); ++i) {
+    const std::size_t index = m_n_indexed + i;
+    m_index.emplace(index_valid ? hashes[i] : record(index).state_hash, index);
+  }
+  m_n_indexed = n_records;
+}
+
+const StateRecord& StateCorpus::getRecord(std::size_t index) const {
+  return record(index);
+}
+
+void StateCorpus::restore(std::size_t index, Emulator& emulator) const {
+  const StateRecord& stored = record(index);
+  emulator.restoreState(stored.state, stored.memory_hash);
+}
+
+std::size_t StateCorpus::countPublished() const {
+  return m_header ? m_header->n_records.load(std::memory_order_acquire) : 0;
+}
+
+const StateRecord& StateCorpus::record(std::size_t index) const {
+  // Past the published records, the mapping may be beyond the end of the file
+  if (index >= size()) {
+    throw std::out_of_range("no record " + std::to_string(index) +
+                            " in the state corpus");
+  }
+  return *reinterpret_cast<const StateRecord*>(
+      m_mapping + HEADER_SIZE + index * RECORD_STRIDE);
+}
+
+bool StateCorpus::reserve(std::size_t n_records) {
+  if (n_records <= m_n_reserved) {
+    return true;
+  }
+
+  // Grow the file by chunks, the mapping already covers it
+  const std::size_t n_reserved = std::min(
+      std::max({n_records, m_n_reserved * 2, GROWTH_RECORDS}), m_max_records);
+  if (::ftruncate(m_fd, HEADER_SIZE + n_reserved * RECORD_STRIDE) != 0) {
+    return false;
+  }
+
+  m_n_reserved = n_reserved;
+  return true;
+}
+
+bool compactStateCorpus(const std::string& path,
+                        const std::function<bool(const StateRecord&)>& keep) {
+  // Holding the corpus for writing keeps the writers out until the swap
+  StateCorpus source;
+  if (!source.open(path, true)) {
+    return false;
+  }
+
+  const std::string compacted_path = path + ".compact";
+  std::remove(compacted_path.c_str());
+  std::remove(indexPath(compacted_path).c_str());
+
+  StateCorpus compacted;
+  bool success = compacted.open(compacted_path, true,
+                                std::max<std::size_t>(source.size(), 1));
+  for (std::size_t index = 0; success && index < source.size(); ++index) {
+    const StateRecord& stored = source.getRecord(index);
+    if (keep(stored)) {
+      success = compacted.append(stored.state, stored.memory_hash).has_value();
+    }
+  }
+  compacted.close();
+
+  // Readers opening the corpus between the two renames rebuild the index from
+  // the records since its identifier does not match
+  success = success &&
+            std::rename(compacted_path.c_str(), path.c_str()) == 0 &&
+            std::rename(indexPath(compacted_path).c_str(),
+                        indexPath(path).c_str()) == 0;
+  if (!success) {
+    std::remove(compacted_path.c_str());
+    std::remove(indexPath(compacted_path).c_str());
+  }
+  return success;
+}
+
+}  // namespace chip8
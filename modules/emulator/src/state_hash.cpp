@@ -0,0 +1,94 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "emulator/state_hash.h"
+
+namespace chip8 {
+
+static const uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+template <typename T>
+static uint64_t hashValue(const T& value, uint64_t seed) {
+  return hashBytes(&value, sizeof(value), seed);
+}
+
+uint64_t hashBytes(const void* data, std::size_t size, uint64_t seed) {
+  auto bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = seed;
+  for (std::size_t i = 0; i < size; ++i) {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+
+  return hash;
+}
+
+uint64_t hashFrameBuffer(const FrameBuffer& framebuffer) {
+  return hashBytes(framebuffer.data(), framebuffer.size());
+}
+
+uint64_t hashState(const MachineState& state) {
+  // Hash member by member so that padding bytes are never read
+  uint64_t hash = hashValue(static_cast<uint16_t>(state.pc), HASH_SEED);
+  hash = hashValue(static_cast<uint8_t>(state.stack_ptr), hash);
+  hash = hashValue(static_cast<uint16_t>(state.index_reg), hash);
+  hash = hashValue(static_cast<uint8_t>(state.delay_timer_reg), hash);
+  hash = hashValue(static_cast<uint8_t>(state.sound_timer_reg), hash);
+  hash = hashBytes(state.registers.data(), state.registers.size(), hash);
+  hash = hashBytes(state.stack.data(), state.stack.size() * sizeof(uint16_t),
+                   hash);
+  hash = hashBytes(state.ram.data(), state.ram.size(), hash);
+  hash = hashBytes(state.framebuffer.data(), state.framebuffer.size(), hash);
+  hash = hashValue(state.random_state.state, hash);
+  return hashValue(state.random_state.increment, hash);
+}
+
+uint64_t IncrementalStateHash::hashMemory(const MachineState& state) {
+  uint64_t hash = 0;
+  for (std::size_t address = 0; address < state.ram.size(); ++address) {
+    hash ^= term(address, state.ram[address]);
+  }
+  for (std::size_t index = 0; index < state.framebuffer.size(); ++index) {
+    hash ^= term(RAM::size() + index, state.framebuffer[index]);
+  }
+
+  return hash;
+}
+
+uint64_t combineStateHash(const MachineState& state, uint64_t memory_hash) {
+  uint64_t hash = hashValue(memory_hash, HASH_SEED);
+  hash = hashValue(static_cast<uint16_t>(state.pc), hash);
+  hash = hashValue(static_cast<uint8_t>(state.stack_ptr), hash);
+  hash = hashValue(static_cast<uint16_t>(state.index_reg), hash);
+  hash = hashValue(static_cast<uint8_t>(state.delay_timer_reg), hash);
+  hash = hashValue(static_cast<uint8_t>(state.sound_timer_reg), hash);
+  hash = hashBytes(state.registers.data(), state.registers.size(), hash);
+  hash = hashBytes(state.stack.data(), state.stack.size() * sizeof(uint16_t),
+                   hash);
+  hash = hashValue(state.random_state.state, hash);
+  return hashValue(state.random_state.increment, hash);
+}
+
+}  // namespace chip8
@@ -0,0 +1,128 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_EXPLORER_EXPLORER_H_
+#define MODULES_EXPLORER_EXPLORER_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/input_movie.h"
+#include "emulator/machine_state.h"
+
+#include "explorer/work_stealing_pool.h"
+
+namespace chip8 {
+
+enum class SearchStrategy {
+  BREADTH_FIRST,  ///< expand every state of a depth before the next depth
+  BEST_FIRST      ///< expand the states with the highest score first
+};
+
+struct ExplorerConfig {
+  std::size_t frames_per_step;  ///< frames run with the same keys per branch
+  std::size_t max_depth;        ///< maximal number of steps from the start
+  std::size_t max_states;       ///< exploration stops after that many states
+  std::size_t n_workers;
+  SearchStrategy strategy;
+  /// Priority of the states for best first, higher is expanded first
+  std::function<double(const RAM&)> score;
+  /// Optional, exploration stops at the first state satisfying it
+  std::function<bool(const RAM&)> goal;
+};
+
+struct ExplorationResult {
+  std::size_t n_states;    ///< distinct states discovered
+  std::size_t n_expanded;  ///< states whose branches were run
+  std::size_t max_depth;   ///< deepest step reached
+  bool goal_reached;
+  double best_score;
+  InputMovie movie;  ///< inputs reaching the goal, else the best scoring state
+};
+
+/*!
+ * @class Explorer
+ * Explore the states reachable by a ROM. Each step branches on the 17 input
+ * choices (no key or one of the 16 keys) held during frames_per_step frames.
+ * Branches are run from a clone of the state they start from and states are
+ * deduplicated on their hash. The branches of a round are run in parallel on
+ * a work stealing pool; the results are merged in a fixed order so that an
+ * exploration is reproducible whatever the number of workers.
+ *
+ * Every discovered state is kept in memory (about 6 KiB each), max_states
+ * bounds the memory used.
+ */
+class Explorer {
+ public:
+  /*!
+   * @param rom program to explore
+   * @param config
+   */
+  Explorer(const std::vector<uint8_t>& rom, ExplorerConfig config);
+  ~Explorer();
+
+  ExplorationResult run();
+
+ private:
+  struct Node {
+    MachineState state;
+    uint64_t memory_hash;
+    uint64_t hash;
+    std::size_t parent;
+    uint16_t keys;  ///< keys held from the parent to this state
+    std::size_t depth;
+    double score;
+    bool is_goal;
+  };
+
+  Node makeNode(const Emulator& emulator, std::size_t parent, uint16_t keys,
+                std::size_t depth) const;
+  void expand(std::size_t node_index, std::size_t worker,
+              std::vector<Node>& children) const;
+  std::vector<std::size_t> selectBatch();
+  std::function<bool(std::size_t, std::size_t)> compareScores() const;
+  InputMovie makeMovie(std::size_t node_index) const;
+
+ private:
+  ExplorerConfig m_config;
+  WorkStealingPool m_pool;
+  std::vector<std::unique_ptr<BitmaskUserInputController>> m_keypads;
+  std::vector<std::unique_ptr<Emulator>> m_emulators;
+  MachineState m_initial_state;
+  uint64_t m_initial_memory_hash;
+  std::vector<std::unique_ptr<Node>> m_nodes;
+  std::vector<std::size_t> m_open;
+  std::unordered_set<uint64_t> m_visited;
+};
+
+}  // namespace chip8
+#endif  // MODULES_EXPLORER_EXPLORER_H_
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_EXPLORER_WORK_STEALING_POOL_H_
+#define MODULES_EXPLORER_WORK_STEALING_POOL_H_
+
+// std
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace chip8 {
+
+/*!
+ * @class WorkStealingPool
+ * Fixed set of threads running batches of tasks. The tasks of a batch are
+ * dealt to per worker queues; a worker takes from the front of its own queue
+ * and, once it is empty, steals from the back of the others so that uneven
+ * tasks keep every thread busy.
+ */
+class WorkStealingPool {
+ public:
+  /*!
+   * Task executed by a worker, the argument is the index of the worker which
+   * allows the tasks to use per worker resources
+   */
+  using Task = std::function<void(std::size_t)>;
+
+  /*!
+   * @param n_workers number of threads, at least one
+   */
+  explicit WorkStealingPool(std::size_t n_workers);
+  ~WorkStealingPool();
+
+  WorkStealingPool(const WorkStealingPool&) = delete;
+  WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+  /*!
+   * Execute the tasks and wait until all of them are done
+   * @param tasks
+   */
+  void run(std::vector<Task> tasks);
+
+  std::size_t size() const { return m_threads.size(); }
+
+  /*!
+   * @return number of tasks executed by another worker than the one they were
+   * dealt to since construction
+   */
+  std::size_t countSteals() const { return m_n_steals; }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  void workerLoop(std::size_t worker);
+  bool popTask(std::size_t worker, Task& task);
+
+ private:
+  std::vector<std::unique_ptr<Queue>> m_queues;
+  std::mutex m_mutex;
+  std::condition_variable m_start_condition;
+  std::condition_variable m_done_condition;
+  uint64_t m_generation;
+  std::size_t m_n_pending;
+  bool m_stopping;
+  std::atomic<std::size_t> m_n_steals;
+  std::vector<std::thread> m_threads;
+};
+
+}  // namespace chip8
+#endif  // MODULES_EXPLORER_WORK_STEALING_POOL_H_
@@ -0,0 +1,218 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "explorer/explorer.h"
+
+namespace chip8 {
+
+// No key then each of the 16 keys
+static const std::size_t N_ACTIONS = 17;
+// Best first expands a few states per worker per round
+static const std::size_t BEST_FIRST_BATCH_PER_WORKER = 4;
+
+Explorer::Explorer(const std::vector<uint8_t>& rom, ExplorerConfig config)
+    : m_config(std::move(config)), m_pool(m_config.n_workers) {
+  m_config.frames_per_step = std::max<std::size_t>(m_config.frames_per_step, 1);
+
+  // One emulator per worker, branches are run on clones of the states
+  const std::string program(rom.begin(), rom.end());
+  for (std::size_t worker = 0; worker < m_pool.size(); ++worker) {
+    std::istringstream rom_stream(program);
+    m_keypads.push_back(std::make_unique<BitmaskUserInputController>());
+    m_emulators.push_back(
+        std::make_unique<Emulator>(rom_stream, m_keypads.back().get()));
+  }
+
+  const Emulator& emulator = *m_emulators.front();
+  m_initial_state = emulator.getState();
+  m_initial_memory_hash = emulator.getMemoryHash();
+}
+
+Explorer::~Explorer() = default;
+
+ExplorationResult Explorer::run() {
+  m_nodes.clear();
+  m_open.clear();
+  m_visited.clear();
+
+  Emulator& emulator = *m_emulators.front();
+  emulator.restoreState(m_initial_state, m_initial_memory_hash);
+  m_nodes.push_back(std::make_unique<Node>(makeNode(emulator, 0, 0, 0)));
+  m_visited.insert(m_nodes.front()->hash);
+
+  ExplorationResult result{1,     0, 0, m_nodes.front()->is_goal,
+                           m_nodes.front()->score, InputMovie()};
+  std::size_t best_index = 0;
+  if (!result.goal_reached && m_config.max_depth > 0) {
+    m_open.push_back(0);
+  }
+
+  while (!m_open.empty() && !result.goal_reached &&
+         m_nodes.size() < m_config.max_states) {
+    auto batch = selectBatch();
+
+    std::vector<std::vector<Node>> children(batch.size());
+    std::vector<WorkStealingPool::Task> tasks;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      tasks.emplace_back([this, &batch, &children, i](std::size_t worker) {
+        expand(batch[i], worker, children[i]);
+      });
+    }
+    m_pool.run(std::move(tasks));
+    result.n_expanded += batch.size();
+
+    // Merge in the order of the batch so that the result does not depend on
+    // the scheduling of the workers
+    for (auto& node_children : children) {
+      for (auto& child : node_children) {
+        if (result.goal_reached || m_nodes.size() >= m_config.max_states) {
+          break;
+        }
+        if (!m_visited.insert(child.hash).second) {
+          continue;
+        }
+
+        std::size_t index = m_nodes.size();
+        result.max_depth = std::max(result.max_depth, child.depth);
+        if (child.score > result.best_score) {
+          result.best_score = child.score;
+          best_index = index;
+        }
+        if (child.is_goal) {
+          result.goal_reached = true;
+          best_index = index;
+        }
+        bool is_open = !child.is_goal && child.depth < m_config.max_depth;
+        m_nodes.push_back(std::make_unique<Node>(std::move(child)));
+
+        if (is_open) {
+          m_open.push_back(index);
+          if (m_config.strategy == SearchStrategy::BEST_FIRST) {
+            std::push_heap(m_open.begin(), m_open.end(), compareScores());
+          }
+        }
+      }
+    }
+  }
+
+  result.n_states = m_nodes.size();
+  result.movie = makeMovie(best_index);
+  return result;
+}
+
+Explorer::Node Explorer::makeNode(const Emulator& emulator,
+                                  std::size_t parent, uint16_t keys,
+                                  std::size_t depth) const {
+  const MachineState& state = emulator.getState();
+  return Node{state,
+              emulator.getMemoryHash(),
+              emulator.stateHash(),
+              parent,
+              keys,
+              depth,
+              m_config.score ? m_config.score(state.ram) : 0,
+              m_config.goal && m_config.goal(state.ram)};
+}
+
+void Explorer::expand(std::size_t node_index, std::size_t worker,
+                      std::vector<Node>& children) const {
+  // Nodes are only added between rounds so they can be read concurrently
+  const Node& node = *m_nodes[node_index];
+  Emulator& emulator = *m_emulators[worker];
+  BitmaskUserInputController& keypad = *m_keypads[worker];
+
+  for (std::size_t action = 0; action < N_ACTIONS; ++action) {
+    auto keys = static_cast<uint16_t>(action == 0 ? 0 : 1 << (action - 1));
+    emulator.restoreState(node.state, node.memory_hash);
+    keypad.setKeys(keys);
+    for (std::size_t frame = 0; frame < m_config.frames_per_step; ++frame) {
+      emulator.runFrame();
+    }
+
+    // Many keys have no effect, skip their states before copying them
+    uint64_t hash = emulator.stateHash();
+    if (m_visited.count(hash) != 0 ||
+        std::any_of(children.begin(), children.end(),
+                    [hash](const Node& child) { return child.hash == hash; })) {
+      continue;
+    }
+    children.push_back(makeNode(emulator, node_index, keys, node.depth + 1));
+  }
+}
+
+std::vector<std::size_t> Explorer::selectBatch() {
+  std::vector<std::size_t> batch;
+  if (m_config.strategy == SearchStrategy::BREADTH_FIRST) {
+    // The open states are all at the same depth
+    batch.swap(m_open);
+    return batch;
+  }
+
+  std::size_t batch_size = m_pool.size() * BEST_FIRST_BATCH_PER_WORKER;
+  while (!m_open.empty() && batch.size() < batch_size) {
+    std::pop_heap(m_open.begin(), m_open.end(), compareScores());
+    batch.push_back(m_open.back());
+    m_open.pop_back();
+  }
+  return batch;
+}
+
+std::function<bool(std::size_t, std::size_t)> Explorer::compareScores() const {
+  // Highest score on top of the heap, the oldest state first on ties
+  return [this](std::size_t lhs, std::size_t rhs) {
+    const Node& lhs_node = *m_nodes[lhs];
+    const Node& rhs_node = *m_nodes[rhs];
+    if (lhs_node.score != rhs_node.score) {
+      return lhs_node.score < rhs_node.score;
+    }
+    return lhs > rhs;
+  };
+}
+
+InputMovie Explorer::makeMovie(std::size_t node_index) const {
+  std::vector<uint16_t> steps;
+  for (std::size_t index = node_index; index != 0;
+       index = m_nodes[index]->parent) {
+    steps.push_back(m_nodes[index]->keys);
+  }
+  std::reverse(steps.begin(), steps.end());
+
+  // The explorer runs the emulators with their default seed
+  InputMovie movie;
+  for (auto keys : steps) {
+    for (std::size_t frame = 0; frame < m_config.frames_per_step; ++frame) {
+      movie.append(keys);
+    }
+  }
+  return movie;
+}
+
+}  // namespace chip8
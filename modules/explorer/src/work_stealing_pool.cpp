@@ -0,0 +1,132 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <utility>
+
+#include "explorer/work_stealing_pool.h"
+
+namespace chip8 {
+
+WorkStealingPool::WorkStealingPool(std::size_t n_workers)
+    : m_generation(0), m_n_pending(0), m_stopping(false), m_n_steals(0) {
+  n_workers = std::max<std::size_t>(n_workers, 1);
+  for (std::size_t worker = 0; worker < n_workers; ++worker) {
+    m_queues.push_back(std::make_unique<Queue>());
+  }
+  for (std::size_t worker = 0; worker < n_workers; ++worker) {
+    m_threads.emplace_back(&WorkStealingPool::workerLoop, this, worker);
+  }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_start_condition.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void WorkStealingPool::run(std::vector<Task> tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+
+  // A worker still looking for tasks of the previous batch may already take
+  // the new ones, so they are counted before being dealt
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_n_pending = tasks.size();
+  lock.unlock();
+
+  for (std::size_t i = 0; i < tasks.size(); ++i) {
+    auto& queue = *m_queues[i % m_queues.size()];
+    std::lock_guard<std::mutex> queue_lock(queue.mutex);
+    queue.tasks.push_back(std::move(tasks[i]));
+  }
+
+  lock.lock();
+  ++m_generation;
+  m_start_condition.notify_all();
+  m_done_condition.wait(lock, [this] { return m_n_pending == 0; });
+}
+
+void WorkStealingPool::workerLoop(std::size_t worker) {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_start_condition.wait(lock, [this, generation] {
+        return m_stopping || m_generation != generation;
+      });
+      if (m_stopping) {
+        return;
+      }
+      generation = m_generation;
+    }
+
+    // Tasks do not create tasks, so the batch is over for this worker once
+    // every queue is empty
+    Task task;
+    while (popTask(worker, task)) {
+      task(worker);
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_n_pending == 0) {
+        m_done_condition.notify_one();
+      }
+    }
+  }
+}
+
+bool WorkStealingPool::popTask(std::size_t worker, Task& task) {
+  {
+    auto& queue = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      return true;
+    }
+  }
+
+  for (std::size_t offset = 1; offset < m_queues.size(); ++offset) {
+    auto& queue = *m_queues[(worker + offset) % m_queues.size()];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty()) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      ++m_n_steals;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+}  // namespace chip8
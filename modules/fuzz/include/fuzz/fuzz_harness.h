@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_FUZZ_FUZZ_HARNESS_H_
+#define MODULES_FUZZ_FUZZ_HARNESS_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/machine_state.h"
+
+namespace chip8 {
+
+/*!
+ * Number of frames run at most for a single input
+ */
+extern const std::size_t FUZZ_MAX_FRAMES;
+
+/*!
+ * @class FuzzHarness
+ * Runs fuzz inputs on the instruction core. An input is a ROM followed by an
+ * input movie:
+ *
+ *   u16 ROM size (little endian) | ROM bytes | u16 keys bitmask per frame
+ *
+ * The emulator is built once. Before each run the pristine machine is copied
+ * over the state the emulator runs on and the ROM is copied into its RAM, so
+ * that a run costs no allocation nor ROM parsing.
+ *
+ * Guest coverage is reported on the edges between two consecutive
+ * (PC, opcode) pairs, hashed into the counters given at construction.
+ */
+class FuzzHarness {
+ public:
+  /*!
+   * @param edge_counters counters incremented when an edge is executed, e.g.
+   * the extra counters of libFuzzer
+   * @param n_edge_counters number of counters
+   * @throw std::invalid_argument if there is no counter
+   */
+  FuzzHarness(uint8_t* edge_counters, std::size_t n_edge_counters);
+
+  /*!
+   * Reset the machine then run an input
+   * @param data fuzz input
+   * @param size size of the input in bytes
+   */
+  void run(const uint8_t* data, std::size_t size);
+
+  const Emulator& getEmulator() const { return *m_emulator; }
+
+  const MachineState& getState() const { return m_state; }
+
+ private:
+  void reset(const uint8_t* rom, std::size_t rom_size);
+
+  void recordEdge();
+
+  MachineState m_state;
+  MachineState m_pristine_state;
+  uint64_t m_pristine_memory_hash;
+  BitmaskUserInputController m_ui_controller;
+  std::unique_ptr<Emulator> m_emulator;
+  uint8_t* m_edge_counters;
+  std::size_t m_n_edge_counters;
+  uint32_t m_previous_location;
+};
+
+}  // namespace chip8
+#endif  // MODULES_FUZZ_FUZZ_HARNESS_H_
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#include "emulator/rom_loader.h"
+#include "emulator/state_hash.h"
+#include "fuzz/fuzz_harness.h"
+
+namespace chip8 {
+
+extern const std::size_t FUZZ_MAX_FRAMES = 300;
+
+static const std::size_t HEADER_SIZE = 2;
+static const std::size_t FRAME_SIZE = 2;
+
+FuzzHarness::FuzzHarness(uint8_t* edge_counters, std::size_t n_edge_counters)
+    : m_edge_counters(edge_counters),
+      m_n_edge_counters(n_edge_counters),
+      m_previous_location(0) {
+  if (edge_counters == nullptr || n_edge_counters == 0) {
+    throw std::invalid_argument("no edge counters");
+  }
+
+  // The ROM is copied by reset(), the pristine machine only holds the sprites
+  std::istringstream empty_rom;
+  m_emulator =
+      std::make_unique<Emulator>(empty_rom, &m_ui_controller, m_state);
+  m_pristine_state = m_state;
+  m_pristine_memory_hash = m_emulator->getMemoryHash();
+}
+
+void FuzzHarness::run(const uint8_t* data, std::size_t size) {
+  std::size_t rom_size = 0;
+  if (size >= HEADER_SIZE) {
+    rom_size = data[0] | data[1] << 8;
+    data += HEADER_SIZE;
+    size -= HEADER_SIZE;
+  }
+  rom_size = std::min({rom_size, size, MAX_PROGRAM_SIZE});
+  reset(data, rom_size);
+
+  const uint8_t* frames = data + rom_size;
+  const std::size_t n_frames = std::min(
+      std::max<std::size_t>((size - rom_size) / FRAME_SIZE, 1),
+      FUZZ_MAX_FRAMES);
+
+  for (std::size_t frame = 0; frame < n_frames; ++frame) {
+    const std::size_t offset = frame * FRAME_SIZE;
+    m_ui_controller.setKeys(offset + FRAME_SIZE <= size - rom_size
+                                ? frames[offset] | frames[offset + 1] << 8
+                                : 0);
+
+    for (std::size_t cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle) {
+      recordEdge();
+      m_emulator->step();
+    }
+    m_emulator->updateTimers();
+  }
+}
+
+void FuzzHarness::reset(const uint8_t* rom, std::size_t rom_size) {
+  std::memcpy(&m_state, &m_pristine_state, sizeof(MachineState));
+  std::memcpy(m_state.ram.data() + PROGRAM_START_ADDRESS, rom, rom_size);
+
+  // The program area of the pristine RAM is zeroed
+  IncrementalStateHash memory_hash;
+  memory_hash.setValue(m_pristine_memory_hash);
+  for (std::size_t i = 0; i < rom_size; ++i) {
+    memory_hash.updateRam(PROGRAM_START_ADDRESS + i, 0, rom[i]);
+  }
+  m_emulator->restoreState(m_state, memory_hash.getValue());
+
+  std::fill(m_edge_counters, m_edge_counters + m_n_edge_counters, 0);
+  m_previous_location = 0;
+}
+
+void FuzzHarness::recordEdge() {
+  const std::size_t pc = m_state.pc;
+  const uint32_t opcode = m_state.ram[wrapAddress(pc)] << 8 |
+                          m_state.ram[wrapAddress(pc + 1)];
+
+  // Same scheme as AFL: the previous location is shifted so that A -> B and
+  // B -> A are different edges
+  const uint32_t location =
+      (static_cast<uint32_t>(pc) << 16 | opcode) * 2654435761u;
+  uint8_t& counter =
+      m_edge_counters[(location ^ m_previous_location) % m_n_edge_counters];
+  if (counter != UINT8_MAX) {
+    ++counter;
+  }
+  m_previous_location = location >> 1;
+}
+
+}  // namespace chip8
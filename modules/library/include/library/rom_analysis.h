@@ -0,0 +1,80 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_LIBRARY_ROM_ANALYSIS_H_
+#define MODULES_LIBRARY_ROM_ANALYSIS_H_
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "emulator/memory.h"
+
+namespace chip8 {
+
+enum class RomVariant : uint8_t {
+  CHIP8,      ///< only uses the original instruction set
+  SUPER_CHIP  ///< uses the SUPER-CHIP extensions (scrolling, high resolution)
+};
+
+// Instructions found in the reachable code of a ROM
+enum RomFeature : uint32_t {
+  ROM_READS_KEYS = 1 << 0,     ///< Ex9E, ExA1 or Fx0A
+  ROM_WAITS_FOR_KEY = 1 << 1,  ///< Fx0A
+  ROM_PLAYS_SOUND = 1 << 2,    ///< Fx18
+  ROM_USES_RANDOM = 1 << 3,    ///< Cxkk
+  ROM_WRITES_RAM = 1 << 4,     ///< Fx33 or Fx55
+  ROM_COMPUTED_JUMP = 1 << 5   ///< Bnnn, the analysis cannot follow it
+};
+
+/*!
+ * @struct RomAnalysis
+ * Static analysis of a ROM
+ */
+struct RomAnalysis {
+  RomVariant variant;
+  uint32_t features;  ///< combination of RomFeature
+  uint32_t n_reachable_instructions;
+  /// Bit a is set if an instruction reachable from 0x200 starts at address a
+  std::array<uint64_t, RAM::size() / 64> code_map;
+
+  bool isCode(std::size_t address) const {
+    return (code_map[address / 64] >> (address % 64)) & 0x1;
+  }
+};
+
+/*!
+ * Follow the control flow of the program from 0x200: jumps, calls, returns
+ * and both outcomes of the skips. Computed jumps (Bnnn) end a path, the code
+ * they reach is not found.
+ * @param ram RAM holding the program at 0x200
+ * @param size size of the program in bytes
+ * @return analysis of the reachable instructions
+ */
+RomAnalysis analyzeRom(const RAM& ram, std::size_t size);
+
+}  // namespace chip8
+#endif  // MODULES_LIBRARY_ROM_ANALYSIS_H_
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_LIBRARY_ROM_INDEX_H_
+#define MODULES_LIBRARY_ROM_INDEX_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "library/rom_analysis.h"
+
+namespace chip8 {
+
+extern const uint32_t ROM_INDEX_MAGIC;
+extern const uint16_t ROM_INDEX_VERSION;
+
+/*!
+ * @struct RomEntry
+ * Metadata of a ROM of the library
+ */
+struct RomEntry {
+  std::string path;
+  uint64_t hash;  ///< hashBytes() of the content of the ROM
+  uint32_t size;
+  int64_t modification_time;  ///< of the file when it was analyzed [ns]
+  /// Best known speed, 0 if unknown. Kept as long as the content is the same.
+  uint32_t cycles_per_frame;
+  RomAnalysis analysis;
+};
+
+/*!
+ * @struct ScanStatistics
+ * Work done by a scan
+ */
+struct ScanStatistics {
+  std::size_t n_roms;      ///< ROMs found in the directories
+  std::size_t n_analyzed;  ///< new or modified ROMs, hashed and analyzed
+  std::size_t n_removed;   ///< ROMs of the index which were not found
+  std::size_t n_errors;    ///< files which could not be loaded
+};
+
+/*!
+ * @class RomIndex
+ * Index of a library of ROMs persisted on disk. A scan only loads and analyzes
+ * the files whose size or modification time changed since the index was
+ * saved, the others keep their entry. ROMs are then looked up by path or by
+ * the hash of their content, e.g. to resolve the ROMs of batch jobs.
+ */
+class RomIndex {
+ public:
+  RomIndex() = default;
+
+  /*!
+   * Replace the index by the one stored in the file
+   * @param path
+   * @return true if the index was successfully read
+   */
+  bool load(const std::string& path);
+
+  /*!
+   * @param path file to write, replaced atomically
+   * @return true if the index was successfully written
+   */
+  bool save(const std::string& path) const;
+
+  /*!
+   * Index the ROMs of the directories and their subdirectories. Files are
+   * analyzed in parallel, entries of ROMs no longer found in the directories
+   * are removed.
+   * @param directories
+   * @param n_threads number of threads analyzing files, at least one
+   * @return statistics of the scan
+   */
+  ScanStatistics scan(const std::vector<std::string>& directories,
+                      std::size_t n_threads);
+
+  /*!
+   * @param hash
+   * @return an entry of a ROM with this content, null if there is none
+   */
+  const RomEntry* findByHash(uint64_t hash) const;
+
+  /*!
+   * @param path path as found by the scan
+   * @return entry of the ROM, null if it is not indexed
+   */
+  const RomEntry* findByPath(const std::string& path) const;
+
+  /*!
+   * Record the best known speed of all the ROMs with this content
+   * @param hash
+   * @param cycles_per_frame
+   * @return false if no ROM has this content
+   */
+  bool setCyclesPerFrame(uint64_t hash, uint32_t cycles_per_frame);
+
+  const std::vector<RomEntry>& getEntries() const { return m_entries; }
+
+  std::size_t size() const { return m_entries.size(); }
+
+ private:
+  void rebuildLookup();
+
+ private:
+  std::vector<RomEntry> m_entries;
+  std::unordered_map<std::string, std::size_t> m_by_path;
+  std::unordered_map<uint64_t, std::size_t> m_by_hash;
+};
+
+}  // namespace chip8
+#endif  // MODULES_LIBRARY_ROM_INDEX_H_
@@ -0,0 +1,69 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_LIBRARY_ROM_WATCHER_H_
+#define MODULES_LIBRARY_ROM_WATCHER_H_
+
+// std
+#include <string>
+
+namespace chip8 {
+
+/*!
+ * @class RomWatcher
+ * Detect with inotify when a ROM file is rewritten. The directory of the file
+ * is watched so that a file replaced by a rename, as editors and assemblers
+ * do, is detected as well as one written in place.
+ */
+class RomWatcher {
+ public:
+  /*!
+   * @param path file to watch, its directory needs to exist
+   */
+  explicit RomWatcher(const std::string& path);
+  ~RomWatcher();
+
+  RomWatcher(const RomWatcher&) = delete;
+  RomWatcher& operator=(const RomWatcher&) = delete;
+
+  /*!
+   * @return false if the file cannot be watched
+   */
+  bool isWatching() const { return m_watch >= 0; }
+
+  /*!
+   * Check for changes without waiting, to be called from the main loop
+   * @return true if the file was written or replaced since the last poll
+   */
+  bool poll();
+
+ private:
+  std::string m_file_name;
+  int m_fd;
+  int m_watch;
+};
+
+}  // namespace chip8
+#endif  // MODULES_LIBRARY_ROM_WATCHER_H_
@@ -0,0 +1,135 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <vector>
+
+#include "emulator/rom_loader.h"
+
+#include "library/rom_analysis.h"
+
+namespace chip8 {
+
+static bool isSuperChipInstruction(uint16_t instruction) {
+  switch (instruction & 0xF000) {
+    case 0x0000:
+      // 00Cn, 00FB, 00FC, 00FD, 00FE and 00FF
+      return (instruction & 0xFFF0) == 0x00C0 ||
+             (instruction >= 0x00FB && instruction <= 0x00FF);
+    case 0xD000:
+      // Dxy0 draws a 16x16 sprite
+      return (instruction & 0x000F) == 0;
+    case 0xF000:
+      // Fx30, Fx75 and Fx85
+      return (instruction & 0x00FF) == 0x30 || (instruction & 0x00FF) == 0x75 ||
+             (instruction & 0x00FF) == 0x85;
+    default:
+      return false;
+  }
+}
+
+static uint32_t getFeatures(uint16_t instruction) {
+  const uint16_t low_byte = instruction & 0x00FF;
+  switch (instruction & 0xF000) {
+    case 0xB000:
+      return ROM_COMPUTED_JUMP;
+    case 0xC000:
+      return ROM_USES_RANDOM;
+    case 0xE000:
+      return low_byte == 0x9E || low_byte == 0xA1
+                 ? static_cast<uint32_t>(ROM_READS_KEYS)
+                 : 0u;
+    case 0xF000:
+      if (low_byte == 0x0A) {
+        return ROM_READS_KEYS | ROM_WAITS_FOR_KEY;
+      } else if (low_byte == 0x18) {
+        return ROM_PLAYS_SOUND;
+      } else if (low_byte == 0x33 || low_byte == 0x55) {
+        return ROM_WRITES_RAM;
+      }
+      return 0;
+    default:
+      return 0;
+  }
+}
+
+RomAnalysis analyzeRom(const RAM& ram, std::size_t size) {
+  RomAnalysis analysis{RomVariant::CHIP8, 0, 0, {}};
+  const std::size_t program_end = PROGRAM_START_ADDRESS + size;
+
+  std::vector<std::size_t> to_visit{PROGRAM_START_ADDRESS};
+  while (!to_visit.empty()) {
+    const std::size_t address = to_visit.back();
+    to_visit.pop_back();
+    if (address < PROGRAM_START_ADDRESS || address + 1 >= program_end ||
+        analysis.isCode(address)) {
+      continue;
+    }
+
+    analysis.code_map[address / 64] |= uint64_t(1) << (address % 64);
+    ++analysis.n_reachable_instructions;
+
+    const uint16_t instruction =
+        static_cast<uint16_t>(ram[address] << 8 | ram[address + 1]);
+    analysis.features |= getFeatures(instruction);
+    if (isSuperChipInstruction(instruction)) {
+      analysis.variant = RomVariant::SUPER_CHIP;
+    }
+
+    const std::size_t target = instruction & 0x0FFF;
+    switch (instruction & 0xF000) {
+      case 0x0000:
+        // Return and exit end the path
+        if (instruction != 0x00EE && instruction != 0x00FD) {
+          to_visit.push_back(address + 2);
+        }
+        break;
+      case 0x1000:
+        to_visit.push_back(target);
+        break;
+      case 0x2000:
+        to_visit.push_back(target);
+        to_visit.push_back(address + 2);
+        break;
+      case 0xB000:
+        break;
+      case 0x3000:
+      case 0x4000:
+      case 0x5000:
+      case 0x9000:
+      case 0xE000:
+        to_visit.push_back(address + 2);
+        to_visit.push_back(address + 4);
+        break;
+      default:
+        to_visit.push_back(address + 2);
+        break;
+    }
+  }
+
+  return analysis;
+}
+
+}  // namespace chip8
@@ -0,0 +1,318 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unordered_set>
+
+#include "emulator/little_endian.h"
+#include "emulator/rom_loader.h"
+#include "emulator/state_hash.h"
+
+#include "library/rom_index.h"
+
+namespace chip8 {
+
+namespace fs = std::filesystem;
+
+const uint32_t ROM_INDEX_MAGIC = 0x49523843;  // "C8RI"
+const uint16_t ROM_INDEX_VERSION = 1;
+
+static const char* const ROM_EXTENSIONS[] = {".ch8", ".c8", ".sc8"};
+static const std::size_t MAX_PATH_SIZE = 4096;
+
+static bool isRomFile(const fs::path& path) {
+  std::string extension = path.extension().string();
+  std::transform(extension.begin(), extension.end(), extension.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return std::find(std::begin(ROM_EXTENSIONS), std::end(ROM_EXTENSIONS),
+                   extension) != std::end(ROM_EXTENSIONS);
+}
+
+static bool isUnder(const std::string& path, const std::string& directory) {
+  return path.size() > directory.size() &&
+         path.compare(0, directory.size(), directory) == 0 &&
+         path[directory.size()] == fs::path::preferred_separator;
+}
+
+static std::string normalizePath(const std::string& path) {
+  std::error_code error;
+  const fs::path normalized = fs::weakly_canonical(path, error);
+  return error ? path : normalized.string();
+}
+
+// Load, hash and analyze a ROM, false if the file cannot be loaded
+static bool analyzeFile(RomEntry& entry) {
+  RAM ram;
+  const RomLoadResult program = loadProgramFromFile(ram, entry.path);
+  if (!program) {
+    return false;
+  }
+
+  entry.size = static_cast<uint32_t>(program.size);
+  entry.hash =
+      hashBytes(ram.data() + PROGRAM_START_ADDRESS, program.size);
+  entry.analysis = analyzeRom(ram, program.size);
+  return true;
+}
+
+bool RomIndex::load(const std::string& path) {
+  std::ifstream input_stream(path, std::ios_base::binary);
+  uint32_t magic = 0;
+  uint16_t version = 0;
+  uint32_t n_entries = 0;
+  if (!readValue(input_stream, magic) || magic != ROM_INDEX_MAGIC ||
+      !readValue(input_stream, version) || version != ROM_INDEX_VERSION ||
+      !readValue(input_stream, n_entries)) {
+    return false;
+  }
+
+  std::vector<RomEntry> entries;
+  for (uint32_t i = 0; i < n_entries; ++i) {
+    RomEntry entry;
+    uint64_t modification_time = 0;
+    uint8_t variant = 0;
+    uint16_t path_size = 0;
+    if (!readValue(input_stream, entry.hash) ||
+        !readValue(input_stream, entry.size) ||
+        !readValue(input_stream, modification_time) ||
+        !readValue(input_stream, entry.cycles_per_frame) ||
+        !readValue(input_stream, variant) ||
+        !readValue(input_stream, entry.analysis.features) ||
+        !readValue(input_stream, entry.analysis.n_reachable_instructions) ||
+        variant > static_cast<uint8_t>(RomVariant::SUPER_CHIP)) {
+      return false;
+    }
+    for (auto& word : entry.analysis.code_map) {
+      if (!readValue(input_stream, word)) {
+        return false;
+      }
+    }
+    if (!readValue(input_stream, path_size) || path_size > MAX_PATH_SIZE) {
+      return false;
+    }
+    entry.path.resize(path_size);
+    if (!input_stream.read(&entry.path[0], path_size)) {
+      return false;
+    }
+
+    entry.modification_time = static_cast<int64_t>(modification_time);
+    entry.analysis.variant = static_cast<RomVariant>(variant);
+    entries.push_back(std::move(entry));
+  }
+
+  m_entries = std::move(entries);
+  rebuildLookup();
+  return true;
+}
+
+bool RomIndex::save(const std::string& path) const {
+  // Readers never see a partially written index
+  const std::string temporary_path = path + ".tmp";
+  {
+    std::ofstream output_stream(temporary_path,
+                                std::ios_base::binary | std::ios_base::trunc);
+    writeValue(output_stream, ROM_INDEX_MAGIC);
+    writeValue(output_stream, ROM_INDEX_VERSION);
+    writeValue(output_stream, static_cast<uint32_t>(m_entries.size()));
+    for (const auto& entry : m_entries) {
+      writeValue(output_stream, entry.hash);
+      writeValue(output_stream, entry.size);
+      writeValue(output_stream,
+                 static_cast<uint64_t>(entry.modification_time));
+      writeValue(output_stream, entry.cycles_per_frame);
+      writeValue(output_stream, static_cast<uint8_t>(entry.analysis.variant));
+      writeValue(output_stream, entry.analysis.features);
+      writeValue(output_stream, entry.analysis.n_reachable_instructions);
+      for (auto word : entry.analysis.code_map) {
+        writeValue(output_stream, word);
+      }
+      writeValue(output_stream, static_cast<uint16_t>(entry.path.size()));
+      output_stream.write(entry.path.data(),
+                          static_cast<std::streamsize>(entry.path.size()));
+    }
+
+    if (!output_stream.flush()) {
+      std::remove(temporary_path.c_str());
+      return false;
+    }
+  }
+
+  return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+ScanStatistics RomIndex::scan(const std::vector<std::string>& directories,
+                              std::size_t n_threads) {
+  ScanStatistics statistics{0, 0, 0, 0};
+
+  // List the ROMs, the unchanged ones keep their entry
+  std::vector<std::string> scanned_directories;
+  std::vector<RomEntry> entries;
+  std::vector<std::size_t> to_analyze;
+  for (const auto& directory : directories) {
+    scanned_directories.push_back(normalizePath(directory));
+
+    std::error_code error;
+    fs::recursive_directory_iterator file(
+        scanned_directories.back(),
+        fs::directory_options::skip_permission_denied, error);
+    for (; !error && file != fs::recursive_directory_iterator();
+         file.increment(error)) {
+      std::error_code file_error;
+      if (!file->is_regular_file(file_error) || !isRomFile(file->path())) {
+        continue;
+      }
+
+      const auto size = file->file_size(file_error);
+      const auto modification_time = file->last_write_time(file_error);
+      if (file_error || size > MAX_PROGRAM_SIZE) {
+        continue;
+      }
+
+      RomEntry entry{file->path().string(),
+                     0,
+                     static_cast<uint32_t>(size),
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         modification_time.time_since_epoch())
+                         .count(),
+                     0,
+                     {}};
+      const RomEntry* cached = findByPath(entry.path);
+      if (cached != nullptr && cached->size == entry.size &&
+          cached->modification_time == entry.modification_time) {
+        entries.push_back(*cached);
+      } else {
+        to_analyze.push_back(entries.size());
+        entries.push_back(std::move(entry));
+      }
+    }
+  }
+
+  // Analyze the new and modified ROMs in parallel
+  std::vector<char> loaded(entries.size(), 1);
+  std::atomic<std::size_t> next(0);
+  auto analyze = [&]() {
+    for (std::size_t i = next++; i < to_analyze.size(); i = next++) {
+      loaded[to_analyze[i]] = analyzeFile(entries[to_analyze[i]]);
+    }
+  };
+  std::vector<std::thread> threads;
+  const std::size_t n_workers =
+      std::min(std::max<std::size_t>(n_threads, 1), to_analyze.size());
+  for (std::size_t i = 1; i < n_workers; ++i) {
+    threads.emplace_back(analyze);
+  }
+  analyze();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // The best known speed follows the content of the ROM
+  for (auto index : to_analyze) {
+    const RomEntry* previous = findByHash(entries[index].hash);
+    if (loaded[index] && previous != nullptr) {
+      entries[index].cycles_per_frame = previous->cycles_per_frame;
+    }
+  }
+
+  std::vector<RomEntry> scanned_entries;
+  std::unordered_set<std::string> found;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (loaded[i] && found.insert(entries[i].path).second) {
+      scanned_entries.push_back(std::move(entries[i]));
+    }
+  }
+
+  // Entries out of the scanned directories are kept as is
+  for (auto& entry : m_entries) {
+    const bool scanned = std::any_of(
+        scanned_directories.begin(), scanned_directories.end(),
+        [&entry](const std::string& directory) {
+          return isUnder(entry.path, directory);
+        });
+    if (!scanned) {
+      if (found.insert(entry.path).second) {
+        scanned_entries.push_back(std::move(entry));
+      }
+    } else if (found.count(entry.path) == 0) {
+      ++statistics.n_removed;
+    }
+  }
+
+  statistics.n_roms = entries.size();
+  statistics.n_analyzed = to_analyze.size();
+  statistics.n_errors = static_cast<std::size_t>(
+      std::count(loaded.begin(), loaded.end(), 0));
+
+  std::sort(scanned_entries.begin(), scanned_entries.end(),
+            [](const RomEntry& lhs, const RomEntry& rhs) {
+              return lhs.path < rhs.path;
+            });
+  m_entries = std::move(scanned_entries);
+  rebuildLookup();
+  return statistics;
+}
+
+const RomEntry* RomIndex::findByHash(uint64_t hash) const {
+  const auto entry = m_by_hash.find(hash);
+  return entry != m_by_hash.end() ? &m_entries[entry->second] : nullptr;
+}
+
+const RomEntry* RomIndex::findByPath(const std::string& path) const {
+  auto entry = m_by_path.find(path);
+  if (entry == m_by_path.end()) {
+    entry = m_by_path.find(normalizePath(path));
+  }
+  return entry != m_by_path.end() ? &m_entries[entry->second] : nullptr;
+}
+
+bool RomIndex::setCyclesPerFrame(uint64_t hash, uint32_t cycles_per_frame) {
+  bool found = false;
+  for (auto& entry : m_entries) {
+    if (entry.hash == hash) {
+      entry.cycles_per_frame = cycles_per_frame;
+      found = true;
+    }
+  }
+  return found;
+}
+
+void RomIndex::rebuildLookup() {
+  m_by_path.clear();
+  m_by_hash.clear();
+  for (std::size_t i = 0; i < m_entries.size(); ++i) {
+    m_by_path.emplace(m_entries[i].path, i);
+    m_by_hash.emplace(m_entries[i].hash, i);
+  }
+}
+
+}  // namespace chip8
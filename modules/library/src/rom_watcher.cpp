@@ -0,0 +1,86 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstring>
+#include <filesystem>
+
+// posix
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "library/rom_watcher.h"
+
+namespace chip8 {
+
+// Written in place or moved over the watched file
+static const uint32_t CHANGE_EVENTS = IN_CLOSE_WRITE | IN_MOVED_TO;
+static const std::size_t EVENT_BUFFER_SIZE = 4096;
+
+RomWatcher::RomWatcher(const std::string& path)
+    : m_file_name(std::filesystem::path(path).filename().string()),
+      m_fd(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)),
+      m_watch(-1) {
+  std::string directory = std::filesystem::path(path).parent_path().string();
+  if (directory.empty()) {
+    directory = ".";
+  }
+
+  if (m_fd >= 0) {
+    m_watch = inotify_add_watch(m_fd, directory.c_str(), CHANGE_EVENTS);
+  }
+}
+
+RomWatcher::~RomWatcher() {
+  if (m_fd >= 0) {
+    close(m_fd);
+  }
+}
+
+bool RomWatcher::poll() {
+  if (!isWatching()) {
+    return false;
+  }
+
+  // Several events are coalesced into a single change
+  bool changed = false;
+  alignas(inotify_event) char buffer[EVENT_BUFFER_SIZE];
+  ssize_t size;
+  while ((size = read(m_fd, buffer, sizeof(buffer))) > 0) {
+    for (ssize_t offset = 0; offset < size;) {
+      const auto* event =
+          reinterpret_cast<const inotify_event*>(buffer + offset);
+      if ((event->mask & CHANGE_EVENTS) != 0 && event->len != 0 &&
+          m_file_name == event->name) {
+        changed = true;
+      }
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+    }
+  }
+
+  return changed;
+}
+
+}  // namespace chip8
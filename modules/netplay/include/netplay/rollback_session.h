@@ -0,0 +1,154 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_NETPLAY_ROLLBACK_SESSION_H_
+#define MODULES_NETPLAY_ROLLBACK_SESSION_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <vector>
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/machine_state.h"
+
+#include "netplay/transport.h"
+
+namespace chip8 {
+
+extern const std::size_t DEFAULT_MAX_PREDICTION;
+
+/*!
+ * @class RollbackSession
+ * Two players sharing the keypad of one machine, each running a session. The
+ * sessions exchange their inputs and run the same frames in lockstep: the
+ * machine of both players starts from the same ROM and seed and each frame is
+ * run with the keys of both players combined.
+ *
+ * The local keys are applied to the frame they are given for, without any
+ * delay. The remote keys of the frames not received yet are predicted to be
+ * the last ones received. When a remote input turns out to be different from
+ * its prediction, the session restores the snapshot taken before that frame
+ * and runs the following frames again, headless and as fast as possible.
+ *
+ * A session runs at most max_prediction frames ahead of the last remote
+ * input received, and waits for its peer beyond that.
+ */
+class RollbackSession {
+ public:
+  /*!
+   * @param rom program shared by the players
+   * @param transport connection to the session of the other player
+   * @param seed seed of the random number generator, equal for both players
+   * @param max_prediction number of frames run with predicted remote inputs
+   * @throw std::invalid_argument if max_prediction is not in [1, 32]
+   */
+  RollbackSession(std::istream& rom, Transport& transport, uint64_t seed,
+                  std::size_t max_prediction = DEFAULT_MAX_PREDICTION);
+  ~RollbackSession();
+
+  RollbackSession(const RollbackSession&) = delete;
+  RollbackSession& operator=(const RollbackSession&) = delete;
+
+  /*!
+   * Run the next frame, called once per 60 Hz frame
+   * @param local_keys keys pressed by the local player, bit i for key i
+   * @return false if the frame could not be run because the session is
+   * waiting for the inputs of the other player
+   */
+  bool advanceFrame(uint16_t local_keys);
+
+  /*!
+   * Receive the inputs of the other player and correct the mispredicted frames
+   * without running a new frame
+   */
+  void poll();
+
+  /*!
+   * @return number of frames run
+   */
+  uint64_t getFrame() const { return m_frame; }
+
+  /*!
+   * @return number of frames whose remote input was received, these frames
+   * will not be run again
+   */
+  uint64_t getConfirmedFrame() const { return m_n_remote_frames; }
+
+  const Emulator& getEmulator() const { return *m_emulator; }
+
+  /*!
+   * @return number of mispredictions corrected
+   */
+  std::size_t countRollbacks() const { return m_n_rollbacks; }
+
+  /*!
+   * @return number of frames run again after mispredictions
+   */
+  std::size_t countResimulatedFrames() const { return m_n_resimulated_frames; }
+
+ private:
+  struct FrameInputs {
+    uint64_t frame;           ///< frame stored in the slot
+    uint16_t local_keys;
+    uint16_t remote_keys;     ///< received or predicted
+    bool remote_received;
+  };
+
+  struct Snapshot {
+    MachineState state;
+    uint64_t memory_hash;
+  };
+
+  FrameInputs& inputs(uint64_t frame);
+  void receiveInputs();
+  void sendInputs(uint64_t end);
+  void runFrame(uint64_t frame);
+  void rollback(uint64_t frame);
+
+ private:
+  Transport& m_transport;
+  const std::size_t m_max_prediction;
+  BitmaskUserInputController m_keypad;
+  std::unique_ptr<Emulator> m_emulator;
+  uint64_t m_frame;
+  // Frames received from the peer, without gap
+  uint64_t m_n_remote_frames;
+  // Frames of the local player received by the peer
+  uint64_t m_n_acked_frames;
+  uint16_t m_last_remote_keys;
+  // Earliest frame run with a wrong prediction
+  uint64_t m_rollback_frame;
+  std::vector<FrameInputs> m_inputs;
+  std::vector<std::unique_ptr<Snapshot>> m_snapshots;
+  std::size_t m_n_rollbacks;
+  std::size_t m_n_resimulated_frames;
+};
+
+}  // namespace chip8
+#endif  // MODULES_NETPLAY_ROLLBACK_SESSION_H_
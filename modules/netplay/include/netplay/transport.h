@@ -0,0 +1,130 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_NETPLAY_TRANSPORT_H_
+#define MODULES_NETPLAY_TRANSPORT_H_
+
+// std
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace chip8 {
+
+static const std::size_t MAX_PACKET_INPUTS = 32;
+
+/*!
+ * @struct InputPacket
+ * Inputs of consecutive frames of a player. The inputs not acknowledged yet
+ * are sent again in each packet, so a lost packet does not need to be resent.
+ */
+struct InputPacket {
+  uint32_t first_frame;  ///< frame of keys[0]
+  uint32_t ack_frame;    ///< number of frames received from the peer
+  uint8_t n_inputs;
+  std::array<uint16_t, MAX_PACKET_INPUTS> keys;
+};
+
+/*!
+ * @class Transport
+ * Unreliable and unordered delivery of packets to the peer
+ */
+class Transport {
+ public:
+  virtual ~Transport() = default;
+
+  /*!
+   * Send a packet, it may be lost
+   * @param packet
+   */
+  virtual void send(const InputPacket& packet) = 0;
+
+  /*!
+   * Take a received packet without blocking
+   * @param packet filled with the packet
+   * @return false if no packet was received
+   */
+  virtual bool receive(InputPacket& packet) = 0;
+};
+
+/*!
+ * @class InProcessTransport
+ * Transport between two sessions of the same process, e.g. for tests
+ */
+class InProcessTransport : public Transport {
+ public:
+  /*!
+   * @return two connected transports
+   */
+  static std::pair<std::unique_ptr<InProcessTransport>,
+                   std::unique_ptr<InProcessTransport>>
+  makePair();
+
+  void send(const InputPacket& packet) override;
+  bool receive(InputPacket& packet) override;
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<InputPacket> packets;
+  };
+
+  InProcessTransport(std::shared_ptr<Queue> incoming,
+                     std::shared_ptr<Queue> outgoing);
+
+ private:
+  std::shared_ptr<Queue> m_incoming;
+  std::shared_ptr<Queue> m_outgoing;
+};
+
+/*!
+ * @class SocketTransport
+ * Transport over a connected datagram socket: UDP between two hosts or a
+ * UNIX domain socket pair
+ */
+class SocketTransport : public Transport {
+ public:
+  /*!
+   * @param socket connected datagram socket, owned by the transport
+   */
+  explicit SocketTransport(int socket);
+  ~SocketTransport() override;
+
+  SocketTransport(const SocketTransport&) = delete;
+  SocketTransport& operator=(const SocketTransport&) = delete;
+
+  void send(const InputPacket& packet) override;
+  bool receive(InputPacket& packet) override;
+
+ private:
+  int m_socket;
+};
+
+}  // namespace chip8
+#endif  // MODULES_NETPLAY_TRANSPORT_H_
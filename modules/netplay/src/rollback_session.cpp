@@ -0,0 +1,191 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "netplay/rollback_session.h"
+
+namespace chip8 {
+
+extern const std::size_t DEFAULT_MAX_PREDICTION = 8;
+
+static const std::size_t MIN_PREDICTION = 1;
+static const std::size_t MAX_PREDICTION = 32;
+// Inputs kept around the current frame, large enough for the frames not
+// acknowledged by the peer and the frames it runs ahead
+static const std::size_t INPUT_HISTORY = 256;
+static const uint64_t NO_FRAME = std::numeric_limits<uint64_t>::max();
+
+RollbackSession::RollbackSession(std::istream& rom, Transport& transport,
+                                 uint64_t seed, std::size_t max_prediction)
+    : m_transport(transport),
+      m_max_prediction(max_prediction),
+      m_frame(0),
+      m_n_remote_frames(0),
+      m_n_acked_frames(0),
+      m_last_remote_keys(0),
+      m_rollback_frame(NO_FRAME),
+      m_inputs(INPUT_HISTORY, FrameInputs{NO_FRAME, 0, 0, false}),
+      m_n_rollbacks(0),
+      m_n_resimulated_frames(0) {
+  if (max_prediction < MIN_PREDICTION || max_prediction > MAX_PREDICTION) {
+    throw std::invalid_argument("max_prediction must be in [1, 32]");
+  }
+
+  m_emulator = std::make_unique<Emulator>(rom, &m_keypad);
+  m_emulator->seed(seed);
+
+  // A frame may be run again as long as its remote input is not received
+  for (std::size_t i = 0; i <= m_max_prediction; ++i) {
+    m_snapshots.push_back(std::make_unique<Snapshot>());
+  }
+}
+
+RollbackSession::~RollbackSession() = default;
+
+bool RollbackSession::advanceFrame(uint16_t local_keys) {
+  receiveInputs();
+
+  // Too far ahead of the peer, wait for it
+  if (m_frame >= m_n_remote_frames + m_max_prediction) {
+    sendInputs(m_frame);
+    return false;
+  }
+
+  inputs(m_frame).local_keys = local_keys;
+  sendInputs(m_frame + 1);
+
+  runFrame(m_frame);
+  ++m_frame;
+  return true;
+}
+
+void RollbackSession::poll() {
+  receiveInputs();
+  sendInputs(m_frame);
+}
+
+RollbackSession::FrameInputs& RollbackSession::inputs(uint64_t frame) {
+  FrameInputs& slot = m_inputs[frame % INPUT_HISTORY];
+  if (slot.frame != frame) {
+    slot = FrameInputs{frame, 0, 0, false};
+  }
+  return slot;
+}
+
+void RollbackSession::receiveInputs() {
+  InputPacket packet;
+  while (m_transport.receive(packet)) {
+    m_n_acked_frames =
+        std::max<uint64_t>(m_n_acked_frames, packet.ack_frame);
+
+    const std::size_t n_inputs =
+        std::min<std::size_t>(packet.n_inputs, MAX_PACKET_INPUTS);
+    for (std::size_t i = 0; i < n_inputs; ++i) {
+      // Inputs already received or too far ahead to be stored are ignored
+      const uint64_t frame = uint64_t(packet.first_frame) + i;
+      if (frame < m_n_remote_frames || frame >= m_frame + INPUT_HISTORY / 4) {
+        continue;
+      }
+
+      FrameInputs& frame_inputs = inputs(frame);
+      if (frame_inputs.remote_received) {
+        continue;
+      }
+      if (frame < m_frame && frame_inputs.remote_keys != packet.keys[i]) {
+        m_rollback_frame = std::min(m_rollback_frame, frame);
+      }
+      frame_inputs.remote_keys = packet.keys[i];
+      frame_inputs.remote_received = true;
+    }
+
+    while (true) {
+      const FrameInputs& next = m_inputs[m_n_remote_frames % INPUT_HISTORY];
+      if (next.frame != m_n_remote_frames || !next.remote_received) {
+        break;
+      }
+      m_last_remote_keys = next.remote_keys;
+      ++m_n_remote_frames;
+    }
+  }
+
+  if (m_rollback_frame != NO_FRAME) {
+    rollback(m_rollback_frame);
+    m_rollback_frame = NO_FRAME;
+  }
+}
+
+void RollbackSession::sendInputs(uint64_t end) {
+  // The peer has received every frame older than twice the prediction window,
+  // even if its acknowledgement was lost
+  uint64_t first = m_n_acked_frames;
+  if (end > 2 * m_max_prediction) {
+    first = std::max<uint64_t>(first, end - 2 * m_max_prediction);
+  }
+  first = std::min(first, end);
+
+  InputPacket packet{};
+  packet.first_frame = static_cast<uint32_t>(first);
+  packet.ack_frame = static_cast<uint32_t>(m_n_remote_frames);
+  packet.n_inputs = static_cast<uint8_t>(
+      std::min<uint64_t>(end - first, MAX_PACKET_INPUTS));
+  for (std::size_t i = 0; i < packet.n_inputs; ++i) {
+    packet.keys[i] = inputs(first + i).local_keys;
+  }
+  m_transport.send(packet);
+}
+
+void RollbackSession::runFrame(uint64_t frame) {
+  FrameInputs& frame_inputs = inputs(frame);
+  if (!frame_inputs.remote_received) {
+    frame_inputs.remote_keys = m_last_remote_keys;
+  }
+
+  // Only the frames run with a prediction may be run again
+  if (frame >= m_n_remote_frames) {
+    Snapshot& snapshot = *m_snapshots[frame % m_snapshots.size()];
+    snapshot.state = m_emulator->getState();
+    snapshot.memory_hash = m_emulator->getMemoryHash();
+  }
+
+  m_keypad.setKeys(frame_inputs.local_keys | frame_inputs.remote_keys);
+  m_emulator->runFrame();
+}
+
+void RollbackSession::rollback(uint64_t frame) {
+  const Snapshot& snapshot = *m_snapshots[frame % m_snapshots.size()];
+  m_emulator->restoreState(snapshot.state, snapshot.memory_hash);
+  ++m_n_rollbacks;
+
+  for (uint64_t resimulated = frame; resimulated < m_frame; ++resimulated) {
+    runFrame(resimulated);
+    ++m_n_resimulated_frames;
+  }
+}
+
+}  // namespace chip8
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <vector>
+
+// linux
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "netplay/transport.h"
+
+#include "emulator/little_endian.h"
+
+namespace chip8 {
+
+// first frame, ack frame, number of inputs then the keys
+static const std::size_t PACKET_HEADER_SIZE = 9;
+
+std::pair<std::unique_ptr<InProcessTransport>,
+          std::unique_ptr<InProcessTransport>>
+InProcessTransport::makePair() {
+  auto first_to_second = std::make_shared<Queue>();
+  auto second_to_first = std::make_shared<Queue>();
+  return {std::unique_ptr<InProcessTransport>(
+              new InProcessTransport(second_to_first, first_to_second)),
+          std::unique_ptr<InProcessTransport>(
+              new InProcessTransport(first_to_second, second_to_first))};
+}
+
+InProcessTransport::InProcessTransport(std::shared_ptr<Queue> incoming,
+                                       std::shared_ptr<Queue> outgoing)
+    : m_incoming(std::move(incoming)), m_outgoing(std::move(outgoing)) {}
+
+void InProcessTransport::send(const InputPacket& packet) {
+  std::lock_guard<std::mutex> lock(m_outgoing->mutex);
+  m_outgoing->packets.push_back(packet);
+}
+
+bool InProcessTransport::receive(InputPacket& packet) {
+  std::lock_guard<std::mutex> lock(m_incoming->mutex);
+  if (m_incoming->packets.empty()) {
+    return false;
+  }
+
+  packet = m_incoming->packets.front();
+  m_incoming->packets.pop_front();
+  return true;
+}
+
+SocketTransport::SocketTransport(int socket) : m_socket(socket) {}
+
+SocketTransport::~SocketTransport() { close(m_socket); }
+
+void SocketTransport::send(const InputPacket& packet) {
+  // Little endian, whatever the hosts
+  std::vector<uint8_t> bytes(PACKET_HEADER_SIZE + 2 * packet.n_inputs);
+  writeValue(bytes.data(), packet.first_frame);
+  writeValue(bytes.data() + 4, packet.ack_frame);
+  bytes[8] = packet.n_inputs;
+  for (std::size_t i = 0; i < packet.n_inputs; ++i) {
+    writeValue(bytes.data() + PACKET_HEADER_SIZE + 2 * i, packet.keys[i]);
+  }
+
+  // A full socket buffer drops the packet like the network would
+  ::send(m_socket, bytes.data(), bytes.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+}
+
+bool SocketTransport::receive(InputPacket& packet) {
+  std::array<uint8_t, PACKET_HEADER_SIZE + 2 * MAX_PACKET_INPUTS> bytes;
+  while (true) {
+    const ssize_t size =
+        ::recv(m_socket, bytes.data(), bytes.size(), MSG_DONTWAIT);
+    if (size <= 0) {
+      return false;
+    }
+
+    // Malformed datagrams are dropped
+    const std::size_t n_inputs =
+        size >= static_cast<ssize_t>(PACKET_HEADER_SIZE)
+            ? bytes[8]
+            : MAX_PACKET_INPUTS + 1;
+    if (n_inputs > MAX_PACKET_INPUTS ||
+        static_cast<std::size_t>(size) != PACKET_HEADER_SIZE + 2 * n_inputs) {
+      continue;
+    }
+
+    packet.first_frame = readValue<uint32_t>(bytes.data());
+    packet.ack_frame = readValue<uint32_t>(bytes.data() + 4);
+    packet.n_inputs = static_cast<uint8_t>(n_inputs);
+    for (std::size_t i = 0; i < n_inputs; ++i) {
+      packet.keys[i] =
+          readValue<uint16_t>(bytes.data() + PACKET_HEADER_SIZE + 2 * i);
+    }
+    return true;
+  }
+}
+
+}  // namespace chip8
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_RL_VECTOR_ENVIRONMENT_H_
+#define MODULES_RL_VECTOR_ENVIRONMENT_H_
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/instance_arena.h"
+#include "emulator/machine_state.h"
+
+namespace chip8 {
+
+/*!
+ * @struct RewardExtractor
+ * The reward of a step is scale * (value after the step - value before the
+ * step) where the value is the byte stored at address in RAM
+ */
+struct RewardExtractor {
+  uint16_t address;
+  float scale;
+};
+
+/*!
+ * @struct TerminalCondition
+ * The episode ends when the byte stored at address in RAM equals value
+ */
+struct TerminalCondition {
+  uint16_t address;
+  uint8_t value;
+};
+
+struct EnvironmentConfig {
+  std::size_t frame_skip;  ///< frames emulated per step with the same action
+  bool max_pool;  ///< observe the max of the skipped frames, else the last one
+  bool bit_packed;  ///< observations use one bit per pixel
+  uint64_t max_episode_frames;  ///< episodes are truncated after, 0 to disable
+  std::vector<RewardExtractor> rewards;
+  std::vector<TerminalCondition> terminal_conditions;
+};
+
+/*!
+ * @class VectorEnvironment
+ * Gym-style vector of environments running the same ROM. Each environment is
+ * a headless emulator; all of them are stepped by a single call which writes
+ * the observations, rewards and dones in buffers provided by the caller.
+ *
+ * Observations are stored contiguously per environment: either
+ * [DISPLAY_HEIGHT][DISPLAY_WIDTH] bytes equal to 0 or 1, or when bit packed
+ * [DISPLAY_HEIGHT][DISPLAY_WIDTH / 8] bytes with the leftmost pixel in the
+ * most significant bit.
+ *
+ * An environment that reported done is reset by the next step, which ignores
+ * its action and returns the first observation of the new episode.
+ */
+class VectorEnvironment {
+ public:
+  /*!
+   * @param rom program run by every environment
+   * @param n_environments number of environments
+   * @param config
+   * @throw std::invalid_argument if an address of the config is outside of RAM
+   */
+  VectorEnvironment(const std::vector<uint8_t>& rom,
+                    std::size_t n_environments, EnvironmentConfig config);
+
+  /*!
+   * Start a new episode in every environment
+   * @param seeds n_environments seeds of the random number generators, or
+   * nullptr to keep the generators running
+   * @param observations buffer of n_environments observations
+   */
+  void reset(const uint64_t* seeds, uint8_t* observations);
+
+  /*!
+   * Run frame_skip frames in every environment
+   * @param actions n_environments keys bitmasks
+   * @param observations buffer of n_environments observations
+   * @param rewards buffer of n_environments rewards
+   * @param dones buffer of n_environments flags set to 1 when an episode ends
+   */
+  void step(const uint16_t* actions, uint8_t* observations, float* rewards,
+            uint8_t* dones);
+
+  std::size_t size() const { return m_emulators.size(); }
+
+  /*!
+   * @return size in bytes of the observation of one environment
+   */
+  std::size_t observationSize() const;
+
+ private:
+  void resetEnvironment(std::size_t index, uint8_t* observation);
+  void observe(const FrameBuffer& framebuffer, uint8_t* observation,
+               bool accumulate) const;
+  float readRewardValue(const MachineState& state) const;
+  bool isTerminal(const MachineState& state) const;
+
+ private:
+  EnvironmentConfig m_config;
+  InstanceArena m_arena;
+  std::vector<BitmaskUserInputController> m_keypads;
+  std::vector<std::unique_ptr<Emulator>> m_emulators;
+  std::vector<uint64_t> m_episode_frames;
+  std::vector<uint8_t> m_needs_reset;
+  MachineState m_initial_state;
+};
+
+}  // namespace chip8
+#endif  // MODULES_RL_VECTOR_ENVIRONMENT_H_
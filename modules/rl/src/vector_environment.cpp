@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "rl/vector_environment.h"
+
+namespace chip8 {
+
+static const std::size_t PIXELS_PER_BYTE = 8;
+
+VectorEnvironment::VectorEnvironment(const std::vector<uint8_t>& rom,
+                                     std::size_t n_environments,
+                                     EnvironmentConfig config)
+    : m_config(std::move(config)),
+      m_arena(n_environments),
+      m_keypads(n_environments),
+      m_episode_frames(n_environments, 0),
+      m_needs_reset(n_environments, 0) {
+  m_config.frame_skip = std::max<std::size_t>(m_config.frame_skip, 1);
+  for (const auto& reward : m_config.rewards) {
+    if (reward.address >= RAM::size()) {
+      throw std::invalid_argument("reward address outside of RAM");
+    }
+  }
+  for (const auto& condition : m_config.terminal_conditions) {
+    if (condition.address >= RAM::size()) {
+      throw std::invalid_argument("terminal condition address outside of RAM");
+    }
+  }
+
+  const std::string program(rom.begin(), rom.end());
+  for (std::size_t index = 0; index < n_environments; ++index) {
+    std::istringstream rom_stream(program);
+    m_emulators.push_back(std::make_unique<Emulator>(
+        rom_stream, &m_keypads[index], *m_arena.allocate()));
+  }
+
+  // Episodes start from the machine as it is right after loading the ROM
+  if (!m_emulators.empty()) {
+    m_initial_state = m_emulators.front()->getState();
+  }
+}
+
+std::size_t VectorEnvironment::observationSize() const {
+  return m_config.bit_packed ? DISPLAY_WIDTH * DISPLAY_HEIGHT / PIXELS_PER_BYTE
+                             : DISPLAY_WIDTH * DISPLAY_HEIGHT;
+}
+
+void VectorEnvironment::reset(const uint64_t* seeds, uint8_t* observations) {
+  for (std::size_t index = 0; index < m_emulators.size(); ++index) {
+    if (seeds != nullptr) {
+      m_emulators[index]->seed(seeds[index]);
+    }
+    resetEnvironment(index, observations + index * observationSize());
+  }
+}
+
+void VectorEnvironment::step(const uint16_t* actions, uint8_t* observations,
+                             float* rewards, uint8_t* dones) {
+  for (std::size_t index = 0; index < m_emulators.size(); ++index) {
+    uint8_t* observation = observations + index * observationSize();
+    rewards[index] = 0;
+    dones[index] = 0;
+
+    if (m_needs_reset[index]) {
+      resetEnvironment(index, observation);
+      continue;
+    }
+
+    Emulator& emulator = *m_emulators[index];
+    const MachineState& state = emulator.getState();
+    float value_before = readRewardValue(state);
+    m_keypads[index].setKeys(actions[index]);
+
+    for (std::size_t frame = 0; frame < m_config.frame_skip; ++frame) {
+      emulator.runFrame();
+      if (m_config.max_pool || frame + 1 == m_config.frame_skip) {
+        observe(state.framebuffer, observation, m_config.max_pool && frame > 0);
+      }
+    }
+
+    m_episode_frames[index] += m_config.frame_skip;
+    rewards[index] = readRewardValue(state) - value_before;
+
+    bool truncated = m_config.max_episode_frames != 0 &&
+                     m_episode_frames[index] >= m_config.max_episode_frames;
+    if (truncated || isTerminal(state)) {
+      dones[index] = 1;
+      m_needs_reset[index] = 1;
+    }
+  }
+}
+
+void VectorEnvironment::resetEnvironment(std::size_t index,
+                                         uint8_t* observation) {
+  // The random number generator keeps running across episodes
+  const RandomState random_state = m_emulators[index]->getState().random_state;
+  m_emulators[index]->restoreState(m_initial_state);
+  m_emulators[index]->getState().random_state = random_state;
+  m_keypads[index].setKeys(0);
+  m_episode_frames[index] = 0;
+  m_needs_reset[index] = 0;
+  observe(m_initial_state.framebuffer, observation, false);
+}
+
+void VectorEnvironment::observe(const FrameBuffer& framebuffer,
+                                uint8_t* observation, bool accumulate) const {
+  // Pixels are 0 or 1 so the max of two frames is a bitwise OR
+  if (!m_config.bit_packed) {
+    if (accumulate) {
+      for (std::size_t i = 0; i < framebuffer.size(); ++i) {
+        observation[i] |= framebuffer[i];
+      }
+    } else {
+      std::memcpy(observation, framebuffer.data(), framebuffer.size());
+    }
+    return;
+  }
+
+  for (std::size_t byte = 0; byte < framebuffer.size() / PIXELS_PER_BYTE;
+       ++byte) {
+    const uint8_t* pixels = framebuffer.data() + byte * PIXELS_PER_BYTE;
+    uint8_t packed = 0;
+    for (std::size_t bit = 0; bit < PIXELS_PER_BYTE; ++bit) {
+      packed = static_cast<uint8_t>(packed << 1 | (pixels[bit] & 0x1));
+    }
+    observation[byte] = accumulate ? observation[byte] | packed : packed;
+  }
+}
+
+float VectorEnvironment::readRewardValue(const MachineState& state) const {
+  float value = 0;
+  for (const auto& reward : m_config.rewards) {
+    value += reward.scale * state.ram[reward.address];
+  }
+  return value;
+}
+
+bool VectorEnvironment::isTerminal(const MachineState& state) const {
+  return std::any_of(m_config.terminal_conditions.begin(),
+                     m_config.terminal_conditions.end(),
+                     [&state](const TerminalCondition& condition) {
+                       return state.ram[condition.address] == condition.value;
+                     });
+}
+
+}  // namespace chip8
@@ -0,0 +1,162 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MODULES_SCHEDULER_COOPERATIVE_SCHEDULER_H_
+#define MODULES_SCHEDULER_COOPERATIVE_SCHEDULER_H_
+
+// std
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+namespace chip8 {
+
+class Emulator;
+
+/*!
+ * @class EmulatorTask
+ * Coroutine driving an emulator. The task is created suspended and is resumed
+ * by a CooperativeScheduler.
+ */
+class EmulatorTask {
+ public:
+  struct promise_type {
+    EmulatorTask get_return_object();
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { exception = std::current_exception(); }
+
+    std::exception_ptr exception;
+  };
+
+  using handle_t = std::coroutine_handle<promise_type>;
+
+  explicit EmulatorTask(handle_t handle) : m_handle(handle) {}
+  EmulatorTask(EmulatorTask&& other) noexcept;
+  EmulatorTask& operator=(EmulatorTask&& other) noexcept;
+  EmulatorTask(const EmulatorTask&) = delete;
+  EmulatorTask& operator=(const EmulatorTask&) = delete;
+  ~EmulatorTask();
+
+  handle_t handle() const { return m_handle; }
+
+ private:
+  handle_t m_handle;
+};
+
+/*!
+ * @class CooperativeScheduler
+ * Interleaves many emulators on a single thread. Each emulator runs inside a
+ * coroutine which gives the control back to the scheduler:
+ * - at each frame boundary,
+ * - when the cycle budget of its time slice is exhausted,
+ * - when it executes a Fx0A with no key pressed and its timers are stopped.
+ *   The task then stays blocked without consuming any CPU until notifyInput()
+ *   is called for its emulator.
+ *
+ * While the timers run, a Fx0A waiting for a key is polled again at each
+ * cycle like any other instruction so that the timers keep counting down.
+ * Once they are stopped, polling would not change the machine anymore: the
+ * emulator is frozen in the state it would keep until a key is pressed, only
+ * its frames do not advance while it is blocked.
+ */
+class CooperativeScheduler {
+ public:
+  /*!
+   * @param cycle_budget maximum number of instructions executed by a task
+   * before giving the control back to the scheduler
+   */
+  explicit CooperativeScheduler(std::size_t cycle_budget);
+
+  /*!
+   * Add a task running the emulator for a number of frames. An emulator can
+   * only be driven by one task at a time.
+   * @param emulator emulator to run, needs to outlive the scheduler
+   * @param n_frames number of 60 Hz frames to execute
+   */
+  void spawn(Emulator& emulator, std::size_t n_frames);
+
+  /*!
+   * Wake up the task of the emulator if it is blocked waiting for a key press.
+   * Should be called when the inputs of the emulator changed.
+   * @param emulator
+   * @return true if a blocked task was woken up
+   */
+  bool notifyInput(Emulator& emulator);
+
+  /*!
+   * Resume once every task that is ready to run. Exceptions thrown by a task
+   * are propagated to the caller.
+   * @return number of resumed tasks
+   */
+  std::size_t runOnce();
+
+  /*!
+   * Resume the tasks until all of them are either finished or blocked
+   */
+  void run();
+
+  std::size_t countReady() const { return m_ready.size(); }
+  std::size_t countBlocked() const { return m_blocked.size(); }
+  std::size_t countFinished() const { return m_n_finished; }
+
+ private:
+  struct YieldAwaiter {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(EmulatorTask::handle_t handle) {
+      scheduler.m_ready.push_back(handle);
+    }
+    void await_resume() const noexcept {}
+
+    CooperativeScheduler& scheduler;
+  };
+
+  struct KeyPressAwaiter {
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(EmulatorTask::handle_t handle) {
+      scheduler.m_blocked[&emulator] = handle;
+    }
+    void await_resume() const noexcept {}
+
+    CooperativeScheduler& scheduler;
+    Emulator& emulator;
+  };
+
+  EmulatorTask execute(Emulator& emulator, std::size_t n_frames);
+
+ private:
+  std::size_t m_cycle_budget;
+  std::size_t m_n_finished;
+  std::vector<EmulatorTask> m_tasks;
+  std::deque<EmulatorTask::handle_t> m_ready;
+  std::unordered_map<Emulator*, EmulatorTask::handle_t> m_blocked;
+};
+
+}  // namespace chip8
+#endif  // MODULES_SCHEDULER_COOPERATIVE_SCHEDULER_H_
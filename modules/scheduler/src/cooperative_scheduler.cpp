@@ -0,0 +1,139 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <utility>
+
+#include "scheduler/cooperative_scheduler.h"
+
+#include "emulator/emulator.h"
+
+namespace chip8 {
+
+static bool areTimersRunning(const Emulator& emulator) {
+  return emulator.getState().delay_timer_reg != 0 ||
+         emulator.getState().sound_timer_reg != 0;
+}
+
+EmulatorTask EmulatorTask::promise_type::get_return_object() {
+  return EmulatorTask(handle_t::from_promise(*this));
+}
+
+EmulatorTask::EmulatorTask(EmulatorTask&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, nullptr)) {}
+
+EmulatorTask& EmulatorTask::operator=(EmulatorTask&& other) noexcept {
+  if (this != &other) {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+    m_handle = std::exchange(other.m_handle, nullptr);
+  }
+  return *this;
+}
+
+EmulatorTask::~EmulatorTask() {
+  if (m_handle) {
+    m_handle.destroy();
+  }
+}
+
+CooperativeScheduler::CooperativeScheduler(std::size_t cycle_budget)
+    : m_cycle_budget(std::max<std::size_t>(cycle_budget, 1)),
+      m_n_finished(0) {}
+
+void CooperativeScheduler::spawn(Emulator& emulator, std::size_t n_frames) {
+  m_tasks.push_back(execute(emulator, n_frames));
+  m_ready.push_back(m_tasks.back().handle());
+}
+
+bool CooperativeScheduler::notifyInput(Emulator& emulator) {
+  auto blocked_task = m_blocked.find(&emulator);
+  if (blocked_task == m_blocked.end()) {
+    return false;
+  }
+
+  m_ready.push_back(blocked_task->second);
+  m_blocked.erase(blocked_task);
+  return true;
+}
+
+std::size_t CooperativeScheduler::runOnce() {
+  // Tasks yielding during this pass are queued for the next one
+  std::size_t n_resumed = m_ready.size();
+  for (std::size_t i = 0; i < n_resumed; ++i) {
+    EmulatorTask::handle_t task = m_ready.front();
+    m_ready.pop_front();
+    task.resume();
+
+    if (task.done()) {
+      ++m_n_finished;
+      if (task.promise().exception) {
+        std::rethrow_exception(task.promise().exception);
+      }
+    }
+  }
+
+  return n_resumed;
+}
+
+void CooperativeScheduler::run() {
+  while (!m_ready.empty()) {
+    runOnce();
+  }
+}
+
+EmulatorTask CooperativeScheduler::execute(Emulator& emulator,
+                                           std::size_t n_frames) {
+  std::size_t budget = m_cycle_budget;
+  for (std::size_t frame = 0; frame < n_frames; ++frame) {
+    for (std::size_t cycle = 0; cycle < CYCLES_PER_FRAME; ++cycle) {
+      if (budget == 0) {
+        co_await YieldAwaiter{*this};
+        budget = m_cycle_budget;
+      }
+
+      // Sleep until the inputs change instead of polling them once the wait
+      // is the only thing left running, the poll is then the next cycle
+      if (emulator.isWaitingForKey() && !areTimersRunning(emulator)) {
+        co_await KeyPressAwaiter{*this, emulator};
+        budget = m_cycle_budget;
+      }
+
+      emulator.step();
+      --budget;
+    }
+
+    emulator.updateTimers();
+
+    if (frame + 1 < n_frames) {
+      co_await YieldAwaiter{*this};
+      budget = m_cycle_budget;
+    }
+  }
+}
+
+}  // namespace chip8
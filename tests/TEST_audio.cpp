@@ -0,0 +1,178 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "audio/audio_ring_buffer.h"
+#include "audio/audio_sink.h"
+#include "audio/beeper.h"
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+
+using namespace chip8;
+
+TEST(AudioRingBuffer, samplesAreReadInOrderAcrossTheEnd) {
+  AudioRingBuffer ring(6);
+  EXPECT_EQ(ring.getCapacity(), 8u);
+
+  std::vector<int16_t> samples(6);
+  std::iota(samples.begin(), samples.end(), 1);
+  std::vector<int16_t> read(8);
+  ASSERT_EQ(ring.write(samples.data(), 6), 6u);
+  ASSERT_EQ(ring.read(read.data(), 4), 4u);
+
+  // Wraps around the end of the ring
+  ASSERT_EQ(ring.write(samples.data(), 6), 6u);
+  EXPECT_EQ(ring.countAvailable(), 8u);
+  ASSERT_EQ(ring.read(read.data(), 10), 8u);
+  EXPECT_EQ(read, (std::vector<int16_t>{5, 6, 1, 2, 3, 4, 5, 6}));
+  EXPECT_EQ(ring.read(read.data(), 1), 0u);
+}
+
+TEST(AudioRingBuffer, writesToAFullRingAreDropped) {
+  AudioRingBuffer ring(4);
+  const std::vector<int16_t> samples{1, 2, 3, 4, 5, 6};
+
+  EXPECT_EQ(ring.write(samples.data(), samples.size()), 4u);
+  EXPECT_EQ(ring.write(samples.data(), 1), 0u);
+  EXPECT_EQ(ring.countDropped(), 3u);
+}
+
+TEST(AudioRingBuffer, consumerThreadReadsEverySampleOnce) {
+  AudioRingBuffer ring(64);
+  const int16_t n_samples = 20000;
+
+  std::thread consumer([&]() {
+    int16_t expected = 0;
+    int16_t samples[16];
+    while (expected < n_samples) {
+      const std::size_t n_read = ring.read(samples, 16);
+      for (std::size_t i = 0; i < n_read; ++i) {
+        ASSERT_EQ(samples[i], expected++);
+      }
+    }
+  });
+
+  // Retry the samples dropped while the ring is full
+  for (int16_t sample = 0; sample < n_samples;) {
+    sample += static_cast<int16_t>(ring.write(&sample, 1));
+  }
+  consumer.join();
+}
+
+TEST(Beeper, framesHaveTheSamplesOfSixtiethOfSecond) {
+  AudioRingBuffer ring(1 << 16);
+  Beeper beeper(44100);
+
+  std::size_t n_samples = 0;
+  for (int frame = 0; frame < 60; ++frame) {
+    n_samples += beeper.generateFrame(frame % 2 == 0, ring);
+  }
+
+  EXPECT_EQ(n_samples, 44100u);
+  EXPECT_EQ(ring.countAvailable(), 44100u);
+}
+
+TEST(Beeper, squareWaveWhileSoundingOnlyElseSilence) {
+  AudioRingBuffer ring(1 << 12);
+  Beeper beeper(4800, 600, 1000);
+  std::vector<int16_t> samples(80);
+
+  ASSERT_EQ(beeper.generateFrame(true, ring), 80u);
+  ring.read(samples.data(), samples.size());
+  // Eight samples per period
+  EXPECT_EQ(samples[0], 1000);
+  EXPECT_EQ(samples[3], 1000);
+  EXPECT_EQ(samples[4], -1000);
+  EXPECT_EQ(samples[8], 1000);
+
+  beeper.generateFrame(false, ring);
+  ring.read(samples.data(), samples.size());
+  EXPECT_EQ(samples, std::vector<int16_t>(80, 0));
+}
+
+TEST(AudioSink, drainMovesTheRingToTheSink) {
+  AudioRingBuffer ring(4096);
+  Beeper beeper(48000);
+  NullAudioSink sink;
+
+  beeper.generateFrame(true, ring);
+  beeper.generateFrame(true, ring);
+  EXPECT_EQ(drainAudio(ring, sink), 1600u);
+  EXPECT_EQ(sink.countSamples(), 1600u);
+  EXPECT_EQ(ring.countAvailable(), 0u);
+}
+
+TEST(AudioSink, wavFileHoldsTheSamples) {
+  const std::string path = ::testing::TempDir() + "beeper.wav";
+  {
+    WavAudioSink sink(path, 8000);
+    ASSERT_TRUE(sink.isOpen());
+    const std::vector<int16_t> samples{1, -2, 3};
+    sink.write(samples.data(), samples.size());
+    EXPECT_TRUE(sink.close());
+  }
+
+  std::ifstream file(path, std::ios_base::binary);
+  const std::string content{std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>()};
+  std::remove(path.c_str());
+
+  ASSERT_EQ(content.size(), 44u + 6u);
+  EXPECT_EQ(content.substr(0, 4), "RIFF");
+  EXPECT_EQ(content[4], 36 + 6);
+  EXPECT_EQ(content.substr(8, 8), "WAVEfmt ");
+  EXPECT_EQ(content.substr(36, 4), "data");
+  EXPECT_EQ(content[40], 6);
+  EXPECT_EQ(content.substr(44), std::string("\x01\x00\xFE\xFF\x03\x00", 6));
+}
+
+TEST(SoundTimer, countsDownWithTheFrames) {
+  std::istringstream rom(std::string{
+      '\x60', '\x03',  // 0x200: V0 = 3
+      '\xF0', '\x18',  // 0x202: sound timer = V0
+      '\x12', '\x04'   // 0x204: jump to 0x204
+  });
+  BitmaskUserInputController keypad;
+  Emulator emulator(rom, &keypad);
+
+  emulator.step();
+  emulator.step();
+  EXPECT_EQ(emulator.getState().sound_timer_reg, 3);
+  for (int frame = 0; frame < 5; ++frame) {
+    emulator.updateTimers();
+  }
+  EXPECT_EQ(emulator.getState().sound_timer_reg, 0);
+}
@@ -0,0 +1,157 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "chip8/chip8.h"
+
+// LD V1, 0x05 then LD F, V1 then DRW V0, V0, 5 then JP 0x206
+static const std::vector<uint8_t> DRAW_ROM = {0x61, 0x05, 0xF1, 0x29,
+                                              0xD0, 0x05, 0x12, 0x06};
+
+class TestCApiFixture : public ::testing::Test {
+ protected:
+  TestCApiFixture() : instance(chip8_create()) {}
+  ~TestCApiFixture() override { chip8_destroy(instance); }
+
+  chip8_instance* instance;
+};
+
+TEST_F(TestCApiFixture, abiVersion) {
+  EXPECT_EQ(chip8_abi_version(), CHIP8_ABI_VERSION);
+}
+
+TEST_F(TestCApiFixture, runFramesRequiresRom) {
+  EXPECT_EQ(chip8_run_frames(instance, 1), CHIP8_ERROR_NO_ROM);
+}
+
+TEST_F(TestCApiFixture, rejectTooLargeRom) {
+  std::vector<uint8_t> rom(CHIP8_RAM_SIZE - 0x200 + 1, 0);
+
+  EXPECT_EQ(chip8_load_rom(instance, rom.data(), rom.size()),
+            CHIP8_ERROR_ROM_TOO_LARGE);
+}
+
+TEST_F(TestCApiFixture, rejectNullInstance) {
+  EXPECT_EQ(chip8_load_rom(nullptr, DRAW_ROM.data(), DRAW_ROM.size()),
+            CHIP8_ERROR_INVALID_ARGUMENT);
+  EXPECT_EQ(chip8_run_frames(nullptr, 1), CHIP8_ERROR_INVALID_ARGUMENT);
+}
+
+TEST_F(TestCApiFixture, accessorsAcceptNullInstance) {
+  chip8_set_keys(nullptr, 0x0001);
+
+  EXPECT_EQ(chip8_ram(nullptr), nullptr);
+  EXPECT_EQ(chip8_registers(nullptr), nullptr);
+  EXPECT_EQ(chip8_framebuffer(nullptr), nullptr);
+  EXPECT_EQ(chip8_program_counter(nullptr), 0);
+  EXPECT_EQ(chip8_index_register(nullptr), 0);
+  EXPECT_EQ(chip8_delay_timer(nullptr), 0);
+  EXPECT_EQ(chip8_sound_timer(nullptr), 0);
+}
+
+TEST_F(TestCApiFixture, loadAndRunRom) {
+  ASSERT_EQ(chip8_load_rom(instance, DRAW_ROM.data(), DRAW_ROM.size()),
+            CHIP8_OK);
+
+  EXPECT_EQ(chip8_run_frames(instance, 2), CHIP8_OK);
+
+  EXPECT_EQ(chip8_ram(instance)[0x200], 0x61);
+  EXPECT_EQ(chip8_registers(instance)[1], 0x05);
+  EXPECT_EQ(chip8_program_counter(instance), 0x206);
+  EXPECT_EQ(chip8_index_register(instance), 25);
+  // First line of the "5" sprite is 0xF0
+  EXPECT_EQ(chip8_framebuffer(instance)[3], 1);
+  EXPECT_EQ(chip8_framebuffer(instance)[4], 0);
+}
+
+TEST_F(TestCApiFixture, pointersAreStableAcrossLoads) {
+  const uint8_t* ram = chip8_ram(instance);
+  const uint8_t* framebuffer = chip8_framebuffer(instance);
+  chip8_load_rom(instance, DRAW_ROM.data(), DRAW_ROM.size());
+  chip8_run_frames(instance, 1);
+
+  chip8_load_rom(instance, DRAW_ROM.data(), DRAW_ROM.size());
+
+  EXPECT_EQ(chip8_ram(instance), ram);
+  EXPECT_EQ(chip8_framebuffer(instance), framebuffer);
+  // Loading resets the machine
+  EXPECT_EQ(framebuffer[0], 0);
+  EXPECT_EQ(chip8_program_counter(instance), 0x200);
+}
+
+TEST_F(TestCApiFixture, keysAreSeenByTheProgram) {
+  // LD V1, K then JP 0x202
+  std::vector<uint8_t> rom = {0xF1, 0x0A, 0x12, 0x02};
+  chip8_load_rom(instance, rom.data(), rom.size());
+
+  chip8_set_keys(instance, 0x0008);
+  chip8_run_frames(instance, 1);
+
+  EXPECT_EQ(chip8_registers(instance)[1], 0x3);
+}
+
+TEST(TestCApiVectorEnvironment, stepEnvironments) {
+  const chip8_vec_env_config config = {1, CHIP8_VEC_ENV_BIT_PACKED, 0,
+                                       nullptr, 0, nullptr, 0};
+  chip8_vec_env* env =
+      chip8_vec_env_create(DRAW_ROM.data(), DRAW_ROM.size(), 2, &config);
+  ASSERT_NE(env, nullptr);
+  ASSERT_EQ(chip8_vec_env_observation_size(env),
+            CHIP8_DISPLAY_WIDTH * CHIP8_DISPLAY_HEIGHT / 8);
+
+  std::vector<uint8_t> observations(2 * chip8_vec_env_observation_size(env));
+  std::vector<uint16_t> actions(2, 0);
+  std::vector<float> rewards(2);
+  std::vector<uint8_t> dones(2);
+  EXPECT_EQ(chip8_vec_env_reset(env, nullptr, observations.data()), CHIP8_OK);
+  EXPECT_EQ(chip8_vec_env_step(env, actions.data(), observations.data(),
+                               rewards.data(), dones.data()),
+            CHIP8_OK);
+
+  // First line of the "5" sprite is 0xF0
+  EXPECT_EQ(observations[0], 0xF0);
+  EXPECT_EQ(observations[chip8_vec_env_observation_size(env)], 0xF0);
+
+  chip8_vec_env_destroy(env);
+}
+
+TEST(TestCApiVectorEnvironment, rejectInvalidConfig) {
+  const chip8_terminal_condition condition = {0x1000, 0};
+  const chip8_vec_env_config config = {1, 0, 0, nullptr, 0, &condition, 1};
+
+  EXPECT_EQ(chip8_vec_env_create(DRAW_ROM.data(), DRAW_ROM.size(), 1, &config),
+            nullptr);
+}
+
+TEST(TestCApiVectorEnvironment, rejectMissingRewards) {
+  const chip8_vec_env_config config = {1, 0, 0, nullptr, 1, nullptr, 0};
+
+  EXPECT_EQ(chip8_vec_env_create(DRAW_ROM.data(), DRAW_ROM.size(), 1, &config),
+            nullptr);
+}
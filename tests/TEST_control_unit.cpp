@@ -488,6 +488,43 @@ TEST_F(TestControlUnitFixture, readMultipleRegisters) {
   EXPECT_EQ(registers[2], 3);
 }
 
+TEST_F(TestControlUnitFixture, readMultipleRegistersWrapsAroundRam) {
+  index_reg = 0xFFF;
+  ram[0xFFF] = 1;
+  ram[0x0] = 2;
+
+  ctrl_unit.readMultipleRegister(register_id_t(1));
+
+  EXPECT_EQ(registers[0], 1);
+  EXPECT_EQ(registers[1], 2);
+}
+
+TEST_F(TestControlUnitFixture, storeBCDRepresentationWrapsAroundRam) {
+  index_reg = 0xFFE;
+  registers[1] = 123;
+
+  ctrl_unit.storeBCDRepresentation(register_id_t(1));
+
+  EXPECT_EQ(ram[0xFFE], 1);
+  EXPECT_EQ(ram[0xFFF], 2);
+  EXPECT_EQ(ram[0x0], 3);
+}
+
+TEST_F(TestControlUnitFixture, stackPointerWrapsAround) {
+  stack_ptr = 0xF;
+  pc = 0x4;
+
+  ctrl_unit.callSubroutineAt(address_t(0x300));
+
+  EXPECT_EQ(stack_ptr, 0x0);
+  EXPECT_EQ(stack[0], 0x4);
+
+  ctrl_unit.returnFromSubroutine();
+
+  EXPECT_EQ(stack_ptr, 0xF);
+  EXPECT_EQ(pc, 0x4);
+}
+
 TEST_F(TestControlUnitFixture, setSpriteLocation) {
   index_reg = 0x2;
   registers[2] = 0xA;
@@ -498,15 +535,55 @@ TEST_F(TestControlUnitFixture, setSpriteLocation) {
 }
 
 TEST(TestUniformRandomGeneration, checkMean) {
-  UniformRandomNumberGenerator rand_generator(0, 10);
+  const RandomPolicy policy = RandomPolicy::of<Pcg32>();
+  RandomState random_state{};
+  policy.seed(random_state, 0);
 
   // If we generate enough numbers the mean of the generated samples should be
   // half of the interval. It is only a rough mean of testing my random number
   // generation
   int sum = 0;
   for (int i = 0; i < 1000; ++i) {
-    sum += rand_generator.generateNumber();
+    sum += policy.next(random_state) % 11;
   }
 
   EXPECT_NEAR(static_cast<double>(sum) / 1000, 5, 0.3);
-}
\ No newline at end of file
+}
+
+TEST_F(TestControlUnitFixture, randomValueIsMaskedAndSeedable) {
+  ctrl_unit.seedRandomNumberGenerator(42);
+  ctrl_unit.registerEqualRandomValue(0x0F, register_id_t(3));
+  uint8_t first_value = registers[3];
+
+  ctrl_unit.seedRandomNumberGenerator(42);
+  ctrl_unit.registerEqualRandomValue(0x0F, register_id_t(3));
+
+  EXPECT_EQ(registers[3], first_value);
+  EXPECT_EQ(registers[3] & 0xF0, 0);
+}
+
+TEST_F(TestControlUnitFixture, randomStateIsPartOfTheMachine) {
+  ctrl_unit.seedRandomNumberGenerator(42);
+  const RandomState snapshot = random_state;
+  ctrl_unit.registerEqualRandomValue(0xFF, register_id_t(0));
+  uint8_t first_value = registers[0];
+
+  random_state = snapshot;
+  ctrl_unit.registerEqualRandomValue(0xFF, register_id_t(0));
+
+  EXPECT_EQ(registers[0], first_value);
+}
+
+TEST_F(TestControlUnitFixture, randomPolicyIsPluggable) {
+  ControlUnitImpl xorshift_ctrl_unit(
+      pc, stack_ptr, index_reg, delay_timer_reg, sound_timer_reg, stack,
+      registers, ram, display_ctrler, ui_ctrler, random_state,
+      RandomPolicy::of<Xorshift128Plus>());
+  RandomState expected_state{};
+  Xorshift128Plus::seed(expected_state, 7);
+
+  xorshift_ctrl_unit.seedRandomNumberGenerator(7);
+  xorshift_ctrl_unit.registerEqualRandomValue(0xFF, register_id_t(0));
+
+  EXPECT_EQ(registers[0], Xorshift128Plus::next(expected_state) >> 24);
+}
@@ -0,0 +1,169 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <array>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/emulator.h"
+#include "emulator/user_input.h"
+#include "scheduler/cooperative_scheduler.h"
+
+using namespace chip8;
+
+// JP 0x200
+static const std::string LOOP_ROM = {'\x12', '\x00'};
+// LD V1, K then JP 0x202
+static const std::string WAIT_FOR_KEY_ROM = {'\xF1', '\x0A', '\x12', '\x02'};
+// LD V0, 3 then LD DT, V0 then LD V1, K then JP 0x206
+static const std::string TIMED_WAIT_FOR_KEY_ROM = {
+    '\x60', '\x03', '\xF0', '\x15', '\xF1', '\x0A', '\x12', '\x06'};
+
+// fixtures.h pulls ublas which does not build in C++20
+class ArrayUserInputController : public UserInputController {
+ public:
+  ArrayUserInputController() { m_inputs_state.fill(InputState::OFF); }
+
+  void setInputState(InputId input_id, InputState input_state) {
+    m_inputs_state[static_cast<std::size_t>(input_id)] = input_state;
+  }
+
+  std::optional<InputState> getInputState(InputId input_id) override {
+    return m_inputs_state[static_cast<std::size_t>(input_id)];
+  }
+
+ private:
+  std::array<InputState, static_cast<std::size_t>(InputId::INPUT_SIZE)>
+      m_inputs_state;
+};
+
+struct HeadlessEmulator {
+  explicit HeadlessEmulator(const std::string& program)
+      : rom(program), emulator(rom, &ui_ctrler) {}
+
+  std::istringstream rom;
+  ArrayUserInputController ui_ctrler;
+  Emulator emulator;
+};
+
+TEST(CooperativeScheduler, runAllTasksToCompletion) {
+  HeadlessEmulator first(LOOP_ROM);
+  HeadlessEmulator second(LOOP_ROM);
+  CooperativeScheduler scheduler(CYCLES_PER_FRAME);
+  scheduler.spawn(first.emulator, 5);
+  scheduler.spawn(second.emulator, 5);
+
+  scheduler.run();
+
+  EXPECT_EQ(scheduler.countFinished(), 2);
+  EXPECT_EQ(scheduler.countReady(), 0);
+}
+
+TEST(CooperativeScheduler, tasksYieldAtFrameBoundary) {
+  HeadlessEmulator first(LOOP_ROM);
+  HeadlessEmulator second(LOOP_ROM);
+  CooperativeScheduler scheduler(CYCLES_PER_FRAME);
+  scheduler.spawn(first.emulator, 2);
+  scheduler.spawn(second.emulator, 2);
+
+  auto n_resumed = scheduler.runOnce();
+
+  EXPECT_EQ(n_resumed, 2);
+  EXPECT_EQ(scheduler.countFinished(), 0);
+  EXPECT_EQ(scheduler.countReady(), 2);
+
+  scheduler.runOnce();
+
+  EXPECT_EQ(scheduler.countFinished(), 2);
+}
+
+TEST(CooperativeScheduler, taskYieldsWhenBudgetIsExhausted) {
+  HeadlessEmulator headless(LOOP_ROM);
+  CooperativeScheduler scheduler(3);
+  scheduler.spawn(headless.emulator, 1);
+
+  std::size_t n_passes = 0;
+  while (scheduler.countFinished() == 0) {
+    scheduler.runOnce();
+    ++n_passes;
+  }
+
+  // 10 instructions by slices of 3
+  EXPECT_EQ(n_passes, 4);
+}
+
+TEST(CooperativeScheduler, taskBlocksUntilKeyIsPressed) {
+  HeadlessEmulator headless(WAIT_FOR_KEY_ROM);
+  CooperativeScheduler scheduler(CYCLES_PER_FRAME);
+  scheduler.spawn(headless.emulator, 2);
+
+  scheduler.run();
+
+  EXPECT_EQ(scheduler.countBlocked(), 1);
+  EXPECT_EQ(scheduler.countFinished(), 0);
+  EXPECT_TRUE(headless.emulator.isWaitingForKey());
+
+  headless.ui_ctrler.setInputState(InputId::INPUT_1, InputState::ON);
+  EXPECT_TRUE(scheduler.notifyInput(headless.emulator));
+  scheduler.run();
+
+  EXPECT_EQ(scheduler.countBlocked(), 0);
+  EXPECT_EQ(scheduler.countFinished(), 1);
+  EXPECT_FALSE(headless.emulator.isWaitingForKey());
+  EXPECT_EQ(headless.emulator.countCycles(), 2 * CYCLES_PER_FRAME);
+}
+
+TEST(CooperativeScheduler, timersRunUntilTheTaskBlocks) {
+  HeadlessEmulator headless(TIMED_WAIT_FOR_KEY_ROM);
+  CooperativeScheduler scheduler(CYCLES_PER_FRAME);
+  scheduler.spawn(headless.emulator, 10);
+
+  scheduler.run();
+
+  // Blocked as soon as the delay timer stopped, at the end of the third frame
+  EXPECT_EQ(scheduler.countBlocked(), 1);
+  EXPECT_EQ(headless.emulator.getState().delay_timer_reg, 0);
+  EXPECT_EQ(headless.emulator.countFrames(), 3);
+  EXPECT_EQ(headless.emulator.countCycles(), 3 * CYCLES_PER_FRAME);
+
+  headless.ui_ctrler.setInputState(InputId::INPUT_1, InputState::ON);
+  scheduler.notifyInput(headless.emulator);
+  scheduler.run();
+
+  EXPECT_EQ(scheduler.countFinished(), 1);
+  EXPECT_EQ(headless.emulator.countFrames(), 10);
+  EXPECT_EQ(headless.emulator.countCycles(), 10 * CYCLES_PER_FRAME);
+}
+
+TEST(CooperativeScheduler, notifyInputIgnoresRunningTask) {
+  HeadlessEmulator headless(LOOP_ROM);
+  CooperativeScheduler scheduler(CYCLES_PER_FRAME);
+  scheduler.spawn(headless.emulator, 1);
+
+  EXPECT_FALSE(scheduler.notifyInput(headless.emulator));
+}
@@ -0,0 +1,282 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// linux
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "batch/coordinator.h"
+#include "batch/job.h"
+#include "emulator/input_movie.h"
+
+using namespace chip8;
+
+class TestCoordinatorFixture : public ::testing::Test {
+ protected:
+  TestCoordinatorFixture()
+      : directory(std::filesystem::temp_directory_path() /
+                  ("chip8_batch_" + std::to_string(getpid()))) {
+    std::filesystem::create_directories(directory);
+    // JP 0x200
+    loop_rom = writeFile("loop.ch8", {0x12, 0x00});
+    // LD V1, K then ADD V2, 1 then JP 0x202
+    wait_key_rom = writeFile("wait_key.ch8", {0xF1, 0x0A, 0x72, 0x01, 0x12,
+                                              0x02});
+  }
+
+  ~TestCoordinatorFixture() override {
+    std::filesystem::remove_all(directory);
+  }
+
+  std::string writeFile(const std::string& name,
+                        const std::vector<uint8_t>& bytes) {
+    std::string path = (directory / name).string();
+    std::ofstream file(path, std::ios_base::binary);
+    file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    return path;
+  }
+
+  std::filesystem::path directory;
+  std::string loop_rom;
+  std::string wait_key_rom;
+};
+
+TEST(JobMessage, jobRoundTrip) {
+  Job job{"rom.ch8", "movie.bin", 42, 30};
+
+  Job decoded_job;
+  bool success = decodeJob(encodeJob(job), decoded_job);
+
+  EXPECT_TRUE(success);
+  EXPECT_EQ(decoded_job.rom_path, "rom.ch8");
+  EXPECT_EQ(decoded_job.movie_path, "movie.bin");
+  EXPECT_EQ(decoded_job.n_frames, 42);
+  EXPECT_EQ(decoded_job.cycles_per_frame, 30);
+}
+
+TEST(JobMessage, resultRoundTrip) {
+  JobResult result{true, "", 0x1234, 0x5678, 10, 20, 1};
+
+  JobResult decoded_result;
+  bool success = decodeJobResult(encodeJobResult(result), decoded_result);
+
+  EXPECT_TRUE(success);
+  EXPECT_TRUE(decoded_result.success);
+  EXPECT_EQ(decoded_result.final_state_hash, 0x1234);
+  EXPECT_EQ(decoded_result.frames_hash, 0x5678);
+}
+
+TEST(JobMessage, truncatedMessageIsRejected) {
+  auto message = encodeJob(Job{"rom.ch8", "", 1});
+  message.pop_back();
+
+  Job job;
+  EXPECT_FALSE(decodeJob(message, job));
+}
+
+TEST_F(TestCoordinatorFixture, runJobIsDeterministic) {
+  Job job{loop_rom, "", 3};
+
+  auto first_result = runJob(job);
+  auto second_result = runJob(job);
+
+  EXPECT_TRUE(first_result.success);
+  EXPECT_EQ(first_result.n_instructions, 30);
+  EXPECT_EQ(first_result.final_state_hash, second_result.final_state_hash);
+  EXPECT_EQ(first_result.frames_hash, second_result.frames_hash);
+}
+
+TEST_F(TestCoordinatorFixture, runJobRunsAtTheSpeedOfTheJob) {
+  auto default_speed = runJob(Job{loop_rom, "", 3});
+  auto fast = runJob(Job{loop_rom, "", 3, 25});
+
+  EXPECT_TRUE(fast.success);
+  EXPECT_EQ(default_speed.n_instructions, 30);
+  EXPECT_EQ(fast.n_instructions, 75);
+}
+
+TEST_F(TestCoordinatorFixture, runJobReplaysMovie) {
+  std::ofstream movie_file((directory / "movie.bin").string(),
+                           std::ios_base::binary);
+  InputMovie({0x0000, 0x0002}).save(movie_file);
+  movie_file.close();
+
+  auto without_movie = runJob(Job{wait_key_rom, "", 3});
+  auto with_movie =
+      runJob(Job{wait_key_rom, (directory / "movie.bin").string(), 3});
+
+  EXPECT_TRUE(with_movie.success);
+  EXPECT_NE(with_movie.final_state_hash, without_movie.final_state_hash);
+}
+
+TEST_F(TestCoordinatorFixture, runJobReplaysEventsAtTheirCycle) {
+  std::ofstream movie_file((directory / "events.bin").string(),
+                           std::ios_base::binary);
+  InputMovie({0x0000, 0x0000}).save(movie_file);
+  movie_file.close();
+  auto runWithKeyPressedAt = [&](uint64_t cycle) {
+    std::ofstream events_file((directory / "events.bin.events").string(),
+                              std::ios_base::binary);
+    saveInputEvents(events_file, {{cycle, InputId::INPUT_1, InputState::ON}},
+                    0);
+    events_file.close();
+    return runJob(Job{wait_key_rom, (directory / "events.bin").string(), 2});
+  };
+
+  auto early_press = runWithKeyPressedAt(3);
+  auto late_press = runWithKeyPressedAt(7);
+
+  EXPECT_TRUE(early_press.success);
+  EXPECT_TRUE(late_press.success);
+  EXPECT_NE(early_press.final_state_hash, late_press.final_state_hash);
+  EXPECT_EQ(early_press.final_state_hash,
+            runWithKeyPressedAt(3).final_state_hash);
+}
+
+TEST_F(TestCoordinatorFixture, runJobReplaysRandomNumbersFromSeed) {
+  // RND V0, 0xFF then LD I, 0x300 then LD [I], V0 then JP 0x200
+  auto random_rom =
+      writeFile("random.ch8", {0xC0, 0xFF, 0xA3, 0x00, 0xF0, 0x55, 0x12, 0x00});
+  std::ofstream movie_file((directory / "seeded.bin").string(),
+                           std::ios_base::binary);
+  InputMovie({}, 1234).save(movie_file);
+  movie_file.close();
+  Job job{random_rom, (directory / "seeded.bin").string(), 10};
+
+  auto first_result = runJob(job);
+  auto second_result = runJob(job);
+
+  EXPECT_TRUE(first_result.success);
+  EXPECT_EQ(first_result.final_state_hash, second_result.final_state_hash);
+}
+
+TEST_F(TestCoordinatorFixture, runJobReportsMissingRom) {
+  auto result = runJob(Job{(directory / "missing.ch8").string(), "", 1});
+
+  EXPECT_FALSE(result.success);
+  EXPECT_FALSE(result.error.empty());
+}
+
+TEST_F(TestCoordinatorFixture, workersMatchInProcessExecution) {
+  std::vector<Job> jobs;
+  for (uint64_t n_frames = 1; n_frames <= 5; ++n_frames) {
+    jobs.push_back(Job{n_frames % 2 ? loop_rom : wait_key_rom, "", n_frames});
+  }
+  Coordinator coordinator(2);
+
+  auto results = coordinator.run(jobs);
+
+  ASSERT_EQ(results.size(), jobs.size());
+  for (std::size_t i = 0; i < jobs.size(); ++i) {
+    auto expected = runJob(jobs[i]);
+    EXPECT_TRUE(results[i].success);
+    EXPECT_EQ(results[i].final_state_hash, expected.final_state_hash);
+    EXPECT_EQ(results[i].frames_hash, expected.frames_hash);
+    EXPECT_EQ(results[i].n_attempts, 1);
+  }
+}
+
+TEST_F(TestCoordinatorFixture, crashedJobIsRetriedOnNewWorker) {
+  std::string marker = (directory / "crashed_once").string();
+  // The first worker running the job crashes, the next one succeeds
+  Coordinator coordinator(
+      2, 3, [marker](const Job& job, MachineState& state) {
+        if (!std::filesystem::exists(marker)) {
+          std::ofstream{marker};
+          std::abort();
+        }
+        return runJob(job, state);
+      });
+
+  auto results = coordinator.run({Job{loop_rom, "", 2}});
+
+  EXPECT_TRUE(results[0].success);
+  EXPECT_EQ(results[0].n_attempts, 2);
+  EXPECT_EQ(coordinator.countRestarts(), 1);
+}
+
+TEST_F(TestCoordinatorFixture, jobCrashingEveryWorkerIsReportedAsFailed) {
+  Coordinator coordinator(2, 2, [](const Job& job, MachineState& state) {
+    if (job.n_frames == 0) {
+      std::abort();
+    }
+    return runJob(job, state);
+  });
+
+  auto results =
+      coordinator.run({Job{loop_rom, "", 0}, Job{loop_rom, "", 1}});
+
+  EXPECT_FALSE(results[0].success);
+  EXPECT_EQ(results[0].n_attempts, 2);
+  EXPECT_TRUE(results[1].success);
+}
+
+TEST_F(TestCoordinatorFixture, stalledJobIsKilledAndReportedAsFailed) {
+  Coordinator coordinator(
+      2, 2,
+      [](const Job& job, MachineState& state) {
+        // A job of 0 frames hangs its worker
+        while (job.n_frames == 0) {
+          pause();
+        }
+        return runJob(job, state);
+      },
+      std::chrono::milliseconds(100));
+
+  auto results =
+      coordinator.run({Job{loop_rom, "", 0}, Job{loop_rom, "", 1}});
+
+  EXPECT_FALSE(results[0].success);
+  EXPECT_EQ(results[0].error, "job timed out");
+  EXPECT_EQ(results[0].n_attempts, 2);
+  EXPECT_TRUE(results[1].success);
+  EXPECT_EQ(coordinator.countRestarts(), 2);
+}
+
+TEST_F(TestCoordinatorFixture, workersReuseTheirMachineState) {
+  Coordinator coordinator(1, 1, [](const Job& job, MachineState& state) {
+    // Report where the state of the worker lives
+    JobResult result = runJob(job, state);
+    result.n_instructions = reinterpret_cast<uintptr_t>(&state);
+    return result;
+  });
+
+  auto results =
+      coordinator.run({Job{loop_rom, "", 1}, Job{wait_key_rom, "", 1}});
+
+  ASSERT_TRUE(results[0].success);
+  ASSERT_TRUE(results[1].success);
+  EXPECT_EQ(results[0].n_instructions, results[1].n_instructions);
+}
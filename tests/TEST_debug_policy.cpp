@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/debug_policy.h"
+#include "emulator/emulator.h"
+
+using namespace chip8;
+
+static const std::string PROGRAM{
+    '\xA3', '\x00',  // 0x200: I = 0x300
+    '\x60', '\x7B',  // 0x202: V0 = 123
+    '\xF0', '\x33',  // 0x204: BCD of V0 at I
+    '\xF2', '\x65',  // 0x206: V0..V2 = I..I+2
+    '\xD0', '\x13',  // 0x208: draw 3 bytes from I
+    '\xF1', '\x55',  // 0x20A: I..I+1 = V0..V1
+    '\x12', '\x0C'   // 0x20C: jump to 0x20C
+};
+
+class TestDebugPolicy : public ::testing::Test {
+ protected:
+  TestDebugPolicy() : rom(PROGRAM), emulator(rom, &keypad) {}
+
+  // Step until the policy stops, at most a few instructions
+  bool runUntilStop() {
+    for (int i = 0; i < 20; ++i) {
+      if (!emulator.step(policy)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  std::istringstream rom;
+  BitmaskUserInputController keypad;
+  Emulator emulator;
+  BreakpointPolicy policy;
+};
+
+TEST_F(TestDebugPolicy, noDebugPolicyNeverStops) {
+  NoDebugPolicy no_debug;
+
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_TRUE(emulator.step(no_debug));
+  }
+  EXPECT_EQ(emulator.getState().pc, 0x20C);
+}
+
+TEST_F(TestDebugPolicy, stopsBeforeBreakpoints) {
+  policy.addBreakpoint(0x206);
+
+  ASSERT_TRUE(runUntilStop());
+  EXPECT_EQ(emulator.getState().pc, 0x206);
+  EXPECT_EQ(policy.getEvent(), DebugEvent::BREAKPOINT);
+  EXPECT_EQ(policy.getEventAddress(), 0x206);
+
+  // The instruction is not executed until the breakpoint is stepped over
+  EXPECT_FALSE(emulator.step(policy));
+  emulator.step();
+  policy.removeBreakpoint(0x206);
+  EXPECT_FALSE(runUntilStop());
+}
+
+TEST_F(TestDebugPolicy, stopsOnOpcodeClasses) {
+  policy.addOpcodeBreakpoint(0xD);
+
+  ASSERT_TRUE(runUntilStop());
+  EXPECT_EQ(emulator.getState().pc, 0x208);
+  EXPECT_EQ(policy.getEvent(), DebugEvent::OPCODE_BREAKPOINT);
+}
+
+TEST_F(TestDebugPolicy, stopsOnWriteWatchpoints) {
+  policy.addWriteWatchpoint(0x302);
+
+  ASSERT_TRUE(runUntilStop());
+  EXPECT_EQ(emulator.getState().pc, 0x204);
+  EXPECT_EQ(policy.getEvent(), DebugEvent::WRITE_WATCHPOINT);
+  EXPECT_EQ(policy.getEventAddress(), 0x302);
+
+  // Fx55 only writes I..I+1
+  emulator.step();
+  EXPECT_FALSE(runUntilStop());
+}
+
+TEST_F(TestDebugPolicy, stopsOnReadWatchpoints) {
+  policy.addReadWatchpoint(0x301);
+
+  ASSERT_TRUE(runUntilStop());
+  EXPECT_EQ(emulator.getState().pc, 0x206);
+  EXPECT_EQ(policy.getEvent(), DebugEvent::READ_WATCHPOINT);
+
+  // Dxyn reads the sprite from I
+  emulator.step();
+  ASSERT_TRUE(runUntilStop());
+  EXPECT_EQ(emulator.getState().pc, 0x208);
+  EXPECT_EQ(policy.getEventAddress(), 0x301);
+}
+
+TEST(BreakpointPolicy, watchedRangesWrapAroundTheRam) {
+  BreakpointPolicy policy;
+  MachineState state;
+  state.index_reg = 0xFFF;
+  policy.addWriteWatchpoint(0x1);
+
+  EXPECT_TRUE(policy.check(state, 0xF033));
+  EXPECT_EQ(policy.getEventAddress(), 0x1);
+  EXPECT_FALSE(policy.check(state, 0xF155));
+  EXPECT_EQ(policy.getEvent(), DebugEvent::NONE);
+}
+
+TEST(BreakpointPolicy, addressesWrapAroundTheRam) {
+  BreakpointPolicy policy;
+  MachineState state;
+  state.pc = 0x202;
+  state.index_reg = 0x300;
+  policy.addBreakpoint(0x1202);
+  policy.addWriteWatchpoint(0xF300);
+
+  EXPECT_TRUE(policy.check(state, 0x6000));
+  EXPECT_EQ(policy.getEvent(), DebugEvent::BREAKPOINT);
+
+  policy.removeBreakpoint(0x1202);
+  EXPECT_TRUE(policy.check(state, 0xF033));
+  EXPECT_EQ(policy.getEventAddress(), 0x300);
+
+  policy.removeWriteWatchpoint(0x300);
+  EXPECT_FALSE(policy.check(state, 0xF033));
+}
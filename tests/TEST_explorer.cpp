@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/emulator.h"
+#include "emulator/input_movie.h"
+
+#include "explorer/explorer.h"
+#include "explorer/work_stealing_pool.h"
+
+using namespace chip8;
+
+// Combination lock: key 5, release, then key 3 writes 1 at 0x300
+static const std::vector<uint8_t> LOCK_ROM = {
+    0xF1, 0x0A,  // 0x200: LD V1, K
+    0x41, 0x05,  // 0x202: SNE V1, 5
+    0x12, 0x08,  // 0x204: JP 0x208
+    0x12, 0x00,  // 0x206: JP 0x200
+    0xE1, 0xA1,  // 0x208: SKNP V1
+    0x12, 0x08,  // 0x20A: JP 0x208
+    0xF2, 0x0A,  // 0x20C: LD V2, K
+    0x42, 0x03,  // 0x20E: SNE V2, 3
+    0x12, 0x14,  // 0x210: JP 0x214
+    0x12, 0x00,  // 0x212: JP 0x200
+    0xA3, 0x00,  // 0x214: LD I, 0x300
+    0x60, 0x01,  // 0x216: LD V0, 1
+    0xF0, 0x55,  // 0x218: LD [I], V0
+    0x12, 0x1A   // 0x21A: JP 0x21A
+};
+
+static ExplorerConfig makeConfig(SearchStrategy strategy,
+                                 std::size_t n_workers) {
+  return ExplorerConfig{2,
+                        4,
+                        10000,
+                        n_workers,
+                        strategy,
+                        [](const RAM& ram) { return ram[0x300]; },
+                        [](const RAM& ram) { return ram[0x300] == 1; }};
+}
+
+TEST(WorkStealingPool, runEveryTask) {
+  WorkStealingPool pool(3);
+  std::atomic<int> n_executed(0);
+  std::atomic<bool> valid_workers(true);
+
+  for (int batch = 0; batch < 10; ++batch) {
+    std::vector<WorkStealingPool::Task> tasks;
+    for (int i = 0; i < 20; ++i) {
+      tasks.emplace_back([&](std::size_t worker) {
+        valid_workers = valid_workers && worker < 3;
+        ++n_executed;
+      });
+    }
+    pool.run(std::move(tasks));
+  }
+
+  EXPECT_EQ(n_executed, 200);
+  EXPECT_TRUE(valid_workers);
+}
+
+TEST(Explorer, breadthFirstFindsCombination) {
+  Explorer explorer(LOCK_ROM, makeConfig(SearchStrategy::BREADTH_FIRST, 2));
+
+  auto result = explorer.run();
+
+  EXPECT_TRUE(result.goal_reached);
+  EXPECT_EQ(result.max_depth, 2);
+  ASSERT_EQ(result.movie.size(), 4);
+  EXPECT_EQ(result.movie.getKeys(0), 0x0020);
+  EXPECT_EQ(result.movie.getKeys(2), 0x0008);
+}
+
+TEST(Explorer, movieReplaysToTheGoal) {
+  Explorer explorer(LOCK_ROM, makeConfig(SearchStrategy::BEST_FIRST, 2));
+  auto result = explorer.run();
+  ASSERT_TRUE(result.goal_reached);
+
+  std::istringstream rom(std::string(LOCK_ROM.begin(), LOCK_ROM.end()));
+  InputMoviePlayer player(result.movie);
+  Emulator emulator(rom, &player);
+  while (!player.isFinished()) {
+    emulator.runFrame();
+    player.nextFrame();
+  }
+
+  EXPECT_EQ(emulator.getState().ram[0x300], 1);
+}
+
+TEST(Explorer, resultDoesNotDependOnWorkers) {
+  auto config = makeConfig(SearchStrategy::BREADTH_FIRST, 1);
+  config.goal = nullptr;
+  config.max_depth = 3;
+  Explorer single_explorer(LOCK_ROM, config);
+  config.n_workers = 4;
+  Explorer parallel_explorer(LOCK_ROM, config);
+
+  auto single_result = single_explorer.run();
+  auto parallel_result = parallel_explorer.run();
+
+  EXPECT_FALSE(single_result.goal_reached);
+  EXPECT_EQ(single_result.n_states, parallel_result.n_states);
+  EXPECT_EQ(single_result.n_expanded, parallel_result.n_expanded);
+  EXPECT_EQ(single_result.best_score, 1);
+  EXPECT_EQ(single_result.movie.size(), parallel_result.movie.size());
+}
+
+TEST(Explorer, stopAtMaxStates) {
+  auto config = makeConfig(SearchStrategy::BREADTH_FIRST, 2);
+  config.goal = nullptr;
+  config.max_states = 5;
+  Explorer explorer(LOCK_ROM, config);
+
+  auto result = explorer.run();
+
+  EXPECT_EQ(result.n_states, 5);
+}
@@ -0,0 +1,146 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/state_hash.h"
+
+#include "fuzz/fuzz_harness.h"
+
+using namespace chip8;
+
+static std::vector<uint8_t> makeInput(const std::vector<uint8_t>& rom,
+                                      const std::vector<uint16_t>& frames) {
+  std::vector<uint8_t> input{static_cast<uint8_t>(rom.size()),
+                             static_cast<uint8_t>(rom.size() >> 8)};
+  input.insert(input.end(), rom.begin(), rom.end());
+  for (uint16_t keys : frames) {
+    input.push_back(static_cast<uint8_t>(keys));
+    input.push_back(static_cast<uint8_t>(keys >> 8));
+  }
+  return input;
+}
+
+class TestFuzzHarness : public ::testing::Test {
+ protected:
+  TestFuzzHarness() : harness(counters.data(), counters.size()) {}
+
+  void run(const std::vector<uint8_t>& input) {
+    harness.run(input.data(), input.size());
+  }
+
+  std::size_t countEdges() const {
+    return std::count_if(counters.begin(), counters.end(),
+                         [](uint8_t counter) { return counter != 0; });
+  }
+
+  std::array<uint8_t, 1 << 12> counters{};
+  FuzzHarness harness;
+};
+
+TEST_F(TestFuzzHarness, runsAreResetToThePristineMachine) {
+  // Draw a sprite then store random values in the RAM
+  const auto input_a = makeInput(
+      {0x60, 0x05, 0xD0, 0x05, 0xC1, 0xFF, 0xA3, 0x00, 0xF1, 0x55, 0x12, 0x0A},
+      {0, 0});
+  // Overwrite the sprites
+  const auto input_b =
+      makeInput({0xA0, 0x00, 0x60, 0x42, 0xFF, 0x55, 0x12, 0x06}, {0});
+
+  run(input_a);
+  const uint64_t expected_hash = hashState(harness.getState());
+  run(input_b);
+  run(input_a);
+
+  EXPECT_EQ(hashState(harness.getState()), expected_hash);
+}
+
+TEST_F(TestFuzzHarness, movieDrivesTheKeypad) {
+  // Wait for a key then loop
+  run(makeInput({0xF0, 0x0A, 0x12, 0x02}, {0, 1 << 5}));
+
+  EXPECT_EQ(harness.getState().registers[0], 5);
+  EXPECT_EQ(harness.getState().pc, 0x202);
+}
+
+TEST_F(TestFuzzHarness, indexRegisterAccessesWrapAroundTheRam) {
+  // I = 0xFFF then read, draw, BCD and store from it
+  run(makeInput({0xAF, 0xFF, 0xF2, 0x65, 0xD0, 0x15, 0xF2, 0x33, 0xF2, 0x55,
+                 0x12, 0x0A},
+                {0}));
+
+  const MachineState& state = harness.getState();
+  EXPECT_EQ(state.registers[1], 0xF0);
+  EXPECT_EQ(state.registers[2], 0x90);
+  EXPECT_EQ(state.ram[0x0], 0xF0);
+  EXPECT_EQ(state.ram[0xFFF], 0x0);
+  EXPECT_EQ(state.pc, 0x20A);
+  // The incrementally maintained hash saw the wrapped writes
+  EXPECT_EQ(harness.getEmulator().getMemoryHash(),
+            IncrementalStateHash::hashMemory(state));
+}
+
+TEST_F(TestFuzzHarness, hostileProgramsStayInsideTheMachine) {
+  // Unbounded recursion, return with an empty stack and jump to the last byte
+  for (const auto& rom : std::vector<std::vector<uint8_t>>{
+           {0x22, 0x00}, {0x00, 0xEE}, {0x1F, 0xFF}, {0xBF, 0xFF}}) {
+    run(makeInput(rom, std::vector<uint16_t>(10, 0xFFFF)));
+
+    EXPECT_LT(harness.getState().stack_ptr, Stack::size());
+  }
+}
+
+TEST_F(TestFuzzHarness, coverageIsReportedOnPcOpcodeEdges) {
+  // A jump on itself executes a single edge
+  run(makeInput({0x12, 0x00}, {0}));
+  EXPECT_EQ(countEdges(), 2u);
+
+  // Counters are cleared between runs
+  run(makeInput({0x60, 0x01, 0x61, 0x02, 0x62, 0x03, 0x12, 0x00}, {0}));
+  EXPECT_EQ(countEdges(), 5u);
+}
+
+TEST_F(TestFuzzHarness, truncatedInputsAreAccepted) {
+  const std::vector<uint8_t> input{0xFF, 0xFF, 0x12};
+
+  harness.run(nullptr, 0);
+  harness.run(input.data(), 1);
+  harness.run(input.data(), input.size());
+
+  EXPECT_EQ(harness.getState().ram[0x200], 0x12);
+}
+
+TEST(FuzzHarness, rejectMissingEdgeCounters) {
+  std::array<uint8_t, 1> counters{};
+
+  EXPECT_THROW(FuzzHarness(counters.data(), 0), std::invalid_argument);
+  EXPECT_THROW(FuzzHarness(nullptr, 1), std::invalid_argument);
+}
@@ -0,0 +1,129 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/emulator.h"
+#include "emulator/input_event_queue.h"
+
+using namespace chip8;
+using namespace std::chrono_literals;
+
+// Count in V0 until key 5 is pressed, three instructions per count
+static const std::string COUNT_UNTIL_KEY_PROGRAM{
+    '\x61', '\x05',  // 0x200: V1 = 5
+    '\x70', '\x01',  // 0x202: V0 += 1
+    '\xE1', '\xA1',  // 0x204: skip next if key V1 is not pressed
+    '\x12', '\x06',  // 0x206: jump to 0x206
+    '\x12', '\x02'   // 0x208: jump to 0x202
+};
+
+static uint8_t countUntilKey(InputEventQueue& queue) {
+  std::istringstream rom(COUNT_UNTIL_KEY_PROGRAM);
+  Emulator emulator(rom, &queue);
+  emulator.setInputEventQueue(&queue);
+  for (int frame = 0; frame < 10; ++frame) {
+    emulator.runFrame();
+  }
+  return emulator.getState().registers[0];
+}
+
+TEST(InputEventQueue, eventsAreAppliedAtTheirCycle) {
+  InputEventQueue queue(600);
+  queue.push({4, InputId::INPUT_3, InputState::ON});
+  queue.push({4, InputId::INPUT_5, InputState::ON});
+  queue.push({9, InputId::INPUT_3, InputState::OFF});
+
+  queue.advanceTo(3);
+  EXPECT_EQ(queue.getKeys(), 0);
+  queue.advanceTo(4);
+  EXPECT_EQ(queue.getKeys(), 0x0028);
+  EXPECT_EQ(queue.getInputState(InputId::INPUT_5), InputState::ON);
+  queue.advanceTo(20);
+  EXPECT_EQ(queue.getKeys(), 0x0020);
+  EXPECT_EQ(queue.countPending(), 0u);
+  EXPECT_EQ(queue.getLog().size(), 3u);
+  EXPECT_FALSE(queue.getInputState(InputId::INPUT_ERROR));
+}
+
+TEST(InputEventQueue, eventsCannotBeAppliedInThePast) {
+  InputEventQueue queue(600);
+  queue.advanceTo(10);
+  queue.push({2, InputId::INPUT_1, InputState::ON});
+  queue.push({20, InputId::INPUT_1, InputState::OFF});
+  queue.push({15, InputId::INPUT_2, InputState::ON});
+
+  queue.advanceTo(30);
+
+  ASSERT_EQ(queue.getLog().size(), 3u);
+  EXPECT_EQ(queue.getLog()[0].cycle, 10u);
+  EXPECT_EQ(queue.getLog()[1].cycle, 20u);
+  EXPECT_EQ(queue.getLog()[2].cycle, 20u);
+}
+
+TEST(InputEventQueue, hostEventsKeepTheirSpacing) {
+  InputEventQueue queue(600);
+  const InputEventQueue::time_point start;
+  queue.sync(start, 0);
+
+  queue.pushHostEvent(InputId::INPUT_7, InputState::OFF, start + 15ms);
+  queue.pushHostEvent(InputId::INPUT_7, InputState::ON, start + 5ms);
+  queue.pushHostEvent(InputId::INPUT_8, InputState::ON, start + 20ms);
+  queue.sync(start + 16ms, 10);
+  EXPECT_EQ(queue.countPending(), 2u);
+
+  queue.advanceTo(100);
+  ASSERT_EQ(queue.getLog().size(), 2u);
+  EXPECT_EQ(queue.getLog()[0],
+            (InputEvent{13, InputId::INPUT_7, InputState::ON}));
+  EXPECT_EQ(queue.getLog()[1],
+            (InputEvent{19, InputId::INPUT_7, InputState::OFF}));
+
+  queue.sync(start + 32ms, 120);
+  queue.advanceTo(200);
+  EXPECT_EQ(queue.getLog().back(),
+            (InputEvent{122, InputId::INPUT_8, InputState::ON}));
+}
+
+TEST(InputEventQueue, emulatorReadsTheKeysAtTheExactCycle) {
+  InputEventQueue queue(600);
+  queue.push({50, InputId::INPUT_5, InputState::ON});
+  const uint8_t count = countUntilKey(queue);
+
+  InputEventQueue replay_queue(600);
+  for (const auto& event : queue.getLog()) {
+    replay_queue.push(event);
+  }
+  EXPECT_EQ(countUntilKey(replay_queue), count);
+
+  InputEventQueue later_queue(600);
+  later_queue.push({53, InputId::INPUT_5, InputState::ON});
+  EXPECT_EQ(countUntilKey(later_queue), count + 1);
+}
@@ -0,0 +1,137 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <chrono>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/frame_buffer_model.h"
+#include "emulator/input_latency.h"
+
+using namespace chip8;
+using namespace std::chrono_literals;
+
+TEST(LatencyHistogram, countsDurationsInLogarithmicBuckets) {
+  LatencyHistogram histogram;
+
+  histogram.record(500ns);
+  histogram.record(3us);
+  histogram.record(3500us);
+  histogram.record(1h);
+
+  EXPECT_EQ(histogram.countSamples(), 4u);
+  EXPECT_EQ(histogram.getBucket(0), 1u);
+  EXPECT_EQ(histogram.getBucket(1), 1u);
+  EXPECT_EQ(histogram.getBucket(11), 1u);
+  EXPECT_EQ(histogram.getBucket(LatencyHistogram::N_BUCKETS - 1), 1u);
+  EXPECT_EQ(histogram.getBucketLowerBound(11), 2048us);
+  EXPECT_EQ(histogram.getMax(), 1h);
+}
+
+TEST(LatencyHistogram, percentileIsTheUpperBoundOfItsBucket) {
+  LatencyHistogram histogram;
+  EXPECT_EQ(histogram.getPercentile(0.5), 0us);
+
+  for (int i = 0; i < 99; ++i) {
+    histogram.record(10us);
+  }
+  histogram.record(10ms);
+
+  EXPECT_EQ(histogram.getPercentile(0.5), 16us);
+  EXPECT_EQ(histogram.getPercentile(0.98), 16us);
+  EXPECT_EQ(histogram.getPercentile(1.0), 16384us);
+  EXPECT_EQ(histogram.getMean(), 109900ns);
+
+  std::ostringstream stream;
+  histogram.print(stream);
+  EXPECT_NE(stream.str().find("100 samples"), std::string::npos);
+
+  histogram.reset();
+  EXPECT_EQ(histogram.countSamples(), 0u);
+}
+
+class TestInputLatencyTracker : public ::testing::Test {
+ protected:
+  TestInputLatencyTracker()
+      : framebuffer{},
+        display(framebuffer),
+        tracker(keypad, [this]() { return now; }) {}
+
+  InputLatencyTracker::time_point now;
+  BitmaskUserInputController keypad;
+  FrameBuffer framebuffer;
+  FrameBufferModel display;
+  InputLatencyTracker tracker;
+};
+
+TEST_F(TestInputLatencyTracker, measuresEventToGuestAndToScreen) {
+  const auto event_time = now;
+  tracker.keyEvent(InputId::INPUT_5, InputState::ON, event_time);
+
+  // The guest reads the key before the front end forwarded it
+  now += 1ms;
+  tracker.getInputState(InputId::INPUT_5);
+  EXPECT_EQ(tracker.getObserveLatency().countSamples(), 0u);
+
+  now += 1ms;
+  keypad.setKeys(1 << 5);
+  EXPECT_EQ(*tracker.getInputState(InputId::INPUT_5), InputState::ON);
+  EXPECT_EQ(tracker.getObserveLatency().countSamples(), 1u);
+  EXPECT_EQ(tracker.getObserveLatency().getMax(), 2ms);
+
+  // Observed only once
+  tracker.getInputState(InputId::INPUT_5);
+  EXPECT_EQ(tracker.getObserveLatency().countSamples(), 1u);
+
+  // Unchanged frames do not display the event
+  tracker.framePresented(display, event_time + 5ms);
+  EXPECT_EQ(tracker.getPresentLatency().countSamples(), 0u);
+
+  display.setPixelValue(column_t(3), row_t(4), 1);
+  tracker.framePresented(display, event_time + 20ms);
+  tracker.framePresented(display, event_time + 30ms);
+  display.setPixelValue(column_t(3), row_t(4), 0);
+  tracker.framePresented(display, event_time + 40ms);
+
+  EXPECT_EQ(tracker.getPresentLatency().countSamples(), 1u);
+  EXPECT_EQ(tracker.getPresentLatency().getMax(), 20ms);
+}
+
+TEST_F(TestInputLatencyTracker, dropsEventsSupersededBeforeObserved) {
+  tracker.keyEvent(InputId::INPUT_A, InputState::ON, now);
+  tracker.keyEvent(InputId::INPUT_A, InputState::OFF, now + 1ms);
+  now += 4ms;
+  tracker.getInputState(InputId::INPUT_A);
+
+  EXPECT_EQ(tracker.countDroppedEvents(), 1u);
+  EXPECT_EQ(tracker.getObserveLatency().countSamples(), 1u);
+  EXPECT_EQ(tracker.getObserveLatency().getMax(), 3ms);
+
+  tracker.keyEvent(InputId::INPUT_ERROR, InputState::ON, now);
+  EXPECT_FALSE(tracker.getInputState(InputId::INPUT_ERROR));
+}
@@ -0,0 +1,175 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/input_movie.h"
+
+using namespace chip8;
+
+TEST(InputMovie, getKeysOfRecordedFrames) {
+  InputMovie movie({0x0001, 0x8000});
+
+  EXPECT_EQ(movie.getKeys(0), 0x0001);
+  EXPECT_EQ(movie.getKeys(1), 0x8000);
+  EXPECT_EQ(movie.size(), 2);
+}
+
+TEST(InputMovie, noKeyPressedAfterTheEnd) {
+  InputMovie movie({0x0001});
+
+  EXPECT_EQ(movie.getKeys(5), 0x0);
+}
+
+TEST(InputMovie, saveAndLoad) {
+  InputMovie movie;
+  movie.append(0x1234);
+  movie.append(0x00FF);
+  std::stringstream stream;
+
+  movie.save(stream);
+  InputMovie loaded_movie;
+  bool success = loaded_movie.load(stream);
+
+  EXPECT_TRUE(success);
+  EXPECT_EQ(loaded_movie.size(), 2);
+  EXPECT_EQ(loaded_movie.getKeys(0), 0x1234);
+  EXPECT_EQ(loaded_movie.getKeys(1), 0x00FF);
+}
+
+TEST(InputMovie, saveSeedAndRuns) {
+  InputMovie movie(std::vector<uint16_t>(1000, 0x0004), 42);
+  movie.append(0x0000);
+  std::stringstream stream;
+
+  movie.save(stream);
+  InputMovie loaded_movie;
+  bool success = loaded_movie.load(stream);
+
+  EXPECT_TRUE(success);
+  // Header then two runs of 6 bytes
+  EXPECT_EQ(stream.str().size(), 14 + 2 * 6);
+  EXPECT_EQ(loaded_movie.getSeed(), 42);
+  EXPECT_EQ(loaded_movie.size(), 1001);
+  EXPECT_EQ(loaded_movie.getKeys(999), 0x0004);
+  EXPECT_EQ(loaded_movie.getKeys(1000), 0x0000);
+}
+
+TEST(InputMovie, truncatedMovieIsRejected) {
+  std::stringstream stream;
+  stream << char(0x01) << char(0x00) << char(0x02);
+  InputMovie movie;
+
+  EXPECT_FALSE(movie.load(stream));
+}
+
+TEST(InputMovie, tooLongMovieIsRejected) {
+  std::stringstream stream;
+  InputMovie({0x0001, 0x0002}).save(stream);
+  std::string content = stream.str();
+  // Length of the first run, after the 14 bytes of the header
+  content.replace(14, 4, "\xFF\xFF\xFF\xFF");
+  std::stringstream modified_stream(content);
+  InputMovie movie;
+
+  EXPECT_FALSE(movie.load(modified_stream));
+}
+
+TEST(InputMovie, unknownFormatIsRejected) {
+  std::stringstream stream;
+  InputMovie({0x0001}).save(stream);
+  std::string content = stream.str();
+  content[4] = 0x7F;
+  std::stringstream modified_stream(content);
+  InputMovie movie;
+
+  EXPECT_FALSE(movie.load(modified_stream));
+}
+
+TEST(InputEvents, saveThenLoadRestoresTheEvents) {
+  const std::vector<InputEvent> events{
+      {3, InputId::INPUT_4, InputState::ON},
+      {3, InputId::INPUT_F, InputState::ON},
+      {0x100000000, InputId::INPUT_4, InputState::OFF}};
+  std::stringstream stream;
+  saveInputEvents(stream, events, 77);
+
+  std::vector<InputEvent> loaded_events;
+  uint32_t seed = 0;
+  ASSERT_TRUE(loadInputEvents(stream, loaded_events, seed));
+  EXPECT_EQ(loaded_events, events);
+  EXPECT_EQ(seed, 77u);
+}
+
+TEST(InputEvents, loadFailsOnEventsOutOfOrder) {
+  std::stringstream stream;
+  saveInputEvents(stream,
+                  {{5, InputId::INPUT_1, InputState::ON},
+                   {4, InputId::INPUT_1, InputState::OFF}},
+                  0);
+  std::vector<InputEvent> events;
+  uint32_t seed = 0;
+
+  EXPECT_FALSE(loadInputEvents(stream, events, seed));
+  EXPECT_TRUE(events.empty());
+}
+
+TEST(InputMoviePlayer, keysFollowTheMovie) {
+  InputMovie movie({0x0001, 0x8000});
+  InputMoviePlayer player(movie);
+
+  EXPECT_EQ(player.getInputState(InputId::INPUT_0), InputState::ON);
+  player.nextFrame();
+  EXPECT_EQ(player.getInputState(InputId::INPUT_0), InputState::OFF);
+  EXPECT_EQ(player.getInputState(InputId::INPUT_F), InputState::ON);
+  EXPECT_FALSE(player.isFinished());
+  player.nextFrame();
+  EXPECT_TRUE(player.isFinished());
+  EXPECT_EQ(player.getInputState(InputId::INPUT_F), InputState::OFF);
+}
+
+TEST(InputMoviePlayer, readKeysOfController) {
+  InputMovie movie({0x8421});
+  InputMoviePlayer player(movie);
+
+  EXPECT_EQ(readKeys(player), 0x8421);
+}
+
+TEST(BitmaskUserInputController, keysFollowTheBitmask) {
+  BitmaskUserInputController ui_ctrler;
+
+  ui_ctrler.setKeys(0x8002);
+
+  EXPECT_EQ(ui_ctrler.getInputState(InputId::INPUT_1), InputState::ON);
+  EXPECT_EQ(ui_ctrler.getInputState(InputId::INPUT_F), InputState::ON);
+  EXPECT_EQ(ui_ctrler.getInputState(InputId::INPUT_0), InputState::OFF);
+  EXPECT_FALSE(ui_ctrler.getInputState(InputId::INPUT_ERROR).has_value());
+}
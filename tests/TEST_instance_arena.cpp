@@ -0,0 +1,91 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "fixtures.h"
+#include "emulator/emulator.h"
+#include "emulator/instance_arena.h"
+
+using namespace chip8;
+
+TEST(InstanceArena, statesAreAlignedOnCacheLines) {
+  InstanceArena arena(4);
+
+  for (std::size_t i = 0; i < 4; ++i) {
+    auto address = reinterpret_cast<std::uintptr_t>(arena.allocate());
+    EXPECT_EQ(address % CACHE_LINE_SIZE, 0);
+  }
+  EXPECT_EQ(arena.stride() % CACHE_LINE_SIZE, 0);
+  EXPECT_GE(arena.stride(), sizeof(MachineState));
+}
+
+TEST(InstanceArena, returnNullWhenFull) {
+  InstanceArena arena(2);
+  arena.allocate();
+  arena.allocate();
+
+  EXPECT_EQ(arena.allocate(), nullptr);
+  EXPECT_EQ(arena.size(), 2);
+}
+
+TEST(InstanceArena, releasedStateIsReused) {
+  InstanceArena arena(1);
+  MachineState* state = arena.allocate();
+  state->ram[0x300] = 0x42;
+
+  arena.release(state);
+  MachineState* reused = arena.allocate();
+
+  EXPECT_EQ(reused, state);
+  EXPECT_EQ(reused->ram[0x300], 0x0);
+}
+
+TEST(InstanceArena, emulatorRunsOnArenaState) {
+  InstanceArena arena(1);
+  MachineState* state = arena.allocate();
+  TestUserInputController ui_ctrler;
+  // LD V1, 0x05 then LD F, V1 then DRW V0, V0, 5
+  std::istringstream rom(
+      std::string{'\x61', '\x05', '\xF1', '\x29', '\xD0', '\x05'});
+  Emulator emulator(rom, &ui_ctrler, *state);
+
+  emulator.step();
+  emulator.step();
+  emulator.step();
+
+  EXPECT_EQ(state->registers[1], 0x05);
+  EXPECT_EQ(state->pc, 0x206);
+  // First line of the "5" sprite is 0xF0
+  EXPECT_EQ(state->framebuffer[0], 1);
+  EXPECT_EQ(state->framebuffer[4], 0);
+  EXPECT_EQ(emulator.getDisplayModel().getPixelValue(column_t(3), row_t(0)),
+            1);
+}
@@ -0,0 +1,120 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/ram_write_tracker.h"
+
+using namespace chip8;
+
+TEST(RamWriteTracker, writesMarkBytesAndPages) {
+  RamWriteTracker tracker;
+
+  tracker.markWritten(0x0);
+  tracker.markWritten(0x241);
+
+  EXPECT_TRUE(tracker.isDirty(0x0));
+  EXPECT_TRUE(tracker.isDirty(0x241));
+  EXPECT_FALSE(tracker.isDirty(0x240));
+  EXPECT_EQ(tracker.getDirtyPages(), uint64_t(1) | uint64_t(1) << 9);
+  EXPECT_EQ(tracker.getDirtyBytes(9), uint64_t(1) << 1);
+}
+
+TEST(RamWriteTracker, checkpointStartsANewEpoch) {
+  RamWriteTracker tracker;
+  tracker.markWritten(0x300);
+
+  const auto epoch = tracker.checkpoint();
+  EXPECT_EQ(tracker.getEpoch(), epoch);
+  EXPECT_FALSE(tracker.isDirty(0x300));
+  EXPECT_EQ(tracker.getDirtyPages(), 0u);
+  EXPECT_FALSE(tracker.isDirtySince(epoch, 0x300));
+  EXPECT_TRUE(tracker.isDirtySince(0, 0x300));
+
+  tracker.markWritten(0x400);
+  EXPECT_TRUE(tracker.isDirtySince(epoch, 0x400));
+}
+
+TEST(RamWriteTracker, dirtySinceEpochSpansSeveralCheckpoints) {
+  RamWriteTracker tracker;
+  const auto first = tracker.checkpoint();
+  tracker.markWritten(0x200);
+  const auto second = tracker.checkpoint();
+  tracker.markWritten(0x800);
+  tracker.checkpoint();
+
+  EXPECT_TRUE(tracker.isDirtySince(first, 0x200));
+  EXPECT_TRUE(tracker.isDirtySince(first, 0x800));
+  EXPECT_FALSE(tracker.isDirtySince(second, 0x200));
+  EXPECT_TRUE(tracker.isDirtySince(second, 0x800));
+  EXPECT_EQ(tracker.getDirtyPagesSince(first),
+            uint64_t(1) << 8 | uint64_t(1) << 32);
+  EXPECT_EQ(tracker.getDirtyPagesSince(second), uint64_t(1) << 32);
+
+  EXPECT_TRUE(tracker.isRangeDirtySince(second, 0x7F0, 0x20));
+  EXPECT_FALSE(tracker.isRangeDirtySince(second, 0x801, 0x100));
+  // The range wraps around the RAM
+  EXPECT_TRUE(tracker.isRangeDirtySince(first, 0xFFF, 0x202));
+}
+
+TEST(RamWriteTracker, resetForgetsEveryWrite) {
+  RamWriteTracker tracker;
+  tracker.markAll();
+  tracker.checkpoint();
+
+  tracker.reset();
+
+  EXPECT_EQ(tracker.getEpoch(), 0u);
+  EXPECT_EQ(tracker.getDirtyPagesSince(0), 0u);
+}
+
+TEST(RamWriteTracker, emulatorTracksStoreInstructions) {
+  // I = 0x300, BCD of V0 at I, store V0..V1 at I + 0x40 then loop
+  const std::string program{'\x60', '\x7B', '\xA3', '\x00', '\xF0', '\x33',
+                            '\x60', '\x40', '\xF0', '\x1E', '\xF1', '\x55',
+                            '\x12', '\x0C'};
+  std::istringstream rom(program);
+  BitmaskUserInputController keypad;
+  Emulator emulator(rom, &keypad);
+  RamWriteTracker& tracker = emulator.getRamWriteTracker();
+  EXPECT_EQ(tracker.getDirtyPages(), 0u);
+
+  emulator.runFrame();
+
+  EXPECT_EQ(tracker.getDirtyPages(), uint64_t(1) << 12 | uint64_t(1) << 13);
+  EXPECT_EQ(tracker.getDirtyBytes(12), 0b111u);
+  EXPECT_EQ(tracker.getDirtyBytes(13), 0b11u);
+
+  // Restoring a state may change any byte
+  tracker.checkpoint();
+  emulator.restoreState(MachineState(emulator.getState()));
+  EXPECT_EQ(tracker.getDirtyPages(), ~uint64_t(0));
+}
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/random.h"
+
+using namespace chip8;
+
+template <typename Generator>
+static std::vector<uint32_t> draw(uint64_t seed, std::size_t n) {
+  RandomState random_state{};
+  Generator::seed(random_state, seed);
+  std::vector<uint32_t> values;
+  for (std::size_t i = 0; i < n; ++i) {
+    values.push_back(Generator::next(random_state));
+  }
+  return values;
+}
+
+TEST(Pcg32, sameSeedSameSequence) {
+  EXPECT_EQ(draw<Pcg32>(42, 16), draw<Pcg32>(42, 16));
+  EXPECT_NE(draw<Pcg32>(42, 16), draw<Pcg32>(43, 16));
+}
+
+TEST(Pcg32, zeroStateIsValid) {
+  RandomState random_state{};
+
+  uint32_t first = Pcg32::next(random_state);
+  uint32_t second = Pcg32::next(random_state);
+  uint32_t third = Pcg32::next(random_state);
+
+  EXPECT_FALSE(first == second && second == third);
+}
+
+TEST(Xorshift128Plus, sameSeedSameSequence) {
+  EXPECT_EQ(draw<Xorshift128Plus>(0, 16), draw<Xorshift128Plus>(0, 16));
+  EXPECT_NE(draw<Xorshift128Plus>(0, 16), draw<Xorshift128Plus>(1, 16));
+}
+
+TEST(RandomBatch, matchIndependentGenerators) {
+  std::vector<RandomState> random_states(4);
+  for (std::size_t i = 0; i < random_states.size(); ++i) {
+    Pcg32::seed(random_states[i], i);
+  }
+  std::vector<uint32_t> values(random_states.size());
+
+  generateBatch<Pcg32>(random_states.data(), random_states.size(),
+                       values.data());
+  generateBatch<Pcg32>(random_states.data(), random_states.size(),
+                       values.data());
+
+  for (std::size_t i = 0; i < random_states.size(); ++i) {
+    EXPECT_EQ(values[i], draw<Pcg32>(i, 2)[1]);
+  }
+}
+
+TEST(RandomEngine, usableWithStandardDistributions) {
+  RandomEngine<Xorshift128Plus> engine(7);
+  std::uniform_int_distribution<int> distribution(0, 3);
+
+  for (int i = 0; i < 100; ++i) {
+    int value = distribution(engine);
+    EXPECT_GE(value, 0);
+    EXPECT_LE(value, 3);
+  }
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/rewind_buffer.h"
+#include "emulator/state_hash.h"
+
+using namespace chip8;
+
+static MachineState makeFrame(std::size_t frame) {
+  MachineState state;
+  storeSpriteInMemory(state.ram);
+  state.pc = static_cast<uint16_t>(0x200 + 2 * (frame % 100));
+  state.index_reg = static_cast<uint16_t>(frame);
+  state.delay_timer_reg = static_cast<uint8_t>(frame);
+  state.registers[frame % 16] = static_cast<uint8_t>(frame);
+  state.ram[0x300 + frame % 64] = static_cast<uint8_t>(frame);
+  state.framebuffer[frame % state.framebuffer.size()] = 1;
+  Pcg32::seed(state.random_state, frame / 8);
+  return state;
+}
+
+TEST(RewindBuffer, stepBackRestoresPreviousFrames) {
+  RewindBuffer buffer(100, 64 * 1024, 8);
+  for (std::size_t frame = 0; frame < 20; ++frame) {
+    buffer.push(makeFrame(frame));
+  }
+
+  MachineState state;
+  for (std::size_t frame = 19; frame > 0; --frame) {
+    ASSERT_TRUE(buffer.stepBack(state));
+    EXPECT_EQ(hashState(state), hashState(makeFrame(frame - 1)));
+  }
+  EXPECT_FALSE(buffer.stepBack(state));
+  EXPECT_EQ(buffer.size(), 1);
+}
+
+TEST(RewindBuffer, trackedWritesAreRestored) {
+  RewindBuffer buffer(100, 64 * 1024, 8);
+  RamWriteTracker ram_writes;
+  for (std::size_t frame = 0; frame < 20; ++frame) {
+    ram_writes.markWritten(0x300 + frame % 64);
+    buffer.push(makeFrame(frame), ram_writes);
+  }
+
+  MachineState state;
+  for (std::size_t frame = 19; frame > 0; --frame) {
+    ASSERT_TRUE(buffer.stepBack(state));
+    EXPECT_EQ(hashState(state), hashState(makeFrame(frame - 1)));
+  }
+}
+
+TEST(RewindBuffer, pagesNotWrittenSinceTheKeyframeAreSkipped) {
+  RewindBuffer buffer(100, 64 * 1024, 8);
+  RamWriteTracker ram_writes;
+  buffer.push(makeFrame(0), ram_writes);
+
+  // Written behind the back of the tracker
+  MachineState untracked = makeFrame(0);
+  untracked.ram[0x800] = 0xAB;
+  buffer.push(untracked, ram_writes);
+  buffer.push(makeFrame(0), ram_writes);
+
+  MachineState state;
+  ASSERT_TRUE(buffer.stepBack(state));
+  EXPECT_EQ(state.ram[0x800], makeFrame(0).ram[0x800]);
+}
+
+TEST(RewindBuffer, pushAfterStepBack) {
+  RewindBuffer buffer(100, 64 * 1024, 4);
+  for (std::size_t frame = 0; frame < 10; ++frame) {
+    buffer.push(makeFrame(frame));
+  }
+  MachineState state;
+  for (int i = 0; i < 5; ++i) {
+    buffer.stepBack(state);
+  }
+
+  buffer.push(makeFrame(100));
+  buffer.push(makeFrame(101));
+
+  ASSERT_TRUE(buffer.stepBack(state));
+  EXPECT_EQ(hashState(state), hashState(makeFrame(100)));
+  ASSERT_TRUE(buffer.stepBack(state));
+  EXPECT_EQ(hashState(state), hashState(makeFrame(4)));
+}
+
+TEST(RewindBuffer, dropOldestFramesWhenFull) {
+  RewindBuffer buffer(10, 64 * 1024, 4);
+  for (std::size_t frame = 0; frame < 25; ++frame) {
+    buffer.push(makeFrame(frame));
+  }
+
+  EXPECT_LE(buffer.size(), 10);
+  MachineState state;
+  std::size_t frame = 24;
+  while (buffer.stepBack(state)) {
+    --frame;
+    EXPECT_EQ(hashState(state), hashState(makeFrame(frame)));
+  }
+  EXPECT_GE(frame, 15);
+}
+
+TEST(RewindBuffer, dropOldestFramesWhenStorageIsFull) {
+  // Small storage which wraps around many times
+  RewindBuffer buffer(1000, 12 * 1024, 16);
+  const std::size_t memory_usage = buffer.memoryUsage();
+  for (std::size_t frame = 0; frame < 500; ++frame) {
+    buffer.push(makeFrame(frame));
+  }
+
+  EXPECT_EQ(buffer.memoryUsage(), memory_usage);
+  EXPECT_LT(buffer.size(), 500);
+  MachineState state;
+  std::size_t frame = 499;
+  while (buffer.stepBack(state)) {
+    --frame;
+    ASSERT_EQ(hashState(state), hashState(makeFrame(frame)));
+  }
+}
+
+TEST(RewindBuffer, tenMinutesFitInTwoMebibytes) {
+  RewindBuffer buffer(10 * 60 * 60, 1536 * 1024, 120);
+
+  EXPECT_LT(buffer.memoryUsage(), 2 * 1024 * 1024);
+}
+
+TEST(RewindBuffer, rejectInvalidSizes) {
+  EXPECT_THROW(RewindBuffer(0, 64 * 1024, 8), std::invalid_argument);
+  EXPECT_THROW(RewindBuffer(100, 16, 8), std::invalid_argument);
+  EXPECT_THROW(RewindBuffer(100, 64 * 1024, 0), std::invalid_argument);
+}
@@ -0,0 +1,261 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <deque>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+// linux
+#include <sys/socket.h>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+
+#include "netplay/rollback_session.h"
+#include "netplay/transport.h"
+
+using namespace chip8;
+
+// Sum the keys pressed and random values at 0x301
+static const std::string PROGRAM{
+    '\xF0', '\x0A',  // 0x200: V0 = next key pressed
+    '\x81', '\x04',  // 0x202: V1 += V0
+    '\xC2', '\xFF',  // 0x204: V2 = random
+    '\x81', '\x24',  // 0x206: V1 += V2
+    '\xA3', '\x00',  // 0x208: I = 0x300
+    '\xF1', '\x55',  // 0x20A: store V0..V1 at I
+    '\x12', '\x00'   // 0x20C: jump to 0x200
+};
+
+static const uint64_t SEED = 1234;
+
+static uint16_t firstPlayerKeys(uint64_t frame) {
+  return (frame / 7) % 3 == 0 ? 1 << ((frame / 7) % 16) : 0;
+}
+
+static uint16_t secondPlayerKeys(uint64_t frame) {
+  return (frame / 11) % 2 == 0 ? 1 << ((frame / 11 + 3) % 16) : 0;
+}
+
+// Hash of the machine running the frames with the keys of both players
+static uint64_t referenceHash(uint64_t n_frames) {
+  std::istringstream rom(PROGRAM);
+  BitmaskUserInputController keypad;
+  Emulator emulator(rom, &keypad);
+  emulator.seed(SEED);
+  for (uint64_t frame = 0; frame < n_frames; ++frame) {
+    keypad.setKeys(firstPlayerKeys(frame) | secondPlayerKeys(frame));
+    emulator.runFrame();
+  }
+  return emulator.stateHash();
+}
+
+/*!
+ * Deliver the packets a number of ticks after they are sent, and drop one
+ * packet out of drop_period
+ */
+class LaggyTransport : public Transport {
+ public:
+  LaggyTransport(Transport& transport, uint64_t delay, uint64_t drop_period)
+      : m_transport(transport),
+        m_delay(delay),
+        m_drop_period(drop_period),
+        m_now(0),
+        m_n_sent(0) {}
+
+  void send(const InputPacket& packet) override {
+    if (m_drop_period != 0 && ++m_n_sent % m_drop_period == 0) {
+      return;
+    }
+    m_pending.emplace_back(m_now + m_delay, packet);
+  }
+
+  bool receive(InputPacket& packet) override {
+    return m_transport.receive(packet);
+  }
+
+  void tick() {
+    ++m_now;
+    while (!m_pending.empty() && m_pending.front().first <= m_now) {
+      m_transport.send(m_pending.front().second);
+      m_pending.pop_front();
+    }
+  }
+
+ private:
+  Transport& m_transport;
+  uint64_t m_delay;
+  uint64_t m_drop_period;
+  uint64_t m_now;
+  uint64_t m_n_sent;
+  std::deque<std::pair<uint64_t, InputPacket>> m_pending;
+};
+
+class TestRollbackSession : public ::testing::Test {
+ protected:
+  TestRollbackSession()
+      : transports(InProcessTransport::makePair()),
+        first_rom(PROGRAM),
+        second_rom(PROGRAM) {}
+
+  // Run both sessions to the frame then wait for every input to be received
+  template <typename Tick>
+  void play(RollbackSession& first, RollbackSession& second, uint64_t n_frames,
+            Tick tick) {
+    while (first.getFrame() < n_frames || second.getFrame() < n_frames) {
+      tick();
+      if (first.getFrame() < n_frames) {
+        first.advanceFrame(firstPlayerKeys(first.getFrame()));
+      }
+      if (second.getFrame() < n_frames) {
+        second.advanceFrame(secondPlayerKeys(second.getFrame()));
+      }
+    }
+
+    while (first.getConfirmedFrame() < n_frames ||
+           second.getConfirmedFrame() < n_frames) {
+      tick();
+      first.poll();
+      second.poll();
+    }
+  }
+
+  std::pair<std::unique_ptr<InProcessTransport>,
+            std::unique_ptr<InProcessTransport>>
+      transports;
+  std::istringstream first_rom;
+  std::istringstream second_rom;
+};
+
+TEST_F(TestRollbackSession, sessionsStayInLockstep) {
+  RollbackSession first(first_rom, *transports.first, SEED);
+  RollbackSession second(second_rom, *transports.second, SEED);
+
+  play(first, second, 300, []() {});
+
+  EXPECT_EQ(first.getEmulator().stateHash(), referenceHash(300));
+  EXPECT_EQ(second.getEmulator().stateHash(), referenceHash(300));
+}
+
+TEST_F(TestRollbackSession, mispredictionsAreRolledBack) {
+  LaggyTransport first_transport(*transports.first, 4, 5);
+  LaggyTransport second_transport(*transports.second, 2, 7);
+  RollbackSession first(first_rom, first_transport, SEED);
+  RollbackSession second(second_rom, second_transport, SEED);
+
+  play(first, second, 600, [&first_transport, &second_transport]() {
+    first_transport.tick();
+    second_transport.tick();
+  });
+
+  EXPECT_GT(first.countRollbacks(), 0u);
+  EXPECT_GT(second.countResimulatedFrames(), 0u);
+  EXPECT_EQ(first.getEmulator().stateHash(), referenceHash(600));
+  EXPECT_EQ(second.getEmulator().stateHash(), referenceHash(600));
+}
+
+TEST_F(TestRollbackSession, localInputsHaveNoDelay) {
+  RollbackSession first(first_rom, *transports.first, SEED);
+
+  ASSERT_TRUE(first.advanceFrame(1 << 5));
+
+  EXPECT_EQ(first.getEmulator().getState().ram[0x300], 5);
+}
+
+TEST_F(TestRollbackSession, sessionWaitsForAPeerTooFarBehind) {
+  RollbackSession first(first_rom, *transports.first, SEED, 4);
+
+  for (int frame = 0; frame < 4; ++frame) {
+    EXPECT_TRUE(first.advanceFrame(0));
+  }
+  EXPECT_FALSE(first.advanceFrame(0));
+  EXPECT_EQ(first.getFrame(), 4u);
+
+  RollbackSession second(second_rom, *transports.second, SEED, 4);
+  second.advanceFrame(0);
+  EXPECT_TRUE(first.advanceFrame(0));
+}
+
+TEST_F(TestRollbackSession, predictionWindowIsValidated) {
+  EXPECT_THROW(RollbackSession(first_rom, *transports.first, SEED, 0),
+               std::invalid_argument);
+  EXPECT_THROW(RollbackSession(first_rom, *transports.first, SEED, 33),
+               std::invalid_argument);
+}
+
+TEST(SocketTransport, packetsGoThroughADatagramSocket) {
+  int sockets[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets), 0);
+  SocketTransport first(sockets[0]);
+  SocketTransport second(sockets[1]);
+
+  InputPacket sent{};
+  sent.first_frame = 70000;
+  sent.ack_frame = 69990;
+  sent.n_inputs = 3;
+  sent.keys = {0x1, 0x8000, 0x1234};
+  first.send(sent);
+
+  // A malformed datagram is dropped
+  const char garbage[] = "garbage";
+  ::send(sockets[0], garbage, sizeof(garbage), 0);
+
+  InputPacket received{};
+  ASSERT_TRUE(second.receive(received));
+  EXPECT_EQ(received.first_frame, sent.first_frame);
+  EXPECT_EQ(received.ack_frame, sent.ack_frame);
+  ASSERT_EQ(received.n_inputs, 3);
+  EXPECT_EQ(received.keys[1], 0x8000);
+  EXPECT_EQ(received.keys[2], 0x1234);
+  EXPECT_FALSE(second.receive(received));
+}
+
+TEST(SocketTransport, sessionsPlayOverSockets) {
+  int sockets[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_DGRAM, 0, sockets), 0);
+  SocketTransport first_transport(sockets[0]);
+  SocketTransport second_transport(sockets[1]);
+  std::istringstream first_rom(PROGRAM);
+  std::istringstream second_rom(PROGRAM);
+  RollbackSession first(first_rom, first_transport, SEED);
+  RollbackSession second(second_rom, second_transport, SEED);
+
+  for (uint64_t frame = 0; frame < 120; ++frame) {
+    ASSERT_TRUE(first.advanceFrame(firstPlayerKeys(frame)));
+    ASSERT_TRUE(second.advanceFrame(secondPlayerKeys(frame)));
+  }
+  first.poll();
+  second.poll();
+  first.poll();
+
+  EXPECT_EQ(first.getConfirmedFrame(), 120u);
+  EXPECT_EQ(first.getEmulator().stateHash(), referenceHash(120));
+  EXPECT_EQ(second.getEmulator().stateHash(), referenceHash(120));
+}
@@ -0,0 +1,173 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// linux
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "emulator/state_hash.h"
+#include "library/rom_analysis.h"
+#include "library/rom_index.h"
+
+using namespace chip8;
+
+namespace fs = std::filesystem;
+
+static const std::string WAIT_KEY_PROGRAM{
+    '\x22', '\x08',  // 0x200: call 0x208
+    '\xF0', '\x0A',  // 0x202: V0 = next key pressed
+    '\x12', '\x02',  // 0x204: jump to 0x202
+    '\xFF', '\xFF',  // 0x206: data
+    '\xC0', '\x0F',  // 0x208: V0 = random & 0x0F
+    '\x30', '\x00',  // 0x20A: skip next if V0 == 0
+    '\x00', '\xFF',  // 0x20C: high resolution
+    '\x00', '\xEE'   // 0x20E: return
+};
+
+static RomAnalysis analyze(const std::string& program) {
+  RAM ram;
+  std::copy(program.begin(), program.end(), ram.begin() + 0x200);
+  return analyzeRom(ram, program.size());
+}
+
+TEST(RomAnalysis, followsTheControlFlowFrom0x200) {
+  const RomAnalysis analysis = analyze(WAIT_KEY_PROGRAM);
+
+  EXPECT_EQ(analysis.n_reachable_instructions, 7u);
+  EXPECT_TRUE(analysis.isCode(0x20E));
+  EXPECT_FALSE(analysis.isCode(0x206));
+  EXPECT_EQ(analysis.variant, RomVariant::SUPER_CHIP);
+  EXPECT_EQ(analysis.features,
+            ROM_READS_KEYS | ROM_WAITS_FOR_KEY | ROM_USES_RANDOM);
+}
+
+TEST(RomAnalysis, pathsEndAtTheEndOfTheProgram) {
+  const RomAnalysis analysis = analyze(std::string{'\x60', '\x01', '\xF0'});
+
+  EXPECT_EQ(analysis.n_reachable_instructions, 1u);
+  EXPECT_EQ(analysis.variant, RomVariant::CHIP8);
+  EXPECT_EQ(analysis.features, 0u);
+}
+
+class TestRomIndex : public ::testing::Test {
+ protected:
+  TestRomIndex()
+      // Unique per process and test, as the tests may run in parallel
+      : directory(
+            fs::path(::testing::TempDir()) /
+            ("rom_library_" + std::to_string(getpid()) + "_" +
+             ::testing::UnitTest::GetInstance()->current_test_info()->name())),
+        index_path(directory.string() + ".idx") {
+    fs::remove_all(directory);
+    fs::create_directories(directory / "games");
+  }
+
+  ~TestRomIndex() override {
+    fs::remove_all(directory);
+    fs::remove(index_path);
+  }
+
+  std::string writeRom(const std::string& name, const std::string& content) {
+    const fs::path path = directory / name;
+    std::ofstream file(path, std::ios_base::binary);
+    file << content;
+    return fs::weakly_canonical(path).string();
+  }
+
+  fs::path directory;
+  std::string index_path;
+};
+
+TEST_F(TestRomIndex, scanIndexesTheRomsOfTheDirectories) {
+  const std::string path = writeRom("games/wait.ch8", WAIT_KEY_PROGRAM);
+  writeRom("games/notes.txt", "not a ROM");
+  writeRom("loop.CH8", std::string{'\x12', '\x00'});
+  writeRom("huge.ch8", std::string(0xE01, '\x00'));
+
+  RomIndex index;
+  const ScanStatistics statistics = index.scan({directory.string()}, 4);
+
+  EXPECT_EQ(statistics.n_roms, 2u);
+  EXPECT_EQ(statistics.n_analyzed, 2u);
+  EXPECT_EQ(statistics.n_errors, 0u);
+  ASSERT_EQ(index.size(), 2u);
+
+  const uint64_t hash =
+      hashBytes(WAIT_KEY_PROGRAM.data(), WAIT_KEY_PROGRAM.size());
+  const RomEntry* entry = index.findByHash(hash);
+  ASSERT_NE(entry, nullptr);
+  EXPECT_EQ(entry->path, path);
+  EXPECT_EQ(entry->size, WAIT_KEY_PROGRAM.size());
+  EXPECT_EQ(entry->analysis.variant, RomVariant::SUPER_CHIP);
+  EXPECT_EQ(index.findByPath(path), entry);
+}
+
+TEST_F(TestRomIndex, savedIndexSkipsTheUnchangedRoms) {
+  writeRom("games/wait.ch8", WAIT_KEY_PROGRAM);
+  const std::string path = writeRom("loop.ch8", std::string{'\x12', '\x00'});
+  const uint64_t loop_hash = hashBytes("\x12\x00", 2);
+  {
+    RomIndex index;
+    index.scan({directory.string()}, 2);
+    EXPECT_TRUE(index.setCyclesPerFrame(loop_hash, 30));
+    ASSERT_TRUE(index.save(index_path));
+  }
+
+  RomIndex index;
+  ASSERT_TRUE(index.load(index_path));
+  ASSERT_EQ(index.size(), 2u);
+  EXPECT_EQ(index.findByHash(loop_hash)->cycles_per_frame, 30u);
+
+  ScanStatistics statistics = index.scan({directory.string()}, 2);
+  EXPECT_EQ(statistics.n_roms, 2u);
+  EXPECT_EQ(statistics.n_analyzed, 0u);
+
+  // A modified ROM is analyzed again, a deleted one is removed
+  writeRom("loop.ch8", std::string{'\x12', '\x00', '\x00', '\xE0'});
+  fs::last_write_time(path, fs::last_write_time(path) + std::chrono::hours(1));
+  fs::remove(directory / "games/wait.ch8");
+  statistics = index.scan({directory.string()}, 2);
+
+  EXPECT_EQ(statistics.n_analyzed, 1u);
+  EXPECT_EQ(statistics.n_removed, 1u);
+  ASSERT_EQ(index.size(), 1u);
+  EXPECT_EQ(index.findByPath(path)->size, 4u);
+  EXPECT_EQ(index.findByHash(loop_hash), nullptr);
+}
+
+TEST_F(TestRomIndex, loadFailsOnCorruptedIndex) {
+  std::ofstream(index_path, std::ios_base::binary) << "C8RI garbage";
+  RomIndex index;
+
+  EXPECT_FALSE(index.load(index_path));
+  EXPECT_FALSE(index.load(index_path + ".missing"));
+}
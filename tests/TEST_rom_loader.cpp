@@ -21,7 +21,20 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+// std
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+// posix
+#include <unistd.h>
+
 #include "gtest/gtest.h"
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
 #include "emulator/memory.h"
 #include "emulator/rom_loader.h"
 
@@ -63,3 +76,159 @@ TEST(ROMLoader, testReadSimpleProgram) {
   EXPECT_EQ(ram[0x200], 0x00);
   EXPECT_EQ(ram[0x201], 0xE0);
 }
+
+// Stream over a pipe or a terminal, it cannot seek
+class NonSeekableBuffer : public std::streambuf {
+ public:
+  explicit NonSeekableBuffer(std::string data) : m_data(std::move(data)) {
+    setg(m_data.data(), m_data.data(), m_data.data() + m_data.size());
+  }
+
+ private:
+  std::string m_data;
+};
+
+static std::string writeTemporaryRom(const std::string& content) {
+  const std::string path = ::testing::TempDir() + "rom_loader_test.ch8";
+  std::ofstream file(path, std::ios_base::binary);
+  file << content;
+  return path;
+}
+
+TEST(ROMLoader, streamReportsTheSizeOfTheProgram) {
+  std::stringstream input_stream(
+      std::string(LOGO_EXAMPLE.begin(), LOGO_EXAMPLE.end()));
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromStream(ram, input_stream);
+
+  EXPECT_TRUE(result);
+  EXPECT_EQ(result.size, LOGO_EXAMPLE.size());
+  EXPECT_TRUE(result.error.empty());
+  EXPECT_EQ(ram[0x200 + LOGO_EXAMPLE.size() - 1], 0xE0);
+}
+
+TEST(ROMLoader, nonSeekableStreamIsReadByChunks) {
+  NonSeekableBuffer buffer(std::string(2000, '\x12'));
+  std::istream input_stream(&buffer);
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromStream(ram, input_stream);
+
+  EXPECT_TRUE(result);
+  EXPECT_EQ(result.size, 2000u);
+  EXPECT_EQ(ram[0x200 + 1999], 0x12);
+  EXPECT_EQ(ram[0x200 + 2000], 0x00);
+}
+
+TEST(ROMLoader, programFillingTheRamIsLoaded) {
+  std::stringstream input_stream(std::string(MAX_PROGRAM_SIZE, '\x01'));
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromStream(ram, input_stream);
+
+  EXPECT_TRUE(result);
+  EXPECT_EQ(result.size, MAX_PROGRAM_SIZE);
+  EXPECT_EQ(ram[0xFFF], 0x01);
+}
+
+TEST(ROMLoader, programLargerThanTheRamFails) {
+  std::stringstream input_stream(std::string(MAX_PROGRAM_SIZE + 1, '\x01'));
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromStream(ram, input_stream);
+
+  EXPECT_FALSE(result);
+  EXPECT_FALSE(result.error.empty());
+}
+
+TEST(ROMLoader, fileIsReadIntoTheRam) {
+  const std::string path =
+      writeTemporaryRom(std::string(LOGO_EXAMPLE.begin(), LOGO_EXAMPLE.end()));
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromFile(ram, path);
+  std::remove(path.c_str());
+
+  EXPECT_TRUE(result);
+  EXPECT_EQ(result.size, LOGO_EXAMPLE.size());
+  EXPECT_TRUE(std::equal(LOGO_EXAMPLE.begin(), LOGO_EXAMPLE.end(),
+                         ram.begin() + 0x200));
+}
+
+TEST(ROMLoader, fileLargerThanTheRamFails) {
+  const std::string path =
+      writeTemporaryRom(std::string(MAX_PROGRAM_SIZE + 1, '\x01'));
+  RAM ram;
+
+  const RomLoadResult result = loadProgramFromFile(ram, path);
+  std::remove(path.c_str());
+
+  EXPECT_FALSE(result);
+  EXPECT_EQ(ram[0x200], 0x00);
+}
+
+TEST(ROMLoader, pipeIsReadUntilItIsClosed) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const std::string program(LOGO_EXAMPLE.begin(), LOGO_EXAMPLE.end());
+  ASSERT_EQ(write(fds[1], program.data(), program.size()),
+            static_cast<ssize_t>(program.size()));
+  close(fds[1]);
+  RAM ram;
+
+  const RomLoadResult result =
+      loadProgramFromFile(ram, "/proc/self/fd/" + std::to_string(fds[0]));
+  close(fds[0]);
+
+  EXPECT_TRUE(result);
+  EXPECT_EQ(result.size, LOGO_EXAMPLE.size());
+  EXPECT_EQ(ram[0x201], 0xE0);
+}
+
+TEST(ROMLoader, missingFileFails) {
+  RAM ram;
+
+  const RomLoadResult result =
+      loadProgramFromFile(ram, ::testing::TempDir() + "missing.ch8");
+
+  EXPECT_FALSE(result);
+  EXPECT_NE(result.error.find("missing.ch8"), std::string::npos);
+}
+
+TEST(ROMLoader, emulatorThrowsWhenTheProgramCannotBeLoaded) {
+  std::stringstream rom(std::string(MAX_PROGRAM_SIZE + 1, '\x01'));
+  BitmaskUserInputController keypad;
+
+  EXPECT_THROW(Emulator(rom, &keypad), std::runtime_error);
+  EXPECT_THROW(Emulator(::testing::TempDir() + "missing.ch8", &keypad),
+               std::runtime_error);
+}
+
+TEST(ROMLoader, emulatorReloadsTheProgramIntoAResetMachine) {
+  const std::string path = writeTemporaryRom(std::string{
+      '\x60', '\x07',  // 0x200: V0 = 7
+      '\x12', '\x02'   // 0x202: jump to 0x202
+  });
+  BitmaskUserInputController keypad;
+  Emulator emulator(path, &keypad);
+  emulator.seed(42);
+  const RandomState random_state = emulator.getState().random_state;
+  emulator.runFrame();
+  EXPECT_EQ(emulator.getState().registers[0], 7);
+
+  writeTemporaryRom(std::string{'\x60', '\x09', '\x12', '\x02'});
+  emulator.reload(path);
+  EXPECT_EQ(emulator.getState().pc, 0x200);
+  EXPECT_EQ(emulator.getState().registers[0], 0);
+  EXPECT_EQ(emulator.getState().random_state.state, random_state.state);
+  EXPECT_TRUE(emulator.getRamWriteTracker().isDirty(0x201));
+  emulator.runFrame();
+  EXPECT_EQ(emulator.getState().registers[0], 9);
+
+  // A broken program leaves the machine as it is
+  writeTemporaryRom(std::string(MAX_PROGRAM_SIZE + 1, '\x01'));
+  EXPECT_THROW(emulator.reload(path), std::runtime_error);
+  std::remove(path.c_str());
+  EXPECT_EQ(emulator.getState().ram[0x201], 0x09);
+}
@@ -0,0 +1,96 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "library/rom_watcher.h"
+
+using namespace chip8;
+
+namespace fs = std::filesystem;
+
+class TestRomWatcher : public ::testing::Test {
+ protected:
+  TestRomWatcher()
+      : directory(fs::path(::testing::TempDir()) / "rom_watcher"),
+        path((directory / "game.ch8").string()) {
+    fs::remove_all(directory);
+    fs::create_directories(directory);
+    write(path, "\x12\x00");
+  }
+
+  ~TestRomWatcher() override { fs::remove_all(directory); }
+
+  static void write(const std::string& file_path, const std::string& content) {
+    std::ofstream file(file_path, std::ios_base::binary);
+    file << content;
+  }
+
+  fs::path directory;
+  std::string path;
+};
+
+TEST_F(TestRomWatcher, fileWrittenInPlaceIsDetected) {
+  RomWatcher watcher(path);
+  ASSERT_TRUE(watcher.isWatching());
+  EXPECT_FALSE(watcher.poll());
+
+  write(path, "\x12\x02");
+
+  EXPECT_TRUE(watcher.poll());
+  EXPECT_FALSE(watcher.poll());
+}
+
+TEST_F(TestRomWatcher, fileReplacedByARenameIsDetected) {
+  RomWatcher watcher(path);
+  const std::string temporary_path = path + ".tmp";
+
+  write(temporary_path, "\x12\x04");
+  EXPECT_FALSE(watcher.poll());
+  ASSERT_EQ(std::rename(temporary_path.c_str(), path.c_str()), 0);
+
+  EXPECT_TRUE(watcher.poll());
+}
+
+TEST_F(TestRomWatcher, otherFilesAreIgnored) {
+  RomWatcher watcher(path);
+
+  write((directory / "other.ch8").string(), "\x12\x00");
+
+  EXPECT_FALSE(watcher.poll());
+}
+
+TEST(RomWatcher, missingDirectoryCannotBeWatched) {
+  RomWatcher watcher(::testing::TempDir() + "missing/game.ch8");
+
+  EXPECT_FALSE(watcher.isWatching());
+  EXPECT_FALSE(watcher.poll());
+}
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/run_ahead.h"
+#include "emulator/snapshot_publisher.h"
+#include "emulator/state_hash.h"
+
+using namespace chip8;
+
+// Wait for a key, wait two frames on the delay timer then draw
+static const std::string LAGGY_PROGRAM{
+    '\xF0', '\x0A',  // 0x200: V0 = next key pressed
+    '\x61', '\x02',  // 0x202: V1 = 2
+    '\xF1', '\x15',  // 0x204: delay timer = V1
+    '\xF1', '\x07',  // 0x206: V1 = delay timer
+    '\x31', '\x00',  // 0x208: skip next if V1 == 0
+    '\x12', '\x06',  // 0x20A: jump to 0x206
+    '\xD0', '\x05',  // 0x20C: draw the sprite at I
+    '\x12', '\x0E'   // 0x20E: jump to 0x20E
+};
+
+static bool isBlank(const DisplayModel& display) {
+  for (std::size_t col = 0; col < display.getWidth(); ++col) {
+    for (std::size_t row = 0; row < display.getHeight(); ++row) {
+      if (display.getPixelValue(column_t(col), row_t(row)) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+class TestRunAhead : public ::testing::Test {
+ protected:
+  TestRunAhead() : rom(LAGGY_PROGRAM), emulator(rom, &keypad) {}
+
+  std::istringstream rom;
+  BitmaskUserInputController keypad;
+  Emulator emulator;
+};
+
+TEST_F(TestRunAhead, presentedFrameReactsToTheKeysImmediately) {
+  RunAhead run_ahead(emulator, keypad, 3);
+
+  run_ahead.runFrame(1 << 4);
+
+  EXPECT_FALSE(isBlank(run_ahead.getDisplayModel()));
+  EXPECT_TRUE(isBlank(emulator.getDisplayModel()));
+}
+
+TEST_F(TestRunAhead, emulatorIsNotAdvancedByTheFramesRunAhead) {
+  std::istringstream reference_rom(LAGGY_PROGRAM);
+  BitmaskUserInputController reference_keypad;
+  Emulator reference(reference_rom, &reference_keypad);
+  RunAhead run_ahead(emulator, keypad, 2);
+
+  for (int frame = 0; frame < 5; ++frame) {
+    run_ahead.runFrame(frame == 1 ? 1 << 2 : 0);
+    reference_keypad.setKeys(frame == 1 ? 1 << 2 : 0);
+    reference.runFrame();
+
+    ASSERT_EQ(emulator.stateHash(), reference.stateHash());
+    ASSERT_EQ(emulator.countFrames(), reference.countFrames());
+    ASSERT_EQ(emulator.countCycles(), reference.countCycles());
+  }
+  EXPECT_GT(run_ahead.getAverageCost().count(), 0);
+  EXPECT_GT(run_ahead.getFrameBudgetUsage(), 0.0);
+}
+
+TEST_F(TestRunAhead, framesRunAheadAreNotPublished) {
+  SnapshotPublisher publisher;
+  emulator.setSnapshotPublisher(&publisher);
+  RunAhead run_ahead(emulator, keypad, 3);
+
+  run_ahead.runFrame(1 << 4);
+  run_ahead.runFrame(1 << 4);
+
+  Snapshot snapshot;
+  ASSERT_TRUE(publisher.read(snapshot));
+  EXPECT_EQ(publisher.countPublications(), 2u);
+  EXPECT_EQ(snapshot.frame, 2u);
+}
+
+TEST_F(TestRunAhead, noFrameAheadPresentsTheCurrentFrame) {
+  RunAhead run_ahead(emulator, keypad, 0);
+
+  for (int frame = 0; frame < 3; ++frame) {
+    run_ahead.runFrame(1 << 4);
+    EXPECT_EQ(isBlank(run_ahead.getDisplayModel()),
+              isBlank(emulator.getDisplayModel()));
+  }
+  EXPECT_FALSE(isBlank(run_ahead.getDisplayModel()));
+  EXPECT_EQ(run_ahead.getAverageCost().count(), 0);
+
+  run_ahead.setFrames(100);
+  EXPECT_EQ(run_ahead.getFrames(), MAX_RUN_AHEAD_FRAMES);
+}
@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/save_state.h"
+#include "emulator/state_hash.h"
+
+using namespace chip8;
+
+static RAM makeReference() {
+  RAM reference;
+  storeSpriteInMemory(reference);
+  reference[0x200] = 0x12;
+  reference[0x201] = 0x00;
+  return reference;
+}
+
+static MachineState makeState(const RAM& reference) {
+  MachineState state;
+  state.pc = 0x234;
+  state.stack_ptr = 2;
+  state.index_reg = 0x345;
+  state.delay_timer_reg = 10;
+  state.sound_timer_reg = 20;
+  state.registers[0] = 1;
+  state.registers[0xF] = 0xFF;
+  state.stack[0] = 0x202;
+  state.stack[1] = 0x220;
+  state.ram = reference;
+  state.ram[0x300] = 0xAB;
+  state.ram[0x301] = 0xCD;
+  state.framebuffer[0] = 1;
+  state.framebuffer[DISPLAY_WIDTH + 3] = 1;
+  Pcg32::seed(state.random_state, 1234);
+  return state;
+}
+
+TEST(SaveState, encodeAndDecode) {
+  const RAM reference = makeReference();
+  const MachineState state = makeState(reference);
+
+  auto buffer = encodeSaveState(state, reference);
+  MachineState decoded;
+  bool success =
+      decodeSaveState(buffer.data(), buffer.size(), reference, decoded);
+
+  EXPECT_TRUE(success);
+  EXPECT_EQ(hashState(decoded), hashState(state));
+}
+
+TEST(SaveState, typicalStateIsCompact) {
+  const RAM reference = makeReference();
+
+  auto buffer = encodeSaveState(makeState(reference), reference);
+
+  EXPECT_LT(buffer.size(), 128);
+}
+
+TEST(SaveState, rejectCorruptedBuffer) {
+  const RAM reference = makeReference();
+  auto buffer = encodeSaveState(makeState(reference), reference);
+  MachineState decoded;
+
+  buffer[10] ^= 0x1;
+
+  EXPECT_FALSE(
+      decodeSaveState(buffer.data(), buffer.size(), reference, decoded));
+  EXPECT_FALSE(decodeSaveState(buffer.data(), 4, reference, decoded));
+}
+
+TEST(SaveState, rejectOtherVersion) {
+  const RAM reference = makeReference();
+  auto buffer = encodeSaveState(makeState(reference), reference);
+  MachineState decoded;
+
+  // Patch the version and the checksum so that only the version is wrong
+  buffer[4] = 0xFF;
+  buffer.resize(buffer.size() - sizeof(uint64_t));
+  uint64_t checksum = hashBytes(buffer.data(), buffer.size());
+  for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+    buffer.push_back(static_cast<uint8_t>(checksum >> 8 * i));
+  }
+
+  EXPECT_FALSE(
+      decodeSaveState(buffer.data(), buffer.size(), reference, decoded));
+}
+
+TEST(SaveState, rejectStackPointerOutOfTheStack) {
+  const RAM reference = makeReference();
+  auto buffer = encodeSaveState(makeState(reference), reference);
+  MachineState decoded;
+
+  // Stack pointer after the magic, version, PC and index register
+  buffer[10] = static_cast<uint8_t>(Stack::size());
+  buffer.resize(buffer.size() - sizeof(uint64_t));
+  uint64_t checksum = hashBytes(buffer.data(), buffer.size());
+  for (std::size_t i = 0; i < sizeof(uint64_t); ++i) {
+    buffer.push_back(static_cast<uint8_t>(checksum >> 8 * i));
+  }
+
+  EXPECT_FALSE(
+      decodeSaveState(buffer.data(), buffer.size(), reference, decoded));
+}
+
+TEST(SaveState, writeInBackground) {
+  const RAM reference = makeReference();
+  const MachineState state = makeState(reference);
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "chip8_test.state").string();
+
+  SaveStateWriter writer(reference);
+  writer.write(state, path);
+  writer.flush();
+
+  std::ifstream file(path, std::ios_base::binary);
+  MachineState loaded;
+  EXPECT_TRUE(loadSaveState(file, reference, loaded));
+  EXPECT_EQ(hashState(loaded), hashState(state));
+  EXPECT_EQ(writer.countFailures(), 0);
+  std::filesystem::remove(path);
+}
+
+TEST(SaveState, countWriteFailures) {
+  const RAM reference = makeReference();
+
+  SaveStateWriter writer(reference);
+  writer.write(makeState(reference), "/nonexistent_directory/chip8.state");
+  writer.flush();
+
+  EXPECT_EQ(writer.countFailures(), 1);
+}
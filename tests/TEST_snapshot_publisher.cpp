@@ -0,0 +1,122 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/snapshot_publisher.h"
+
+using namespace chip8;
+
+TEST(SnapshotPublisher, nothingToReadBeforeTheFirstPublication) {
+  SnapshotPublisher publisher;
+  auto snapshot = std::make_unique<Snapshot>();
+
+  EXPECT_EQ(publisher.countPublications(), 0u);
+  EXPECT_FALSE(publisher.read(*snapshot));
+}
+
+TEST(SnapshotPublisher, readersGetTheLastSnapshot) {
+  SnapshotPublisher publisher;
+  auto state = std::make_unique<MachineState>();
+  auto snapshot = std::make_unique<Snapshot>();
+
+  state->ram[0x300] = 1;
+  publisher.publish(1, *state);
+  state->ram[0x300] = 2;
+  state->framebuffer[42] = 1;
+  publisher.publish(2, *state);
+
+  ASSERT_TRUE(publisher.read(*snapshot));
+  EXPECT_EQ(publisher.countPublications(), 2u);
+  EXPECT_EQ(snapshot->frame, 2u);
+  EXPECT_EQ(snapshot->state.ram[0x300], 2);
+  EXPECT_EQ(snapshot->state.framebuffer[42], 1);
+}
+
+TEST(SnapshotPublisher, readersNeverSeeTornSnapshots) {
+  SnapshotPublisher publisher;
+  std::atomic<bool> stop(false);
+
+  // Every byte of a published state holds the number of the frame
+  std::thread writer([&publisher, &stop]() {
+    auto state = std::make_unique<MachineState>();
+    for (uint64_t frame = 1; !stop.load(); ++frame) {
+      std::fill(state->ram.begin(), state->ram.end(),
+                static_cast<uint8_t>(frame));
+      state->framebuffer.fill(static_cast<uint8_t>(frame));
+      publisher.publish(frame, *state);
+    }
+  });
+
+  auto snapshot = std::make_unique<Snapshot>();
+  for (int i = 0; i < 2000; ++i) {
+    if (!publisher.read(*snapshot)) {
+      continue;
+    }
+
+    const auto frame = static_cast<uint8_t>(snapshot->frame);
+    const bool consistent =
+        std::all_of(snapshot->state.ram.begin(), snapshot->state.ram.end(),
+                    [frame](uint8_t byte) { return byte == frame; }) &&
+        std::all_of(snapshot->state.framebuffer.begin(),
+                    snapshot->state.framebuffer.end(),
+                    [frame](uint8_t pixel) { return pixel == frame; });
+    ASSERT_TRUE(consistent);
+  }
+
+  stop.store(true);
+  writer.join();
+}
+
+TEST(SnapshotPublisher, emulatorPublishesEachFrame) {
+  // V0 = 7 then loop
+  std::istringstream rom(std::string{'\x60', '\x07', '\x12', '\x02'});
+  BitmaskUserInputController keypad;
+  Emulator emulator(rom, &keypad);
+  SnapshotPublisher publisher;
+  auto snapshot = std::make_unique<Snapshot>();
+
+  emulator.runFrame();
+  emulator.setSnapshotPublisher(&publisher);
+  emulator.runFrame();
+  emulator.runFrame();
+
+  ASSERT_TRUE(publisher.read(*snapshot));
+  EXPECT_EQ(publisher.countPublications(), 2u);
+  EXPECT_EQ(snapshot->frame, emulator.countFrames());
+  EXPECT_EQ(snapshot->frame, 3u);
+  EXPECT_EQ(snapshot->state.registers[0], 7);
+  EXPECT_EQ(snapshot->state.pc, emulator.getState().pc);
+}
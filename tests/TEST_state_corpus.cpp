@@ -0,0 +1,224 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+// linux
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/state_corpus.h"
+
+using namespace chip8;
+
+class TestStateCorpus : public ::testing::Test {
+ protected:
+  TestStateCorpus()
+      // Unique per process and test, as the tests may run in parallel
+      : path((std::filesystem::temp_directory_path() /
+              ("chip8_test_" + std::to_string(getpid()) + "_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+               ".corpus"))
+                 .string()),
+        // V0 = RND, store it at 0x300 then loop
+        rom(std::string{'\xC0', '\xFF', '\xA3', '\x00', '\xF0', '\x55',
+                        '\x12', '\x06'}),
+        emulator(rom, &keypad) {
+    removeFiles();
+  }
+
+  ~TestStateCorpus() override { removeFiles(); }
+
+  void removeFiles() {
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".idx");
+  }
+
+  // Distinct states are obtained from distinct seeds
+  std::size_t appendSeeded(StateCorpus& corpus, uint64_t seed) {
+    emulator.seed(seed);
+    emulator.getState().pc = 0x200;
+    emulator.runFrame();
+    return *corpus.append(emulator.getState(), emulator.getMemoryHash());
+  }
+
+  const std::string path;
+  std::istringstream rom;
+  BitmaskUserInputController keypad;
+  Emulator emulator;
+};
+
+TEST_F(TestStateCorpus, statesAreRestoredFromAnotherInstance) {
+  StateCorpus writer;
+  ASSERT_TRUE(writer.open(path, true));
+  const std::size_t index = appendSeeded(writer, 1);
+  const uint64_t expected_hash = emulator.stateHash();
+
+  StateCorpus reader;
+  ASSERT_TRUE(reader.open(path, false));
+  ASSERT_EQ(reader.find(expected_hash), index);
+
+  std::istringstream other_rom;
+  Emulator other(other_rom, &keypad);
+  reader.restore(index, other);
+
+  EXPECT_EQ(other.stateHash(), expected_hash);
+  EXPECT_EQ(other.getState().ram[0x300], emulator.getState().ram[0x300]);
+}
+
+TEST_F(TestStateCorpus, statesAreStoredOnce) {
+  StateCorpus corpus;
+  ASSERT_TRUE(corpus.open(path, true));
+
+  const std::size_t first = appendSeeded(corpus, 1);
+  const std::size_t second = appendSeeded(corpus, 2);
+  const std::size_t again = appendSeeded(corpus, 1);
+
+  EXPECT_NE(first, second);
+  EXPECT_EQ(again, first);
+  EXPECT_EQ(corpus.size(), 2u);
+}
+
+TEST_F(TestStateCorpus, corpusIsPersistent) {
+  {
+    StateCorpus corpus;
+    ASSERT_TRUE(corpus.open(path, true));
+    for (uint64_t seed = 0; seed < 10; ++seed) {
+      appendSeeded(corpus, seed);
+    }
+  }
+
+  StateCorpus corpus;
+  ASSERT_TRUE(corpus.open(path, true));
+  EXPECT_EQ(corpus.size(), 10u);
+  EXPECT_EQ(appendSeeded(corpus, 3), 3u);
+  EXPECT_EQ(appendSeeded(corpus, 10), 10u);
+}
+
+TEST_F(TestStateCorpus, readersSeeTheAppendedStates) {
+  StateCorpus writer;
+  ASSERT_TRUE(writer.open(path, true));
+  StateCorpus reader;
+  ASSERT_TRUE(reader.open(path, false));
+
+  appendSeeded(writer, 5);
+  const uint64_t hash = emulator.stateHash();
+
+  EXPECT_EQ(reader.size(), 1u);
+  EXPECT_FALSE(reader.find(hash));
+  reader.refresh();
+  EXPECT_EQ(reader.find(hash), 0u);
+  EXPECT_EQ(reader.getRecord(0).state_hash, hash);
+}
+
+TEST_F(TestStateCorpus, readersOnlySeeTheRecordsTheyMapped) {
+  StateCorpus writer;
+  ASSERT_TRUE(writer.open(path, true));
+  StateCorpus reader;
+  ASSERT_TRUE(reader.open(path, false, 2));
+
+  for (uint64_t seed = 0; seed < 4; ++seed) {
+    appendSeeded(writer, seed);
+  }
+  reader.refresh();
+
+  EXPECT_EQ(reader.size(), 2u);
+  EXPECT_FALSE(reader.find(emulator.stateHash()));
+  EXPECT_THROW(reader.getRecord(2), std::out_of_range);
+  EXPECT_THROW(reader.restore(3, emulator), std::out_of_range);
+}
+
+TEST_F(TestStateCorpus, singleWriter) {
+  StateCorpus writer;
+  ASSERT_TRUE(writer.open(path, true));
+
+  StateCorpus other_writer;
+  EXPECT_FALSE(other_writer.open(path, true));
+
+  StateCorpus reader;
+  EXPECT_TRUE(reader.open(path, false));
+  EXPECT_FALSE(reader.append(emulator.getState(), emulator.getMemoryHash()));
+}
+
+TEST_F(TestStateCorpus, fullCorpusRejectsNewStates) {
+  StateCorpus corpus;
+  ASSERT_TRUE(corpus.open(path, true, 1));
+  appendSeeded(corpus, 1);
+
+  emulator.seed(2);
+  emulator.runFrame();
+  EXPECT_FALSE(corpus.append(emulator.getState(), emulator.getMemoryHash()));
+}
+
+TEST_F(TestStateCorpus, otherFilesAreRejected) {
+  std::ofstream(path) << std::string(256, 'x');
+
+  StateCorpus corpus;
+  EXPECT_FALSE(corpus.open(path, false));
+  EXPECT_FALSE(corpus.open(path, true));
+  EXPECT_FALSE(corpus.isOpen());
+}
+
+TEST_F(TestStateCorpus, compactionKeepsTheSelectedStates) {
+  uint64_t kept_hash = 0;
+  {
+    StateCorpus corpus;
+    ASSERT_TRUE(corpus.open(path, true));
+    for (uint64_t seed = 0; seed < 8; ++seed) {
+      appendSeeded(corpus, seed);
+      if (seed == 6) {
+        kept_hash = emulator.stateHash();
+      }
+    }
+  }
+
+  StateCorpus previous_reader;
+  ASSERT_TRUE(previous_reader.open(path, false));
+
+  ASSERT_TRUE(compactStateCorpus(path, [](const StateRecord& record) {
+    return record.state.ram[0x300] % 2 == 0;
+  }));
+
+  StateCorpus corpus;
+  ASSERT_TRUE(corpus.open(path, false));
+  EXPECT_LT(corpus.size(), 8u);
+  for (std::size_t index = 0; index < corpus.size(); ++index) {
+    EXPECT_EQ(corpus.getRecord(index).state.ram[0x300] % 2, 0);
+    EXPECT_EQ(corpus.find(corpus.getRecord(index).state_hash), index);
+  }
+  EXPECT_EQ(corpus.find(kept_hash).has_value(),
+            previous_reader.getRecord(6).state.ram[0x300] % 2 == 0);
+
+  // Readers opened before the compaction keep the previous records
+  EXPECT_EQ(previous_reader.size(), 8u);
+}
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "emulator/bitmask_user_input.h"
+#include "emulator/emulator.h"
+#include "emulator/frame_buffer_model.h"
+#include "emulator/state_hash.h"
+
+using namespace chip8;
+
+// LD V0, 123 then LD I, 0x300 then LD B, V0 then LD [I], V0 then LD F, V0
+// then DRW V0, V0, 5 then CLS then DRW V0, V0, 5 then ADD V0, 1 then JP 0x202
+static const std::string HASH_ROM = {
+    '\x60', '\x7B', '\xA3', '\x00', '\xF0', '\x33', '\xF0', '\x55', '\xF0',
+    '\x29', '\xD0', '\x05', '\x00', '\xE0', '\xD0', '\x05', '\x70', '\x01',
+    '\x12', '\x02'};
+
+TEST(IncrementalStateHash, updateMatchesFullHash) {
+  MachineState state;
+  IncrementalStateHash state_hash;
+  state_hash.reset(state);
+
+  state_hash.updateRam(0x300, state.ram[0x300], 0x42);
+  state.ram[0x300] = 0x42;
+  state_hash.updatePixel(10, state.framebuffer[10], 1);
+  state.framebuffer[10] = 1;
+
+  EXPECT_EQ(state_hash.getValue(), IncrementalStateHash::hashMemory(state));
+}
+
+TEST(IncrementalStateHash, frameBufferModelUpdatesHash) {
+  MachineState state;
+  IncrementalStateHash state_hash;
+  state_hash.reset(state);
+  FrameBufferModel model(state.framebuffer, &state_hash);
+
+  model.setPixelValue(column_t(3), row_t(2), 1);
+  EXPECT_EQ(state_hash.getValue(), IncrementalStateHash::hashMemory(state));
+
+  model.clear();
+  EXPECT_EQ(state_hash.getValue(), IncrementalStateHash::hashMemory(state));
+}
+
+TEST(EmulatorStateHash, matchFullRehash) {
+  std::istringstream rom(HASH_ROM);
+  BitmaskUserInputController keypad;
+  Emulator emulator(rom, &keypad);
+
+  for (int frame = 0; frame < 20; ++frame) {
+    emulator.runFrame();
+    const MachineState& state = emulator.getState();
+    ASSERT_EQ(emulator.stateHash(),
+              combineStateHash(state, IncrementalStateHash::hashMemory(state)));
+  }
+}
+
+TEST(EmulatorStateHash, equalStatesHaveEqualHashes) {
+  std::istringstream first_rom(HASH_ROM);
+  std::istringstream second_rom(HASH_ROM);
+  BitmaskUserInputController keypad;
+  Emulator first_emulator(first_rom, &keypad);
+  Emulator second_emulator(second_rom, &keypad);
+
+  first_emulator.runFrame();
+  EXPECT_NE(first_emulator.stateHash(), second_emulator.stateHash());
+
+  second_emulator.runFrame();
+  EXPECT_EQ(first_emulator.stateHash(), second_emulator.stateHash());
+
+  first_emulator.runFrame();
+  second_emulator.restoreState(first_emulator.getState());
+  EXPECT_EQ(first_emulator.stateHash(), second_emulator.stateHash());
+}
@@ -0,0 +1,213 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "emulator/state_hash.h"
+
+#include "debugger/time_travel_debugger.h"
+
+using namespace chip8;
+
+// Count in V0 and store the count at 0x300 when it reaches 5
+static const std::string COUNTER_PROGRAM{
+    '\x70', '\x01',  // 0x200: V0 += 1
+    '\xA3', '\x00',  // 0x202: I = 0x300
+    '\x30', '\x05',  // 0x204: skip next if V0 == 5
+    '\x12', '\x0A',  // 0x206: jump to 0x20A
+    '\xF0', '\x55',  // 0x208: store V0 at I
+    '\x12', '\x00'   // 0x20A: jump to 0x200
+};
+
+// Wait for a key, store it at 0x300 then wait again
+static const std::string KEYS_PROGRAM{
+    '\xF0', '\x0A',  // 0x200: V0 = next key pressed
+    '\xA3', '\x00',  // 0x202: I = 0x300
+    '\xF0', '\x55',  // 0x204: store V0 at I
+    '\x12', '\x00'   // 0x206: jump to 0x200
+};
+
+class TestTimeTravelDebugger : public ::testing::Test {
+ protected:
+  explicit TestTimeTravelDebugger(const std::string& program = COUNTER_PROGRAM)
+      : rom(program), debugger(rom, 7) {}
+
+  uint64_t hash() const { return hashState(debugger.getState()); }
+
+  std::istringstream rom;
+  TimeTravelDebugger debugger;
+};
+
+TEST_F(TestTimeTravelDebugger, stepBackwardRestoresEveryPreviousState) {
+  std::vector<uint64_t> hashes{hash()};
+  for (int i = 0; i < 100; ++i) {
+    debugger.stepForward();
+    hashes.push_back(hash());
+  }
+
+  for (int i = 100; i > 0; --i) {
+    ASSERT_EQ(hash(), hashes[i]);
+    ASSERT_TRUE(debugger.stepBackward());
+  }
+
+  EXPECT_EQ(hash(), hashes[0]);
+  EXPECT_EQ(debugger.getPosition(), 0u);
+  EXPECT_FALSE(debugger.stepBackward());
+}
+
+TEST_F(TestTimeTravelDebugger, snapshotsAreTakenPeriodically) {
+  debugger.continueForward(70);
+
+  EXPECT_EQ(debugger.countSnapshots(), 11u);
+
+  // Going back and forth does not take the same snapshots again
+  debugger.continueBackward();
+  debugger.continueForward(70);
+  EXPECT_EQ(debugger.countSnapshots(), 11u);
+}
+
+TEST(TimeTravelDebugger, snapshotsAreThinnedPastTheMaximum) {
+  std::istringstream rom(COUNTER_PROGRAM);
+  TimeTravelDebugger debugger(rom, 7, 8);
+  std::vector<uint64_t> hashes{hashState(debugger.getState())};
+  for (int i = 0; i < 500; ++i) {
+    debugger.stepForward();
+    hashes.push_back(hashState(debugger.getState()));
+    ASSERT_LE(debugger.countSnapshots(), 8u);
+  }
+
+  // 500 instructions need 4 doublings of the interval to fit in 8 snapshots
+  EXPECT_EQ(debugger.getSnapshotInterval(), 7u * 16);
+
+  for (int i = 500; i > 0; --i) {
+    ASSERT_EQ(hashState(debugger.getState()), hashes[i]);
+    ASSERT_TRUE(debugger.stepBackward());
+  }
+  EXPECT_EQ(hashState(debugger.getState()), hashes[0]);
+}
+
+TEST_F(TestTimeTravelDebugger, continueStopsOnBreakpoints) {
+  debugger.addBreakpoint(0x208);
+
+  ASSERT_TRUE(debugger.continueForward(1000));
+  EXPECT_EQ(debugger.getState().pc, 0x208);
+  EXPECT_EQ(debugger.getState().registers[0], 5);
+  const uint64_t breakpoint_position = debugger.getPosition();
+
+  debugger.continueForward(200);
+  ASSERT_TRUE(debugger.continueBackward());
+  EXPECT_EQ(debugger.getPosition(), breakpoint_position);
+  EXPECT_EQ(debugger.getState().pc, 0x208);
+
+  // No earlier hit, the debugger goes back to the start
+  EXPECT_FALSE(debugger.continueBackward());
+  EXPECT_EQ(debugger.getPosition(), 0u);
+}
+
+TEST_F(TestTimeTravelDebugger, continueStopsOnWatchpoints) {
+  debugger.addWatchpoint(0x300);
+
+  ASSERT_TRUE(debugger.continueForward(200));
+  const uint64_t watchpoint_position = debugger.getPosition();
+  debugger.removeWatchpoint(0x300);
+  debugger.continueForward(200);
+  debugger.addWatchpoint(0x300);
+  ASSERT_TRUE(debugger.continueBackward());
+
+  // Stopped right after the store
+  EXPECT_EQ(debugger.getPosition(), watchpoint_position);
+  EXPECT_EQ(debugger.getState().ram[0x300], 5);
+  EXPECT_EQ(debugger.getState().pc, 0x20A);
+  ASSERT_TRUE(debugger.stepBackward());
+  EXPECT_EQ(debugger.getState().ram[0x300], 0);
+
+  debugger.removeWatchpoint(0x300);
+  EXPECT_FALSE(debugger.continueForward(200));
+}
+
+TEST_F(TestTimeTravelDebugger, storeOnBreakpointHitsWatchpoints) {
+  debugger.addBreakpoint(0x208);
+  debugger.addWatchpoint(0x300);
+
+  ASSERT_TRUE(debugger.continueForward(200));
+  EXPECT_EQ(debugger.getState().pc, 0x208);
+  EXPECT_EQ(debugger.getState().ram[0x300], 0);
+
+  ASSERT_TRUE(debugger.continueForward(200));
+  EXPECT_EQ(debugger.getState().pc, 0x20A);
+  EXPECT_EQ(debugger.getState().ram[0x300], 5);
+}
+
+TEST_F(TestTimeTravelDebugger, watchpointsIgnoreEarlierWrites) {
+  // The store happens before the watchpoint is added
+  debugger.continueForward(40);
+  ASSERT_EQ(debugger.getState().ram[0x300], 5);
+
+  debugger.addWatchpoint(0x300);
+  EXPECT_FALSE(debugger.continueForward(200));
+  EXPECT_EQ(debugger.getPosition(), 240u);
+}
+
+class TestTimeTravelDebuggerKeys : public TestTimeTravelDebugger {
+ protected:
+  TestTimeTravelDebuggerKeys() : TestTimeTravelDebugger(KEYS_PROGRAM) {}
+};
+
+TEST_F(TestTimeTravelDebuggerKeys, keysAreReplayed) {
+  debugger.continueForward(20);
+  debugger.setKeys(1 << 3);
+  debugger.continueForward(20);
+  debugger.setKeys(0);
+  debugger.continueForward(20);
+  const uint64_t expected_hash = hash();
+  EXPECT_EQ(debugger.getState().ram[0x300], 3);
+
+  debugger.addWatchpoint(0x300);
+  ASSERT_TRUE(debugger.continueBackward());
+  debugger.removeWatchpoint(0x300);
+  debugger.continueForward(60 - debugger.getPosition());
+
+  EXPECT_EQ(hash(), expected_hash);
+}
+
+TEST_F(TestTimeTravelDebuggerKeys, changingKeysInThePastDiscardsTheFuture) {
+  debugger.continueForward(20);
+  debugger.setKeys(1 << 3);
+  debugger.continueForward(40);
+
+  for (int i = 0; i < 30; ++i) {
+    debugger.stepBackward();
+  }
+  debugger.setKeys(1 << 9);
+  debugger.continueForward(30);
+
+  EXPECT_EQ(debugger.getState().ram[0x300], 9);
+  EXPECT_EQ(debugger.getPosition(), 60u);
+}
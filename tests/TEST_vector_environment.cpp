@@ -0,0 +1,200 @@
+/**
+ * Copyright (c) Romain Desarzens
+ * All rights reserved.
+ *
+ * MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+// std
+#include <stdexcept>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "rl/vector_environment.h"
+
+using namespace chip8;
+
+// LD I, 0x300 then ADD V0, 1 then LD [I], V0 then JP 0x202
+static const std::vector<uint8_t> COUNTER_ROM = {0xA3, 0x00, 0x70, 0x01,
+                                                 0xF0, 0x55, 0x12, 0x02};
+
+// LD V1, K then LD F, V1 then DRW V0, V0, 5 then JP 0x206
+static const std::vector<uint8_t> KEY_DRAW_ROM = {0xF1, 0x0A, 0xF1, 0x29,
+                                                  0xD0, 0x05, 0x12, 0x06};
+
+// LD F, V0 then DRW V0, V0, 5 then JP 0x202: the sprite is toggled an odd
+// number of times per frame
+static const std::vector<uint8_t> BLINK_ROM = {0xF0, 0x29, 0xD0, 0x05,
+                                               0x12, 0x02};
+
+// RND V0, 0xFF then LD I, 0x300 then LD [I], V0 then JP 0x200
+static const std::vector<uint8_t> RANDOM_ROM = {0xC0, 0xFF, 0xA3, 0x00,
+                                                0xF0, 0x55, 0x12, 0x00};
+
+static EnvironmentConfig makeConfig() {
+  return EnvironmentConfig{1, false, false, 0, {}, {}};
+}
+
+struct StepBuffers {
+  StepBuffers(const VectorEnvironment& environment)
+      : observations(environment.size() * environment.observationSize()),
+        actions(environment.size(), 0),
+        rewards(environment.size()),
+        dones(environment.size()) {}
+
+  std::vector<uint8_t> observations;
+  std::vector<uint16_t> actions;
+  std::vector<float> rewards;
+  std::vector<uint8_t> dones;
+};
+
+static void step(VectorEnvironment& environment, StepBuffers& buffers) {
+  environment.step(buffers.actions.data(), buffers.observations.data(),
+                   buffers.rewards.data(), buffers.dones.data());
+}
+
+TEST(TestVectorEnvironment, rewardIsDeltaOfRamValue) {
+  auto config = makeConfig();
+  config.rewards.push_back(RewardExtractor{0x300, 1.0f});
+  VectorEnvironment environment(COUNTER_ROM, 3, config);
+  StepBuffers buffers(environment);
+  environment.reset(nullptr, buffers.observations.data());
+
+  step(environment, buffers);
+
+  // One frame is one LD I then three iterations of the loop
+  EXPECT_FLOAT_EQ(buffers.rewards[0], 3.0f);
+  EXPECT_FLOAT_EQ(buffers.rewards[1], 3.0f);
+  EXPECT_FLOAT_EQ(buffers.rewards[2], 3.0f);
+  EXPECT_EQ(buffers.dones[0], 0);
+}
+
+TEST(TestVectorEnvironment, actionsArePerEnvironment) {
+  VectorEnvironment environment(KEY_DRAW_ROM, 2, makeConfig());
+  StepBuffers buffers(environment);
+  environment.reset(nullptr, buffers.observations.data());
+
+  buffers.actions = {0x0008, 0x0000};
+  step(environment, buffers);
+
+  // First line of the "3" sprite is 0xF0
+  const uint8_t* first = buffers.observations.data();
+  EXPECT_EQ(first[0], 1);
+  EXPECT_EQ(first[3], 1);
+  EXPECT_EQ(first[4], 0);
+  // The second environment is still waiting for a key
+  const uint8_t* second = first + environment.observationSize();
+  EXPECT_EQ(second[0], 0);
+}
+
+TEST(TestVectorEnvironment, bitPackedObservation) {
+  auto config = makeConfig();
+  config.bit_packed = true;
+  VectorEnvironment environment(KEY_DRAW_ROM, 1, config);
+  StepBuffers buffers(environment);
+  ASSERT_EQ(environment.observationSize(),
+            DISPLAY_WIDTH * DISPLAY_HEIGHT / 8);
+  environment.reset(nullptr, buffers.observations.data());
+
+  buffers.actions = {0x0008};
+  step(environment, buffers);
+
+  EXPECT_EQ(buffers.observations[0], 0xF0);
+  EXPECT_EQ(buffers.observations[1], 0x00);
+  // Second line of the "3" sprite is 0x10
+  EXPECT_EQ(buffers.observations[DISPLAY_WIDTH / 8], 0x10);
+}
+
+TEST(TestVectorEnvironment, maxPoolSkippedFrames) {
+  auto config = makeConfig();
+  config.frame_skip = 2;
+  VectorEnvironment last_frame(BLINK_ROM, 1, config);
+  config.max_pool = true;
+  VectorEnvironment max_pooled(BLINK_ROM, 1, config);
+  StepBuffers last_frame_buffers(last_frame);
+  StepBuffers max_pooled_buffers(max_pooled);
+  last_frame.reset(nullptr, last_frame_buffers.observations.data());
+  max_pooled.reset(nullptr, max_pooled_buffers.observations.data());
+
+  step(last_frame, last_frame_buffers);
+  step(max_pooled, max_pooled_buffers);
+
+  // The sprite is drawn by the first frame and erased by the second one
+  EXPECT_EQ(last_frame_buffers.observations[0], 0);
+  EXPECT_EQ(max_pooled_buffers.observations[0], 1);
+}
+
+TEST(TestVectorEnvironment, terminalConditionThenAutoreset) {
+  auto config = makeConfig();
+  config.rewards.push_back(RewardExtractor{0x300, 1.0f});
+  config.terminal_conditions.push_back(TerminalCondition{0x300, 3});
+  VectorEnvironment environment(COUNTER_ROM, 1, config);
+  StepBuffers buffers(environment);
+  environment.reset(nullptr, buffers.observations.data());
+
+  step(environment, buffers);
+  EXPECT_EQ(buffers.dones[0], 1);
+
+  // The step following the end of the episode only resets the environment
+  step(environment, buffers);
+  EXPECT_EQ(buffers.dones[0], 0);
+  EXPECT_FLOAT_EQ(buffers.rewards[0], 0.0f);
+
+  step(environment, buffers);
+  EXPECT_EQ(buffers.dones[0], 1);
+  EXPECT_FLOAT_EQ(buffers.rewards[0], 3.0f);
+}
+
+TEST(TestVectorEnvironment, truncateLongEpisodes) {
+  auto config = makeConfig();
+  config.max_episode_frames = 2;
+  VectorEnvironment environment(COUNTER_ROM, 1, config);
+  StepBuffers buffers(environment);
+  environment.reset(nullptr, buffers.observations.data());
+
+  step(environment, buffers);
+  EXPECT_EQ(buffers.dones[0], 0);
+  step(environment, buffers);
+  EXPECT_EQ(buffers.dones[0], 1);
+}
+
+TEST(TestVectorEnvironment, sameSeedSameEpisode) {
+  auto config = makeConfig();
+  config.rewards.push_back(RewardExtractor{0x300, 1.0f});
+  VectorEnvironment environment(RANDOM_ROM, 2, config);
+  StepBuffers buffers(environment);
+  std::vector<uint64_t> seeds = {42, 42};
+  environment.reset(seeds.data(), buffers.observations.data());
+
+  for (int i = 0; i < 10; ++i) {
+    step(environment, buffers);
+    EXPECT_FLOAT_EQ(buffers.rewards[0], buffers.rewards[1]);
+  }
+}
+
+TEST(TestVectorEnvironment, rejectAddressOutsideOfRam) {
+  auto config = makeConfig();
+  config.rewards.push_back(RewardExtractor{0x1000, 1.0f});
+
+  EXPECT_THROW(VectorEnvironment(COUNTER_ROM, 1, config),
+               std::invalid_argument);
+}
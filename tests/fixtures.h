@@ -133,8 +133,8 @@ class TestControlUnitFixture : public ::testing::Test {
   TestControlUnitFixture()
       : display_ctrler(&model, &view),
         ctrl_unit(pc, stack_ptr, index_reg, delay_timer_reg, sound_timer_reg,
-                  stack, registers, ram, display_ctrler, ui_ctrler),
-        registers(16) {}
+                  stack, registers, ram, display_ctrler, ui_ctrler,
+                  random_state) {}
 
   ProgramCounter pc;
   StackPointer stack_ptr;
@@ -142,8 +142,9 @@ class TestControlUnitFixture : public ::testing::Test {
   Stack stack;
   DelayTimerRegister delay_timer_reg;
   SoundTimerRegister sound_timer_reg;
-  std::vector<GeneralRegister> registers;
+  GeneralRegisters registers;
   RAM ram;
+  RandomState random_state{};
   TestDisplayModel model;
   TestDisplayView view;
   DisplayController display_ctrler;